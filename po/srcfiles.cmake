@@ -34,6 +34,8 @@ SET(WEECHAT_SOURCES
 ./src/core/wee-proxy.h
 ./src/core/wee-secure.c
 ./src/core/wee-secure.h
+./src/core/wee-slab.c
+./src/core/wee-slab.h
 ./src/core/wee-string.c
 ./src/core/wee-string.h
 ./src/core/wee-upgrade.c
@@ -201,6 +203,8 @@ SET(WEECHAT_SOURCES
 ./src/plugins/logger/logger-config.c
 ./src/plugins/logger/logger-config.h
 ./src/plugins/logger/logger.h
+./src/plugins/logger/logger-index.c
+./src/plugins/logger/logger-index.h
 ./src/plugins/logger/logger-info.c
 ./src/plugins/logger/logger-info.h
 ./src/plugins/logger/logger-tail.c
@@ -303,6 +303,7 @@ int config_day_change_old_day = -1;
 int config_emphasized_attributes = 0;
 regex_t *config_highlight_regex = NULL;
 char ***config_highlight_tags = NULL;
+const char ***config_highlight_tags_compiled = NULL;
 int config_num_highlight_tags = 0;
 char **config_plugin_extensions = NULL;
 int config_num_plugin_extensions = 0;
@@ -887,6 +888,13 @@ config_change_highlight_tags (const void *pointer, void *data,
     (void) data;
     (void) option;
 
+    if (config_highlight_tags_compiled)
+    {
+        gui_line_tags_compiled_free (config_num_highlight_tags,
+                                     config_highlight_tags,
+                                     config_highlight_tags_compiled);
+        config_highlight_tags_compiled = NULL;
+    }
     if (config_highlight_tags)
     {
         for (i = 0; i < config_num_highlight_tags; i++)
@@ -914,6 +922,9 @@ config_change_highlight_tags (const void *pointer, void *data,
                     config_highlight_tags[i] = string_split (tags_array[i],
                                                              "+", 0, 0, NULL);
                 }
+                config_highlight_tags_compiled =
+                    gui_line_tags_compile (config_num_highlight_tags,
+                                           config_highlight_tags);
             }
             string_free_split (tags_array);
         }
@@ -1283,7 +1294,7 @@ config_weechat_init_after_read ()
     }
 
     /* apply filters on all buffers */
-    gui_filter_all_buffers ();
+    gui_filter_all_buffers (NULL);
 
     config_change_look_nick_color_force (NULL, NULL, NULL);
 }
@@ -4465,6 +4476,13 @@ config_weechat_free ()
         config_highlight_regex = NULL;
     }
 
+    if (config_highlight_tags_compiled)
+    {
+        gui_line_tags_compiled_free (config_num_highlight_tags,
+                                     config_highlight_tags,
+                                     config_highlight_tags_compiled);
+        config_highlight_tags_compiled = NULL;
+    }
     if (config_highlight_tags)
     {
         for (i = 0; i < config_num_highlight_tags; i++)
@@ -39,8 +39,10 @@
 #endif
 
 #include "weechat.h"
+#include "wee-arraylist.h"
 #include "wee-backtrace.h"
 #include "wee-config-file.h"
+#include "wee-debug.h"
 #include "wee-hashtable.h"
 #include "wee-hdata.h"
 #include "wee-hook.h"
@@ -392,6 +394,89 @@ debug_hdata ()
         hashtable_map (weechat_hdata, &debug_hdata_map_cb, NULL);
 }
 
+/*
+ * Compares two signal names in dispatch index (for sort by time spent in
+ * dispatch, descending).
+ */
+
+int
+debug_hooks_dispatch_cmp_cb (void *data, struct t_arraylist *arraylist,
+                             void *pointer1, void *pointer2)
+{
+    struct t_hook_dispatch *ptr_dispatch1, *ptr_dispatch2;
+
+    /* make C compiler happy */
+    (void) arraylist;
+
+    ptr_dispatch1 = hashtable_get ((struct t_hashtable *)data, pointer1);
+    ptr_dispatch2 = hashtable_get ((struct t_hashtable *)data, pointer2);
+
+    if (ptr_dispatch1->time_usec > ptr_dispatch2->time_usec)
+        return -1;
+    if (ptr_dispatch1->time_usec < ptr_dispatch2->time_usec)
+        return 1;
+    return strcmp ((const char *)pointer1, (const char *)pointer2);
+}
+
+/*
+ * Adds a signal name of dispatch index in arraylist.
+ */
+
+void
+debug_hooks_dispatch_map_cb (void *data, struct t_hashtable *hashtable,
+                             const void *key, const void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    if (((struct t_hook_dispatch *)value)->sends > 0)
+        arraylist_add ((struct t_arraylist *)data, (void *)key);
+}
+
+/*
+ * Displays dispatch cost of signals/hsignals (most expensive first).
+ */
+
+void
+debug_hooks_dispatch (int type)
+{
+    struct t_arraylist *list;
+    struct t_hook_dispatch *ptr_dispatch;
+    const char *ptr_name;
+    int i;
+
+    if (!hook_dispatch[type])
+        return;
+
+    list = arraylist_new (hook_dispatch[type]->items_count, 1, 1,
+                          &debug_hooks_dispatch_cmp_cb, hook_dispatch[type],
+                          NULL, NULL);
+    if (!list)
+        return;
+
+    hashtable_map (hook_dispatch[type], &debug_hooks_dispatch_map_cb, list);
+
+    gui_chat_printf (NULL, "");
+    gui_chat_printf (NULL, "%s dispatched (top %d by time):",
+                     hook_type_string[type], DEBUG_HOOKS_DISPATCH_MAX);
+    gui_chat_printf (NULL, "%10s %10s %10s %6s  %s",
+                     "sends", "callbacks", "time (ms)", "hooks", "name");
+    for (i = 0; (i < arraylist_size (list)) && (i < DEBUG_HOOKS_DISPATCH_MAX);
+         i++)
+    {
+        ptr_name = (const char *)arraylist_get (list, i);
+        ptr_dispatch = hashtable_get (hook_dispatch[type], ptr_name);
+        gui_chat_printf (NULL, "%10lld %10lld %10.3f %6d  %s",
+                         ptr_dispatch->sends,
+                         ptr_dispatch->callbacks,
+                         ((double)ptr_dispatch->time_usec) / 1000,
+                         ptr_dispatch->hooks_count,
+                         ptr_name);
+    }
+
+    arraylist_free (list);
+}
+
 /*
  * Displays info about hooks.
  */
@@ -411,6 +496,10 @@ debug_hooks ()
     }
     gui_chat_printf (NULL, "%17s------", "---------");
     gui_chat_printf (NULL, "%17s:%5d", "total", hooks_count_total);
+
+    debug_hooks_dispatch (HOOK_TYPE_SIGNAL);
+    debug_hooks_dispatch (HOOK_TYPE_HSIGNAL);
+    debug_hooks_dispatch (HOOK_TYPE_MODIFIER);
 }
 
 /*
@@ -20,6 +20,9 @@
 #ifndef WEECHAT_DEBUG_H
 #define WEECHAT_DEBUG_H 1
 
+/* max number of signals displayed with dispatch cost in /debug hooks */
+#define DEBUG_HOOKS_DISPATCH_MAX 20
+
 struct t_gui_window_tree;
 
 extern void debug_sigsegv ();
@@ -178,10 +178,11 @@ hashtable_keycmp_default_cb (struct t_hashtable *hashtable,
 /*
  * Creates a new hashtable.
  *
- * The size is NOT a limit for number of items in hashtable. It is the size of
- * internal array to store hashed keys: a high value uses more memory, but has
- * better performance because this reduces the collisions of hashed keys and
- * then reduces length of linked lists.
+ * The size is NOT a limit for number of items in hashtable. It is the initial
+ * size of internal array to store hashed keys: a high value uses more memory,
+ * but has better performance because this reduces the collisions of hashed
+ * keys and then reduces length of linked lists. The array grows automatically
+ * when there are too many items (see HASHTABLE_LOAD_FACTOR_MAX).
  *
  * Returns pointer to new hashtable, NULL if error.
  */
@@ -227,6 +228,8 @@ hashtable_new (int size,
             new_hashtable->htable[i] = NULL;
         }
         new_hashtable->items_count = 0;
+        new_hashtable->oldest_item = NULL;
+        new_hashtable->newest_item = NULL;
 
         new_hashtable->callback_hash_key = (callback_hash_key) ?
             callback_hash_key : &hashtable_hash_key_default_cb;
@@ -361,6 +364,88 @@ hashtable_free_value (struct t_hashtable *hashtable,
     }
 }
 
+/*
+ * Adds an item in the linked list of hashed key (the list is sorted by key).
+ */
+
+void
+hashtable_add_item_to_htable (struct t_hashtable *hashtable,
+                              struct t_hashtable_item **htable,
+                              unsigned long long hash,
+                              struct t_hashtable_item *item)
+{
+    struct t_hashtable_item *ptr_item, *pos_item;
+
+    pos_item = NULL;
+    for (ptr_item = htable[hash];
+         ptr_item
+             && ((int)(hashtable->callback_keycmp) (hashtable, item->key, ptr_item->key) > 0);
+         ptr_item = ptr_item->next_item)
+    {
+        pos_item = ptr_item;
+    }
+
+    if (pos_item)
+    {
+        /* insert item after position found */
+        item->prev_item = pos_item;
+        item->next_item = pos_item->next_item;
+        if (pos_item->next_item)
+            (pos_item->next_item)->prev_item = item;
+        pos_item->next_item = item;
+    }
+    else
+    {
+        /* insert item at beginning of list */
+        item->prev_item = NULL;
+        item->next_item = htable[hash];
+        if (htable[hash])
+            (htable[hash])->prev_item = item;
+        htable[hash] = item;
+    }
+}
+
+/*
+ * Resizes the internal array of hashtable: all items are dispatched in the
+ * new array, according to their hashed key.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (hashtable is unchanged)
+ */
+
+int
+hashtable_resize (struct t_hashtable *hashtable, int new_size)
+{
+    struct t_hashtable_item **new_htable, *ptr_item;
+    unsigned long long hash;
+    int i;
+
+    if (new_size <= 0)
+        return 0;
+
+    new_htable = malloc (new_size * sizeof (*new_htable));
+    if (!new_htable)
+        return 0;
+    for (i = 0; i < new_size; i++)
+    {
+        new_htable[i] = NULL;
+    }
+
+    for (ptr_item = hashtable->oldest_item; ptr_item;
+         ptr_item = ptr_item->next_created_item)
+    {
+        hash = hashtable->callback_hash_key (hashtable, ptr_item->key) % new_size;
+        hashtable_add_item_to_htable (hashtable, new_htable, hash, ptr_item);
+    }
+
+    free (hashtable->htable);
+    hashtable->htable = new_htable;
+    hashtable->size = new_size;
+
+    return 1;
+}
+
 /*
  * Sets value for a key in hashtable.
  *
@@ -375,7 +460,7 @@ hashtable_set_with_size (struct t_hashtable *hashtable,
                          const void *value, int value_size)
 {
     unsigned long long hash;
-    struct t_hashtable_item *ptr_item, *pos_item, *new_item;
+    struct t_hashtable_item *ptr_item, *new_item;
 
     if (!hashtable || !key
         || ((hashtable->type_keys == HASHTABLE_BUFFER) && (key_size <= 0))
@@ -384,19 +469,9 @@ hashtable_set_with_size (struct t_hashtable *hashtable,
         return NULL;
     }
 
-    /* search position for item in hashtable */
-    hash = hashtable->callback_hash_key (hashtable, key) % hashtable->size;
-    pos_item = NULL;
-    for (ptr_item = hashtable->htable[hash];
-         ptr_item
-             && ((int)(hashtable->callback_keycmp) (hashtable, key, ptr_item->key) > 0);
-         ptr_item = ptr_item->next_item)
-    {
-        pos_item = ptr_item;
-    }
-
     /* replace value if item is already in hashtable */
-    if (ptr_item && (hashtable->callback_keycmp (hashtable, key, ptr_item->key) == 0))
+    ptr_item = hashtable_get_item (hashtable, key, &hash);
+    if (ptr_item)
     {
         hashtable_free_value (hashtable, ptr_item);
         hashtable_alloc_type (hashtable->type_values,
@@ -419,27 +494,24 @@ hashtable_set_with_size (struct t_hashtable *hashtable,
                           &new_item->value, &new_item->value_size);
 
     /* add item */
-    if (pos_item)
-    {
-        /* insert item after position found */
-        new_item->prev_item = pos_item;
-        new_item->next_item = pos_item->next_item;
-        if (pos_item->next_item)
-            (pos_item->next_item)->prev_item = new_item;
-        pos_item->next_item = new_item;
-    }
+    hashtable_add_item_to_htable (hashtable, hashtable->htable, hash,
+                                  new_item);
+
+    /* add item at the end of list sorted by creation date */
+    new_item->prev_created_item = hashtable->newest_item;
+    new_item->next_created_item = NULL;
+    if (hashtable->newest_item)
+        (hashtable->newest_item)->next_created_item = new_item;
     else
-    {
-        /* insert item at beginning of list */
-        new_item->prev_item = NULL;
-        new_item->next_item = hashtable->htable[hash];
-        if (hashtable->htable[hash])
-            (hashtable->htable[hash])->prev_item = new_item;
-        hashtable->htable[hash] = new_item;
-    }
+        hashtable->oldest_item = new_item;
+    hashtable->newest_item = new_item;
 
     hashtable->items_count++;
 
+    /* grow internal array if there are too many items */
+    if (hashtable->items_count > hashtable->size * HASHTABLE_LOAD_FACTOR_MAX)
+        hashtable_resize (hashtable, hashtable->size * 2);
+
     return new_item;
 }
 
@@ -573,26 +645,22 @@ hashtable_map (struct t_hashtable *hashtable,
                t_hashtable_map *callback_map,
                void *callback_map_data)
 {
-    int i;
     struct t_hashtable_item *ptr_item, *ptr_next_item;
 
     if (!hashtable)
         return;
 
-    for (i = 0; i < hashtable->size; i++)
+    ptr_item = hashtable->oldest_item;
+    while (ptr_item)
     {
-        ptr_item = hashtable->htable[i];
-        while (ptr_item)
-        {
-            ptr_next_item = ptr_item->next_item;
+        ptr_next_item = ptr_item->next_created_item;
 
-            (void) (callback_map) (callback_map_data,
-                                   hashtable,
-                                   ptr_item->key,
-                                   ptr_item->value);
+        (void) (callback_map) (callback_map_data,
+                               hashtable,
+                               ptr_item->key,
+                               ptr_item->value);
 
-            ptr_item = ptr_next_item;
-        }
+        ptr_item = ptr_next_item;
     }
 }
 
@@ -605,7 +673,6 @@ hashtable_map_string (struct t_hashtable *hashtable,
                       t_hashtable_map_string *callback_map,
                       void *callback_map_data)
 {
-    int i;
     struct t_hashtable_item *ptr_item, *ptr_next_item;
     const char *str_key, *str_value;
     char *key, *value;
@@ -613,33 +680,30 @@ hashtable_map_string (struct t_hashtable *hashtable,
     if (!hashtable)
         return;
 
-    for (i = 0; i < hashtable->size; i++)
+    ptr_item = hashtable->oldest_item;
+    while (ptr_item)
     {
-        ptr_item = hashtable->htable[i];
-        while (ptr_item)
-        {
-            ptr_next_item = ptr_item->next_item;
+        ptr_next_item = ptr_item->next_created_item;
 
-            str_key = hashtable_to_string (hashtable->type_keys,
-                                           ptr_item->key);
-            key = (str_key) ? strdup (str_key) : NULL;
+        str_key = hashtable_to_string (hashtable->type_keys,
+                                       ptr_item->key);
+        key = (str_key) ? strdup (str_key) : NULL;
 
-            str_value = hashtable_to_string (hashtable->type_values,
-                                             ptr_item->value);
-            value = (str_value) ? strdup (str_value) : NULL;
+        str_value = hashtable_to_string (hashtable->type_values,
+                                         ptr_item->value);
+        value = (str_value) ? strdup (str_value) : NULL;
 
-            (void) (callback_map) (callback_map_data,
-                                   hashtable,
-                                   key,
-                                   value);
+        (void) (callback_map) (callback_map_data,
+                               hashtable,
+                               key,
+                               value);
 
-            if (key)
-                free (key);
-            if (value)
-                free (value);
+        if (key)
+            free (key);
+        if (value)
+            free (value);
 
-            ptr_item = ptr_next_item;
-        }
+        ptr_item = ptr_next_item;
     }
 }
 
@@ -1043,7 +1107,7 @@ hashtable_add_to_infolist (struct t_hashtable *hashtable,
                            struct t_infolist_item *infolist_item,
                            const char *prefix)
 {
-    int i, item_number;
+    int item_number;
     struct t_hashtable_item *ptr_item;
     char option_name[128];
 
@@ -1051,53 +1115,51 @@ hashtable_add_to_infolist (struct t_hashtable *hashtable,
         return 0;
 
     item_number = 0;
-    for (i = 0; i < hashtable->size; i++)
+    for (ptr_item = hashtable->oldest_item; ptr_item;
+         ptr_item = ptr_item->next_created_item)
     {
-        for (ptr_item = hashtable->htable[i]; ptr_item;
-             ptr_item = ptr_item->next_item)
+        snprintf (option_name, sizeof (option_name),
+                  "%s_name_%05d", prefix, item_number);
+        if (!infolist_new_var_string (infolist_item, option_name,
+                                      hashtable_to_string (hashtable->type_keys,
+                                                           ptr_item->key)))
+            return 0;
+        snprintf (option_name, sizeof (option_name),
+                  "%s_value_%05d", prefix, item_number);
+        switch (hashtable->type_values)
         {
-            snprintf (option_name, sizeof (option_name),
-                      "%s_name_%05d", prefix, item_number);
-            if (!infolist_new_var_string (infolist_item, option_name,
-                                          hashtable_to_string (hashtable->type_keys,
-                                                               ptr_item->key)))
-                return 0;
-            snprintf (option_name, sizeof (option_name),
-                      "%s_value_%05d", prefix, item_number);
-            switch (hashtable->type_values)
-            {
-                case HASHTABLE_INTEGER:
-                    if (!infolist_new_var_integer (infolist_item, option_name,
-                                                   *((int *)ptr_item->value)))
-                        return 0;
-                    break;
-                case HASHTABLE_STRING:
-                    if (!infolist_new_var_string (infolist_item, option_name,
-                                                  (const char *)ptr_item->value))
-                        return 0;
-                    break;
-                case HASHTABLE_POINTER:
-                    if (!infolist_new_var_pointer (infolist_item, option_name,
-                                                   ptr_item->value))
-                        return 0;
-                    break;
-                case HASHTABLE_BUFFER:
-                    if (!infolist_new_var_buffer (infolist_item, option_name,
-                                                  ptr_item->value,
-                                                  ptr_item->value_size))
-                        return 0;
-                    break;
-                case HASHTABLE_TIME:
-                    if (!infolist_new_var_time (infolist_item, option_name,
-                                                *((time_t *)ptr_item->value)))
-                        return 0;
-                    break;
-                case HASHTABLE_NUM_TYPES:
-                    break;
-            }
-            item_number++;
+            case HASHTABLE_INTEGER:
+                if (!infolist_new_var_integer (infolist_item, option_name,
+                                               *((int *)ptr_item->value)))
+                    return 0;
+                break;
+            case HASHTABLE_STRING:
+                if (!infolist_new_var_string (infolist_item, option_name,
+                                              (const char *)ptr_item->value))
+                    return 0;
+                break;
+            case HASHTABLE_POINTER:
+                if (!infolist_new_var_pointer (infolist_item, option_name,
+                                               ptr_item->value))
+                    return 0;
+                break;
+            case HASHTABLE_BUFFER:
+                if (!infolist_new_var_buffer (infolist_item, option_name,
+                                              ptr_item->value,
+                                              ptr_item->value_size))
+                    return 0;
+                break;
+            case HASHTABLE_TIME:
+                if (!infolist_new_var_time (infolist_item, option_name,
+                                            *((time_t *)ptr_item->value)))
+                    return 0;
+                break;
+            case HASHTABLE_NUM_TYPES:
+                break;
         }
+        item_number++;
     }
+
     return 1;
 }
 
@@ -1125,6 +1187,16 @@ hashtable_remove_item (struct t_hashtable *hashtable,
     if (hashtable->htable[hash] == item)
         hashtable->htable[hash] = item->next_item;
 
+    /* remove item from list sorted by creation date */
+    if (item->prev_created_item)
+        (item->prev_created_item)->next_created_item = item->next_created_item;
+    if (item->next_created_item)
+        (item->next_created_item)->prev_created_item = item->prev_created_item;
+    if (hashtable->oldest_item == item)
+        hashtable->oldest_item = item->next_created_item;
+    if (hashtable->newest_item == item)
+        hashtable->newest_item = item->prev_created_item;
+
     free (item);
 
     hashtable->items_count--;
@@ -1201,6 +1273,8 @@ hashtable_print_log (struct t_hashtable *hashtable, const char *name)
     log_printf ("  size . . . . . . . . . : %d",    hashtable->size);
     log_printf ("  htable . . . . . . . . : 0x%lx", hashtable->htable);
     log_printf ("  items_count. . . . . . : %d",    hashtable->items_count);
+    log_printf ("  oldest_item. . . . . . : 0x%lx", hashtable->oldest_item);
+    log_printf ("  newest_item. . . . . . : 0x%lx", hashtable->newest_item);
     log_printf ("  type_keys. . . . . . . : %d (%s)",
                 hashtable->type_keys,
                 hashtable_type_string[hashtable->type_keys]);
@@ -1264,6 +1338,8 @@ hashtable_print_log (struct t_hashtable *hashtable, const char *name)
             log_printf ("      value_size . . . . : %d",    ptr_item->value_size);
             log_printf ("      prev_item. . . . . : 0x%lx", ptr_item->prev_item);
             log_printf ("      next_item. . . . . : 0x%lx", ptr_item->next_item);
+            log_printf ("      prev_created_item. : 0x%lx", ptr_item->prev_created_item);
+            log_printf ("      next_created_item. : 0x%lx", ptr_item->next_created_item);
         }
     }
 }
@@ -67,8 +67,17 @@ typedef void (t_hashtable_map_string)(void *data,
  * +-----+
  * |   7 | --> "weechat"
  * +-----+
+ *
+ * All items are also in a linked list sorted by creation date, which is used
+ * to iterate on hashtable (so items are always returned in insertion order).
+ *
+ * When the number of items exceeds HASHTABLE_LOAD_FACTOR_MAX * size, the
+ * htable is doubled and items are dispatched again in the linked lists
+ * (items are never moved in memory, so pointers to items remain valid).
  */
 
+#define HASHTABLE_LOAD_FACTOR_MAX 2
+
 enum t_hashtable_type
 {
     HASHTABLE_INTEGER = 0,
@@ -88,6 +97,10 @@ struct t_hashtable_item
     int value_size;                     /* size of value (in bytes)         */
     struct t_hashtable_item *prev_item; /* link to previous item            */
     struct t_hashtable_item *next_item; /* link to next item                */
+    struct t_hashtable_item *prev_created_item; /* link to previous created */
+                                                /* item                     */
+    struct t_hashtable_item *next_created_item; /* link to next created     */
+                                                /* item                     */
 };
 
 struct t_hashtable
@@ -96,6 +109,8 @@ struct t_hashtable
     struct t_hashtable_item **htable;  /* table to map hashes with linked   */
                                        /* lists                             */
     int items_count;                   /* number of items in hashtable      */
+    struct t_hashtable_item *oldest_item; /* first item created             */
+    struct t_hashtable_item *newest_item; /* last item created              */
 
     /* type for keys and values */
     enum t_hashtable_type type_keys;   /* type for keys: int/str/pointer    */
@@ -36,6 +36,9 @@
 #include <signal.h>
 #include <fcntl.h>
 #include <errno.h>
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif /* HAVE_SYS_EPOLL_H */
 
 #include "weechat.h"
 #include "wee-hook.h"
@@ -70,17 +73,35 @@ struct t_hook *weechat_hooks[HOOK_NUM_TYPES];     /* list of hooks          */
 struct t_hook *last_weechat_hook[HOOK_NUM_TYPES]; /* last hook              */
 int hooks_count[HOOK_NUM_TYPES];                  /* number of hooks        */
 int hooks_count_total = 0;                        /* total number of hooks  */
+struct t_hashtable *hook_dispatch[HOOK_NUM_TYPES]; /* signal name -> hooks  */
+int hook_dispatch_generation[HOOK_NUM_TYPES];     /* changed with hooks     */
 int hook_exec_recursion = 0;           /* 1 when a hook is executed         */
 time_t hook_last_system_time = 0;      /* used to detect system clock skew  */
 int real_delete_pending = 0;           /* 1 if some hooks must be deleted   */
 
+struct t_hook **hook_fd_index = NULL;  /* fd hooks, indexed by fd          */
+int hook_fd_index_size = 0;            /* size of fd index                  */
 struct pollfd *hook_fd_pollfd = NULL;  /* file descriptors for poll()       */
+int hook_fd_pollfd_size = 0;           /* allocated size of pollfd array    */
 int hook_fd_pollfd_count = 0;          /* number of file descriptors        */
+#ifdef HAVE_SYS_EPOLL_H
+int hook_fd_epoll = -1;                /* epoll instance for fd hooks       */
+struct epoll_event *hook_fd_epoll_events = NULL; /* events for epoll_wait() */
+int hook_fd_epoll_events_size = 0;     /* allocated size of events array    */
+int hook_fd_epoll_stale = 0;           /* 1 if epoll instance must be       */
+                                       /* rebuilt (fd not removed from it)  */
+#endif /* HAVE_SYS_EPOLL_H */
+struct t_hook **hook_timer_heap = NULL; /* timers sorted by next execution */
+int hook_timer_heap_size = 0;          /* allocated size of heap            */
+int hook_timer_heap_count = 0;         /* number of timers in heap          */
+struct t_hook **hook_timer_due = NULL; /* timers to execute in a loop       */
+int hook_timer_due_size = 0;           /* allocated size of due timers      */
 int hook_process_pending = 0;          /* 1 if there are some process to    */
                                        /* run (via fork)                    */
 
 
 void hook_process_run (struct t_hook *hook_process);
+void hook_dispatch_invalidate (int type);
 
 
 /*
@@ -97,6 +118,8 @@ hook_init ()
         weechat_hooks[type] = NULL;
         last_weechat_hook[type] = NULL;
         hooks_count[type] = 0;
+        hook_dispatch[type] = NULL;
+        hook_dispatch_generation[type] = 0;
     }
     hooks_count_total = 0;
     hook_last_system_time = time (NULL);
@@ -127,38 +150,498 @@ hook_search_type (const char *type)
 }
 
 /*
- * Reallocates the "struct pollfd" array for poll().
+ * Adds a file descriptor in the array of "struct pollfd" for poll().
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
  */
 
-void
-hook_fd_realloc_pollfd ()
+int
+hook_fd_pollfd_add (int fd, int flags)
 {
     struct pollfd *ptr_pollfd;
-    int count;
+    int new_size;
 
-    if (hooks_count[HOOK_TYPE_FD] == hook_fd_pollfd_count)
+    if (hook_fd_pollfd_count >= hook_fd_pollfd_size)
+    {
+        new_size = (hook_fd_pollfd_size == 0) ? 16 : hook_fd_pollfd_size * 2;
+        ptr_pollfd = realloc (hook_fd_pollfd,
+                              new_size * sizeof (struct pollfd));
+        if (!ptr_pollfd)
+            return 0;
+        hook_fd_pollfd = ptr_pollfd;
+        hook_fd_pollfd_size = new_size;
+    }
+
+    hook_fd_pollfd[hook_fd_pollfd_count].fd = fd;
+    hook_fd_pollfd[hook_fd_pollfd_count].events = 0;
+    hook_fd_pollfd[hook_fd_pollfd_count].revents = 0;
+    if (flags & HOOK_FD_FLAG_READ)
+        hook_fd_pollfd[hook_fd_pollfd_count].events |= POLLIN;
+    if (flags & HOOK_FD_FLAG_WRITE)
+        hook_fd_pollfd[hook_fd_pollfd_count].events |= POLLOUT;
+    hook_fd_pollfd_count++;
+
+    return 1;
+}
+
+/*
+ * Searches a file descriptor in the array of "struct pollfd" for poll()
+ * (an invalid file descriptor is stored with its bits inverted).
+ *
+ * Returns index of file descriptor in array, -1 if not found.
+ */
+
+int
+hook_fd_pollfd_search (int fd)
+{
+    int i;
+
+    for (i = 0; i < hook_fd_pollfd_count; i++)
+    {
+        if ((hook_fd_pollfd[i].fd == fd)
+            || ((hook_fd_pollfd[i].fd < 0) && (~hook_fd_pollfd[i].fd == fd)))
+        {
+            return i;
+        }
+    }
+
+    /* file descriptor not found */
+    return -1;
+}
+
+/*
+ * Removes a file descriptor from the array of "struct pollfd" for poll().
+ *
+ * Returns:
+ *   1: file descriptor removed
+ *   0: file descriptor not found
+ */
+
+int
+hook_fd_pollfd_remove (int fd)
+{
+    int i;
+
+    i = hook_fd_pollfd_search (fd);
+    if (i < 0)
+        return 0;
+
+    /* move last file descriptor to this slot */
+    hook_fd_pollfd_count--;
+    if (i < hook_fd_pollfd_count)
+        hook_fd_pollfd[i] = hook_fd_pollfd[hook_fd_pollfd_count];
+
+    return 1;
+}
+
+/*
+ * Displays an error on a fd hook (only the first time an error occurs).
+ */
+
+void
+hook_fd_set_error (struct t_hook *hook, int error)
+{
+    if (HOOK_FD(hook, error) != 0)
         return;
 
-    count = hooks_count[HOOK_TYPE_FD];
+    HOOK_FD(hook, error) = error;
+    gui_chat_printf (NULL,
+                     _("%sError: bad file descriptor (%d) "
+                       "used in hook_fd"),
+                     gui_chat_prefix[GUI_CHAT_PREFIX_ERROR],
+                     HOOK_FD(hook, fd));
+}
+
+/*
+ * Starts watching the file descriptor of a fd hook with epoll (if available)
+ * or poll().
+ *
+ * File descriptors that epoll refuses (for example regular files, which are
+ * always ready) are watched with poll().
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+hook_fd_watch (struct t_hook *hook)
+{
+    int fd;
+#ifdef HAVE_SYS_EPOLL_H
+    struct epoll_event event;
+#endif /* HAVE_SYS_EPOLL_H */
+
+    fd = HOOK_FD(hook, fd);
 
-    if (count == 0)
+#ifdef HAVE_SYS_EPOLL_H
+    if (hook_fd_epoll < 0)
+        hook_fd_epoll = epoll_create1 (EPOLL_CLOEXEC);
+    if (hook_fd_epoll >= 0)
     {
-        if (hook_fd_pollfd)
+        memset (&event, 0, sizeof (event));
+        if (HOOK_FD(hook, flags) & HOOK_FD_FLAG_READ)
+            event.events |= EPOLLIN;
+        if (HOOK_FD(hook, flags) & HOOK_FD_FLAG_WRITE)
+            event.events |= EPOLLOUT;
+        event.data.fd = fd;
+        if (epoll_ctl (hook_fd_epoll, EPOLL_CTL_ADD, fd, &event) == 0)
+            return 1;
+        if (errno == EBADF)
         {
-            free (hook_fd_pollfd);
-            hook_fd_pollfd = NULL;
+            /* keep the hook, like poll() would do with an invalid fd */
+            hook_fd_set_error (hook, errno);
+            return 1;
+        }
+        if (errno == EEXIST)
+        {
+            /*
+             * the file is still in epoll, with a file descriptor closed
+             * before its hook was removed (and then reused): rebuild the
+             * epoll instance on next wait, which will add this hook again
+             */
+            hook_fd_epoll_stale = 1;
+            return 1;
         }
     }
-    else
+#endif /* HAVE_SYS_EPOLL_H */
+
+    return hook_fd_pollfd_add (fd, HOOK_FD(hook, flags));
+}
+
+/*
+ * Registers a fd hook: adds it in the fd index and starts watching its file
+ * descriptor.
+ *
+ * Only one hook is allowed per file descriptor (read and write events must be
+ * caught by the same hook).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (file descriptor already hooked or not enough memory)
+ */
+
+int
+hook_fd_register (struct t_hook *hook)
+{
+    struct t_hook **new_index;
+    int fd, new_size;
+
+    fd = HOOK_FD(hook, fd);
+
+    if ((fd < hook_fd_index_size) && hook_fd_index[fd])
+        return 0;
+
+    if (fd >= hook_fd_index_size)
     {
-        ptr_pollfd = realloc (hook_fd_pollfd,
-                              count * sizeof (struct pollfd));
-        if (!ptr_pollfd)
-            return;
-        hook_fd_pollfd = ptr_pollfd;
+        new_size = (hook_fd_index_size == 0) ? 64 : hook_fd_index_size;
+        while (new_size <= fd)
+        {
+            new_size *= 2;
+        }
+        new_index = realloc (hook_fd_index, new_size * sizeof (*new_index));
+        if (!new_index)
+            return 0;
+        memset (new_index + hook_fd_index_size, 0,
+                (new_size - hook_fd_index_size) * sizeof (*new_index));
+        hook_fd_index = new_index;
+        hook_fd_index_size = new_size;
+    }
+
+    if (!hook_fd_watch (hook))
+        return 0;
+
+    hook_fd_index[fd] = hook;
+
+    return 1;
+}
+
+/*
+ * Unregisters a fd hook: removes it from the fd index and stops watching its
+ * file descriptor.
+ */
+
+void
+hook_fd_unregister (struct t_hook *hook)
+{
+    int fd;
+
+    fd = HOOK_FD(hook, fd);
+
+    if ((fd < 0) || (fd >= hook_fd_index_size)
+        || (hook_fd_index[fd] != hook))
+    {
+        return;
+    }
+
+    hook_fd_index[fd] = NULL;
+
+    if (hook_fd_pollfd_remove (fd))
+        return;
+
+#ifdef HAVE_SYS_EPOLL_H
+    /*
+     * epoll watches a file, not a file descriptor: if the fd was closed
+     * before unhook, the file can not be removed from epoll any more, and it
+     * is still watched if another reference to it exists (for example in a
+     * child process created by hook_process or hook_connect); in this case
+     * the epoll instance is rebuilt on next wait (only with hooked fds)
+     */
+    if ((hook_fd_epoll >= 0)
+        && (epoll_ctl (hook_fd_epoll, EPOLL_CTL_DEL, fd, NULL) != 0))
+    {
+        hook_fd_epoll_stale = 1;
+    }
+#endif /* HAVE_SYS_EPOLL_H */
+}
+
+#ifdef HAVE_SYS_EPOLL_H
+/*
+ * Rebuilds the epoll instance with the file descriptors of fd hooks which are
+ * not watched by poll().
+ */
+
+void
+hook_fd_epoll_rebuild ()
+{
+    int fd;
+
+    hook_fd_epoll_stale = 0;
+
+    if (hook_fd_epoll >= 0)
+    {
+        close (hook_fd_epoll);
+        hook_fd_epoll = -1;
     }
 
-    hook_fd_pollfd_count = count;
+    for (fd = 0; fd < hook_fd_index_size; fd++)
+    {
+        if (hook_fd_index[fd] && (hook_fd_pollfd_search (fd) < 0))
+            hook_fd_watch (hook_fd_index[fd]);
+    }
+}
+#endif /* HAVE_SYS_EPOLL_H */
+
+/*
+ * Frees the fd index and the poll()/epoll resources (called when the last fd
+ * hook is removed).
+ */
+
+void
+hook_fd_free_backend ()
+{
+    if (hook_fd_index)
+    {
+        free (hook_fd_index);
+        hook_fd_index = NULL;
+    }
+    hook_fd_index_size = 0;
+
+    if (hook_fd_pollfd)
+    {
+        free (hook_fd_pollfd);
+        hook_fd_pollfd = NULL;
+    }
+    hook_fd_pollfd_size = 0;
+    hook_fd_pollfd_count = 0;
+
+#ifdef HAVE_SYS_EPOLL_H
+    if (hook_fd_epoll >= 0)
+    {
+        close (hook_fd_epoll);
+        hook_fd_epoll = -1;
+    }
+    if (hook_fd_epoll_events)
+    {
+        free (hook_fd_epoll_events);
+        hook_fd_epoll_events = NULL;
+    }
+    hook_fd_epoll_events_size = 0;
+    hook_fd_epoll_stale = 0;
+#endif /* HAVE_SYS_EPOLL_H */
+}
+
+/*
+ * Swaps two timers in heap of timers.
+ */
+
+void
+hook_timer_heap_swap (int index1, int index2)
+{
+    struct t_hook *ptr_hook;
+
+    ptr_hook = hook_timer_heap[index1];
+    hook_timer_heap[index1] = hook_timer_heap[index2];
+    hook_timer_heap[index2] = ptr_hook;
+    HOOK_TIMER(hook_timer_heap[index1], heap_index) = index1;
+    HOOK_TIMER(hook_timer_heap[index2], heap_index) = index2;
+}
+
+/*
+ * Compares next execution of two timers in heap of timers.
+ *
+ * Returns:
+ *   -1: timer at index1 must be executed before timer at index2
+ *    0: same date of next execution
+ *    1: timer at index1 must be executed after timer at index2
+ */
+
+int
+hook_timer_heap_cmp (int index1, int index2)
+{
+    return util_timeval_cmp (&HOOK_TIMER(hook_timer_heap[index1], next_exec),
+                             &HOOK_TIMER(hook_timer_heap[index2], next_exec));
+}
+
+/*
+ * Moves a timer up in heap of timers, until its parent is executed before it.
+ */
+
+void
+hook_timer_heap_sift_up (int index)
+{
+    int parent;
+
+    while (index > 0)
+    {
+        parent = (index - 1) / 2;
+        if (hook_timer_heap_cmp (index, parent) >= 0)
+            break;
+        hook_timer_heap_swap (index, parent);
+        index = parent;
+    }
+}
+
+/*
+ * Moves a timer down in heap of timers, until its children are executed after
+ * it.
+ */
+
+void
+hook_timer_heap_sift_down (int index)
+{
+    int child, smallest;
+
+    while (1)
+    {
+        smallest = index;
+        child = (2 * index) + 1;
+        if ((child < hook_timer_heap_count)
+            && (hook_timer_heap_cmp (child, smallest) < 0))
+        {
+            smallest = child;
+        }
+        child++;
+        if ((child < hook_timer_heap_count)
+            && (hook_timer_heap_cmp (child, smallest) < 0))
+        {
+            smallest = child;
+        }
+        if (smallest == index)
+            break;
+        hook_timer_heap_swap (index, smallest);
+        index = smallest;
+    }
+}
+
+/*
+ * Adds a timer in heap of timers (sorted by date of next execution).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+hook_timer_heap_add (struct t_hook *hook)
+{
+    struct t_hook **new_heap;
+    int new_size;
+
+    if (hook_timer_heap_count >= hook_timer_heap_size)
+    {
+        new_size = (hook_timer_heap_size == 0) ? 32 : hook_timer_heap_size * 2;
+        new_heap = realloc (hook_timer_heap, new_size * sizeof (*new_heap));
+        if (!new_heap)
+            return 0;
+        hook_timer_heap = new_heap;
+        hook_timer_heap_size = new_size;
+    }
+
+    hook_timer_heap[hook_timer_heap_count] = hook;
+    HOOK_TIMER(hook, heap_index) = hook_timer_heap_count;
+    hook_timer_heap_count++;
+    hook_timer_heap_sift_up (hook_timer_heap_count - 1);
+
+    return 1;
+}
+
+/*
+ * Removes a timer from heap of timers.
+ */
+
+void
+hook_timer_heap_remove (struct t_hook *hook)
+{
+    int index;
+
+    index = HOOK_TIMER(hook, heap_index);
+    if ((index < 0) || (index >= hook_timer_heap_count)
+        || (hook_timer_heap[index] != hook))
+    {
+        return;
+    }
+
+    HOOK_TIMER(hook, heap_index) = -1;
+    hook_timer_heap_count--;
+    if (index == hook_timer_heap_count)
+        return;
+
+    /* move last timer to the free slot and restore heap order */
+    hook_timer_heap[index] = hook_timer_heap[hook_timer_heap_count];
+    HOOK_TIMER(hook_timer_heap[index], heap_index) = index;
+    hook_timer_heap_sift_up (index);
+    hook_timer_heap_sift_down (HOOK_TIMER(hook_timer_heap[index], heap_index));
+}
+
+/*
+ * Restores order of heap of timers (after dates of all timers changed).
+ */
+
+void
+hook_timer_heap_rebuild ()
+{
+    int i;
+
+    for (i = (hook_timer_heap_count / 2) - 1; i >= 0; i--)
+    {
+        hook_timer_heap_sift_down (i);
+    }
+}
+
+/*
+ * Frees heap of timers (called when the last timer hook is removed).
+ */
+
+void
+hook_timer_heap_free ()
+{
+    if (hook_timer_heap)
+    {
+        free (hook_timer_heap);
+        hook_timer_heap = NULL;
+    }
+    hook_timer_heap_size = 0;
+    hook_timer_heap_count = 0;
+
+    if (hook_timer_due)
+    {
+        free (hook_timer_due);
+        hook_timer_due = NULL;
+    }
+    hook_timer_due_size = 0;
 }
 
 /*
@@ -249,8 +732,7 @@ hook_add_to_list (struct t_hook *new_hook)
     hooks_count[new_hook->type]++;
     hooks_count_total++;
 
-    if (new_hook->type == HOOK_TYPE_FD)
-        hook_fd_realloc_pollfd ();
+    hook_dispatch_invalidate (new_hook->type);
 }
 
 /*
@@ -285,8 +767,17 @@ hook_remove_from_list (struct t_hook *hook)
     hooks_count[type]--;
     hooks_count_total--;
 
-    if (type == HOOK_TYPE_FD)
-        hook_fd_realloc_pollfd ();
+    if ((type == HOOK_TYPE_TIMER) && (hooks_count[type] == 0))
+        hook_timer_heap_free ();
+    if ((type == HOOK_TYPE_FD) && (hooks_count[type] == 0))
+        hook_fd_free_backend ();
+
+    hook_dispatch_invalidate (type);
+    if ((hooks_count[type] == 0) && hook_dispatch[type])
+    {
+        hashtable_free (hook_dispatch[type]);
+        hook_dispatch[type] = NULL;
+    }
 }
 
 /*
@@ -1098,9 +1589,17 @@ hook_timer (struct t_weechat_plugin *plugin, long interval, int align_second,
     new_hook_timer->interval = interval;
     new_hook_timer->align_second = align_second;
     new_hook_timer->remaining_calls = max_calls;
+    new_hook_timer->heap_index = -1;
 
     hook_timer_init (new_hook);
 
+    if (!hook_timer_heap_add (new_hook))
+    {
+        free (new_hook_timer);
+        free (new_hook);
+        return NULL;
+    }
+
     hook_add_to_list (new_hook);
 
     return new_hook;
@@ -1143,6 +1642,7 @@ hook_timer_check_system_clock ()
             if (!ptr_hook->deleted)
                 hook_timer_init (ptr_hook);
         }
+        hook_timer_heap_rebuild ();
     }
 
     hook_last_system_time = now;
@@ -1155,39 +1655,24 @@ hook_timer_check_system_clock ()
 int
 hook_timer_get_time_to_next ()
 {
-    struct t_hook *ptr_hook;
-    int found, timeout;
+    int timeout;
     struct timeval tv_now, tv_timeout;
     long diff_usec;
 
     hook_timer_check_system_clock ();
 
-    found = 0;
-    tv_timeout.tv_sec = 0;
-    tv_timeout.tv_usec = 0;
-
-    for (ptr_hook = weechat_hooks[HOOK_TYPE_TIMER]; ptr_hook;
-         ptr_hook = ptr_hook->next_hook)
-    {
-        if (!ptr_hook->deleted
-            && (!found
-                || (util_timeval_cmp (&HOOK_TIMER(ptr_hook, next_exec),
-                                      &tv_timeout) < 0)))
-        {
-            found = 1;
-            tv_timeout.tv_sec = HOOK_TIMER(ptr_hook, next_exec).tv_sec;
-            tv_timeout.tv_usec = HOOK_TIMER(ptr_hook, next_exec).tv_usec;
-        }
-    }
-
     /* no timeout found, return 2 seconds by default */
-    if (!found)
+    if (hook_timer_heap_count == 0)
     {
         tv_timeout.tv_sec = 2;
         tv_timeout.tv_usec = 0;
         goto end;
     }
 
+    /* next timeout is the first timer in heap */
+    tv_timeout.tv_sec = HOOK_TIMER(hook_timer_heap[0], next_exec).tv_sec;
+    tv_timeout.tv_usec = HOOK_TIMER(hook_timer_heap[0], next_exec).tv_usec;
+
     gettimeofday (&tv_now, NULL);
 
     /* next timeout is past date! */
@@ -1228,13 +1713,17 @@ end:
 
 /*
  * Executes timer hooks.
+ *
+ * Timers to execute are taken from the top of the heap of timers, so the cost
+ * depends only on the number of timers executed.
  */
 
 void
 hook_timer_exec ()
 {
     struct timeval tv_time;
-    struct t_hook *ptr_hook, *next_hook;
+    struct t_hook *ptr_hook, **new_due;
+    int i, count, new_size;
 
     hook_timer_check_system_clock ();
 
@@ -1242,42 +1731,64 @@ hook_timer_exec ()
 
     hook_exec_start ();
 
-    ptr_hook = weechat_hooks[HOOK_TYPE_TIMER];
-    while (ptr_hook)
+    /*
+     * remove timers to execute from heap before running callbacks, so that
+     * each timer is executed at most one time here
+     */
+    count = 0;
+    while ((hook_timer_heap_count > 0)
+           && (util_timeval_cmp (&HOOK_TIMER(hook_timer_heap[0], next_exec),
+                                 &tv_time) <= 0))
     {
-        next_hook = ptr_hook->next_hook;
+        if (count >= hook_timer_due_size)
+        {
+            new_size = (hook_timer_due_size == 0) ? 32 : hook_timer_due_size * 2;
+            new_due = realloc (hook_timer_due, new_size * sizeof (*new_due));
+            if (!new_due)
+                break;
+            hook_timer_due = new_due;
+            hook_timer_due_size = new_size;
+        }
+        ptr_hook = hook_timer_heap[0];
+        hook_timer_heap_remove (ptr_hook);
+        hook_timer_due[count++] = ptr_hook;
+    }
 
-        if (!ptr_hook->deleted
-            && !ptr_hook->running
-            && (util_timeval_cmp (&HOOK_TIMER(ptr_hook, next_exec),
-                                  &tv_time) <= 0))
+    for (i = 0; i < count; i++)
+    {
+        ptr_hook = hook_timer_due[i];
+
+        if (ptr_hook->deleted)
+            continue;
+
+        ptr_hook->running = 1;
+        (void) (HOOK_TIMER(ptr_hook, callback))
+            (ptr_hook->callback_pointer,
+             ptr_hook->callback_data,
+             (HOOK_TIMER(ptr_hook, remaining_calls) > 0) ?
+              HOOK_TIMER(ptr_hook, remaining_calls) - 1 : -1);
+        ptr_hook->running = 0;
+        if (!ptr_hook->deleted)
         {
-            ptr_hook->running = 1;
-            (void) (HOOK_TIMER(ptr_hook, callback))
-                (ptr_hook->callback_pointer,
-                 ptr_hook->callback_data,
-                 (HOOK_TIMER(ptr_hook, remaining_calls) > 0) ?
-                  HOOK_TIMER(ptr_hook, remaining_calls) - 1 : -1);
-            ptr_hook->running = 0;
-            if (!ptr_hook->deleted)
-            {
-                HOOK_TIMER(ptr_hook, last_exec).tv_sec = tv_time.tv_sec;
-                HOOK_TIMER(ptr_hook, last_exec).tv_usec = tv_time.tv_usec;
+            HOOK_TIMER(ptr_hook, last_exec).tv_sec = tv_time.tv_sec;
+            HOOK_TIMER(ptr_hook, last_exec).tv_usec = tv_time.tv_usec;
 
-                util_timeval_add (
-                    &HOOK_TIMER(ptr_hook, next_exec),
-                    ((long long)HOOK_TIMER(ptr_hook, interval)) * 1000);
+            util_timeval_add (
+                &HOOK_TIMER(ptr_hook, next_exec),
+                ((long long)HOOK_TIMER(ptr_hook, interval)) * 1000);
 
-                if (HOOK_TIMER(ptr_hook, remaining_calls) > 0)
+            if (HOOK_TIMER(ptr_hook, remaining_calls) > 0)
+            {
+                HOOK_TIMER(ptr_hook, remaining_calls)--;
+                if (HOOK_TIMER(ptr_hook, remaining_calls) == 0)
                 {
-                    HOOK_TIMER(ptr_hook, remaining_calls)--;
-                    if (HOOK_TIMER(ptr_hook, remaining_calls) == 0)
-                        unhook (ptr_hook);
+                    unhook (ptr_hook);
+                    continue;
                 }
             }
-        }
 
-        ptr_hook = next_hook;
+            hook_timer_heap_add (ptr_hook);
+        }
     }
 
     hook_exec_end ();
@@ -1292,17 +1803,10 @@ hook_timer_exec ()
 struct t_hook *
 hook_search_fd (int fd)
 {
-    struct t_hook *ptr_hook;
-
-    for (ptr_hook = weechat_hooks[HOOK_TYPE_FD]; ptr_hook;
-         ptr_hook = ptr_hook->next_hook)
-    {
-        if (!ptr_hook->deleted && (HOOK_FD(ptr_hook, fd) == fd))
-            return ptr_hook;
-    }
+    if ((fd < 0) || (fd >= hook_fd_index_size))
+        return NULL;
 
-    /* fd hook not found */
-    return NULL;
+    return hook_fd_index[fd];
 }
 
 /*
@@ -1349,103 +1853,163 @@ hook_fd (struct t_weechat_plugin *plugin, int fd, int flag_read,
     if (flag_exception)
         new_hook_fd->flags |= HOOK_FD_FLAG_EXCEPTION;
 
+    if (!hook_fd_register (new_hook))
+    {
+        free (new_hook_fd);
+        free (new_hook);
+        return NULL;
+    }
+
     hook_add_to_list (new_hook);
 
     return new_hook;
 }
 
+#ifdef HAVE_SYS_EPOLL_H
+/*
+ * Waits for events on the epoll instance.
+ *
+ * Returns number of events received in array hook_fd_epoll_events.
+ */
+
+int
+hook_fd_epoll_wait (int timeout)
+{
+    struct epoll_event *new_events;
+    int new_size, ready;
+
+    if (hook_fd_epoll_events_size < hooks_count[HOOK_TYPE_FD])
+    {
+        new_size = hooks_count[HOOK_TYPE_FD];
+        new_events = realloc (hook_fd_epoll_events,
+                              new_size * sizeof (*new_events));
+        if (new_events)
+        {
+            hook_fd_epoll_events = new_events;
+            hook_fd_epoll_events_size = new_size;
+        }
+    }
+
+    if (hook_fd_epoll_events_size == 0)
+        return 0;
+
+    ready = epoll_wait (hook_fd_epoll, hook_fd_epoll_events,
+                        hook_fd_epoll_events_size, timeout);
+
+    return (ready > 0) ? ready : 0;
+}
+#endif /* HAVE_SYS_EPOLL_H */
+
+/*
+ * Runs callback of the fd hook watching a file descriptor.
+ */
+
+void
+hook_fd_run_callback (int fd)
+{
+    struct t_hook *ptr_hook;
+
+    ptr_hook = hook_search_fd (fd);
+    if (!ptr_hook || ptr_hook->deleted || ptr_hook->running)
+        return;
+
+    ptr_hook->running = 1;
+    (void) (HOOK_FD(ptr_hook, callback)) (
+        ptr_hook->callback_pointer,
+        ptr_hook->callback_data,
+        HOOK_FD(ptr_hook, fd));
+    ptr_hook->running = 0;
+}
+
 /*
  * Executes fd hooks:
- * - poll() on fie descriptors
+ * - wait for events on file descriptors (with epoll and/or poll())
  * - call of hook fd callbacks if needed.
+ *
+ * File descriptors are registered incrementally by hook_fd/unhook, so the
+ * cost of a wakeup depends only on the number of ready file descriptors
+ * (with epoll).
  */
 
 void
 hook_fd_exec ()
 {
-    int i, num_fd, timeout, ready, found;
-    struct t_hook *ptr_hook, *next_hook;
+    int i, fd, timeout, poll_ready, epoll_ready;
+    struct t_hook *ptr_hook;
 
-    /* build an array of "struct pollfd" for poll() */
-    num_fd = 0;
-    for (ptr_hook = weechat_hooks[HOOK_TYPE_FD]; ptr_hook;
-         ptr_hook = ptr_hook->next_hook)
-    {
-        if (!ptr_hook->deleted)
-        {
-            /* skip invalid file descriptors */
-            if ((fcntl (HOOK_FD(ptr_hook,fd), F_GETFD) == -1)
-                && (errno == EBADF))
-            {
-                if (HOOK_FD(ptr_hook, error) == 0)
-                {
-                    HOOK_FD(ptr_hook, error) = errno;
-                    gui_chat_printf (NULL,
-                                     _("%sError: bad file descriptor (%d) "
-                                       "used in hook_fd"),
-                                     gui_chat_prefix[GUI_CHAT_PREFIX_ERROR],
-                                     HOOK_FD(ptr_hook, fd));
-                }
-            }
-            else
-            {
-                if (num_fd > hook_fd_pollfd_count)
-                    break;
+    timeout = hook_timer_get_time_to_next ();
+    if (hook_process_pending)
+        timeout = 0;
 
-                hook_fd_pollfd[num_fd].fd = HOOK_FD(ptr_hook, fd);
-                hook_fd_pollfd[num_fd].events = 0;
-                hook_fd_pollfd[num_fd].revents = 0;
-                if (HOOK_FD(ptr_hook, flags) & HOOK_FD_FLAG_READ)
-                    hook_fd_pollfd[num_fd].events |= POLLIN;
-                if (HOOK_FD(ptr_hook, flags) & HOOK_FD_FLAG_WRITE)
-                    hook_fd_pollfd[num_fd].events |= POLLOUT;
+    poll_ready = 0;
+    epoll_ready = 0;
 
-                num_fd++;
-            }
+#ifdef HAVE_SYS_EPOLL_H
+    if (hook_fd_epoll_stale)
+        hook_fd_epoll_rebuild ();
+
+    if ((hook_fd_epoll >= 0) && (hook_fd_pollfd_count == 0))
+    {
+        /* all file descriptors are watched by epoll */
+        epoll_ready = hook_fd_epoll_wait (timeout);
+    }
+    else if (hook_fd_epoll >= 0)
+    {
+        /*
+         * some file descriptors are not supported by epoll: poll() on them
+         * and on the epoll instance itself
+         */
+        if (!hook_fd_pollfd_add (hook_fd_epoll, HOOK_FD_FLAG_READ))
+            return;
+        poll_ready = poll (hook_fd_pollfd, hook_fd_pollfd_count, timeout);
+        hook_fd_pollfd_count--;
+        if ((poll_ready > 0) && hook_fd_pollfd[hook_fd_pollfd_count].revents)
+        {
+            poll_ready--;
+            epoll_ready = hook_fd_epoll_wait (0);
         }
     }
+    else
+#endif /* HAVE_SYS_EPOLL_H */
+    {
+        poll_ready = poll (hook_fd_pollfd, hook_fd_pollfd_count, timeout);
+    }
 
-    /* perform the poll() */
-    timeout = hook_timer_get_time_to_next ();
-    if (hook_process_pending)
-        timeout = 0;
-    ready = poll (hook_fd_pollfd, num_fd, timeout);
-    if (ready <= 0)
+    if ((poll_ready <= 0) && (epoll_ready <= 0))
         return;
 
     /* execute callbacks for file descriptors with activity */
     hook_exec_start ();
 
-    ptr_hook = weechat_hooks[HOOK_TYPE_FD];
-    while (ptr_hook)
+#ifdef HAVE_SYS_EPOLL_H
+    for (i = 0; i < epoll_ready; i++)
     {
-        next_hook = ptr_hook->next_hook;
+        hook_fd_run_callback (hook_fd_epoll_events[i].data.fd);
+    }
+#endif /* HAVE_SYS_EPOLL_H */
 
-        if (!ptr_hook->deleted
-            && !ptr_hook->running)
+    /*
+     * the array can change in callbacks: a file descriptor moved to an
+     * index already processed will be handled on next call
+     */
+    for (i = 0; (poll_ready > 0) && (i < hook_fd_pollfd_count); i++)
+    {
+        if (!hook_fd_pollfd[i].revents)
+            continue;
+        fd = hook_fd_pollfd[i].fd;
+        if (hook_fd_pollfd[i].revents & POLLNVAL)
         {
-            found = 0;
-            for (i = 0; i < num_fd; i++)
-            {
-                if (hook_fd_pollfd[i].fd == HOOK_FD(ptr_hook, fd)
-                    && hook_fd_pollfd[i].revents)
-                {
-                    found = 1;
-                    break;
-                }
-            }
-            if (found)
-            {
-                ptr_hook->running = 1;
-                (void) (HOOK_FD(ptr_hook, callback)) (
-                    ptr_hook->callback_pointer,
-                    ptr_hook->callback_data,
-                    HOOK_FD(ptr_hook, fd));
-                ptr_hook->running = 0;
-            }
+            /* invalid file descriptor: stop watching it */
+            ptr_hook = hook_search_fd (fd);
+            if (ptr_hook && !ptr_hook->deleted)
+                hook_fd_set_error (ptr_hook, EBADF);
+            hook_fd_pollfd[i].fd = ~fd;
         }
-
-        ptr_hook = next_hook;
+        else
+        {
+            hook_fd_run_callback (fd);
+        }
+        hook_fd_pollfd[i].revents = 0;
     }
 
     hook_exec_end ();
@@ -2073,6 +2637,14 @@ hook_process_run (struct t_hook *hook_process)
         case 0:
             rc = setuid (getuid ());
             (void) rc;
+#ifdef HAVE_SYS_EPOLL_H
+            /* epoll instance is shared with parent: child must not use it */
+            if (hook_fd_epoll >= 0)
+            {
+                close (hook_fd_epoll);
+                hook_fd_epoll = -1;
+            }
+#endif /* HAVE_SYS_EPOLL_H */
             hook_process_child (hook_process);
             /* never executed */
             _exit (EXIT_SUCCESS);
@@ -2397,6 +2969,7 @@ hook_print (struct t_weechat_plugin *plugin, struct t_gui_buffer *buffer,
     new_hook_print->buffer = buffer;
     new_hook_print->tags_count = 0;
     new_hook_print->tags_array = NULL;
+    new_hook_print->tags_compiled = NULL;
     if (tags)
     {
         tags_array = string_split (tags, ",", 0, 0,
@@ -2413,6 +2986,9 @@ hook_print (struct t_weechat_plugin *plugin, struct t_gui_buffer *buffer,
                                                                   "+", 0, 0,
                                                                   NULL);
                 }
+                new_hook_print->tags_compiled =
+                    gui_line_tags_compile (new_hook_print->tags_count,
+                                           new_hook_print->tags_array);
             }
             string_free_split (tags_array);
         }
@@ -2469,7 +3045,8 @@ hook_print_exec (struct t_gui_buffer *buffer, struct t_gui_line *line)
             if (!HOOK_PRINT(ptr_hook, tags_array)
                 || gui_line_match_tags (line->data,
                                         HOOK_PRINT(ptr_hook, tags_count),
-                                        HOOK_PRINT(ptr_hook, tags_array)))
+                                        HOOK_PRINT(ptr_hook, tags_array),
+                                        HOOK_PRINT(ptr_hook, tags_compiled)))
             {
                 /* run callback */
                 ptr_hook->running = 1;
@@ -2496,6 +3073,238 @@ hook_print_exec (struct t_gui_buffer *buffer, struct t_gui_line *line)
     hook_exec_end ();
 }
 
+/*
+ * Returns the signal mask of a signal/hsignal hook (or the modifier name of a
+ * modifier hook).
+ */
+
+const char *
+hook_dispatch_get_mask (struct t_hook *hook)
+{
+    switch (hook->type)
+    {
+        case HOOK_TYPE_SIGNAL:
+            return HOOK_SIGNAL(hook, signal);
+        case HOOK_TYPE_HSIGNAL:
+            return HOOK_HSIGNAL(hook, signal);
+        case HOOK_TYPE_MODIFIER:
+            return HOOK_MODIFIER(hook, modifier);
+        default:
+            break;
+    }
+    return NULL;
+}
+
+/*
+ * Invalidates the dispatch index of a hook type: lists of hooks will be
+ * rebuilt on next dispatch (called when a hook is added or removed).
+ */
+
+void
+hook_dispatch_invalidate (int type)
+{
+    if ((type == HOOK_TYPE_SIGNAL) || (type == HOOK_TYPE_HSIGNAL)
+        || (type == HOOK_TYPE_MODIFIER))
+    {
+        hook_dispatch_generation[type]++;
+    }
+}
+
+/*
+ * Frees a dispatch entry.
+ */
+
+void
+hook_dispatch_free (struct t_hook_dispatch *dispatch)
+{
+    if (!dispatch)
+        return;
+
+    if (dispatch->hooks)
+        free (dispatch->hooks);
+    free (dispatch);
+}
+
+/*
+ * Frees a dispatch entry stored in dispatch index.
+ */
+
+void
+hook_dispatch_free_value_cb (struct t_hashtable *hashtable,
+                             const void *key, void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    hook_dispatch_free ((struct t_hook_dispatch *)value);
+}
+
+/*
+ * Builds the list of hooks matching a signal name (hooks are kept in the same
+ * order as in the list of hooks, so sorted by priority).
+ *
+ * For modifiers, the name must be equal to the modifier of hook (case
+ * insensitive comparison), for signals it must match the mask of hook.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+hook_dispatch_build (struct t_hook_dispatch *dispatch, int type,
+                     const char *name)
+{
+    static struct t_hook **matching = NULL;
+    static int matching_size = 0;
+    struct t_hook *ptr_hook, **new_matching, **new_hooks;
+    const char *ptr_mask;
+    int count, match;
+
+    if (hooks_count[type] > matching_size)
+    {
+        new_matching = realloc (matching,
+                                hooks_count[type] * sizeof (*new_matching));
+        if (!new_matching)
+            return 0;
+        matching = new_matching;
+        matching_size = hooks_count[type];
+    }
+
+    count = 0;
+    for (ptr_hook = weechat_hooks[type]; ptr_hook;
+         ptr_hook = ptr_hook->next_hook)
+    {
+        if (ptr_hook->deleted)
+            continue;
+        ptr_mask = hook_dispatch_get_mask (ptr_hook);
+        match = (type == HOOK_TYPE_MODIFIER) ?
+            (string_strcasecmp (name, ptr_mask) == 0) :
+            string_match (name, ptr_mask, 0);
+        if (match)
+            matching[count++] = ptr_hook;
+    }
+
+    new_hooks = NULL;
+    if (count > 0)
+    {
+        new_hooks = malloc (count * sizeof (*new_hooks));
+        if (!new_hooks)
+            return 0;
+        memcpy (new_hooks, matching, count * sizeof (*new_hooks));
+    }
+
+    if (dispatch->hooks)
+        free (dispatch->hooks);
+    dispatch->hooks = new_hooks;
+    dispatch->hooks_count = count;
+    dispatch->generation = hook_dispatch_generation[type];
+
+    return 1;
+}
+
+/*
+ * Starts dispatch of a signal: returns the list of hooks matching the signal
+ * name.
+ *
+ * The list is stored in the dispatch index of the hook type (hashtable with
+ * signal name as key) and rebuilt only when hooks of this type have changed,
+ * so sending a signal does not check the mask of all hooks.
+ *
+ * If the list is outdated but currently used by another dispatch (signal sent
+ * by a callback of the same signal), a temporary list is returned.
+ *
+ * Returns pointer to dispatch entry, NULL if error.
+ */
+
+struct t_hook_dispatch *
+hook_dispatch_start (int type, const char *name)
+{
+    struct t_hook_dispatch *ptr_dispatch;
+
+    if (!hook_dispatch[type])
+    {
+        hook_dispatch[type] = hashtable_new (64,
+                                             WEECHAT_HASHTABLE_STRING,
+                                             WEECHAT_HASHTABLE_POINTER,
+                                             NULL, NULL);
+        if (!hook_dispatch[type])
+            return NULL;
+        hook_dispatch[type]->callback_free_value = &hook_dispatch_free_value_cb;
+    }
+
+    ptr_dispatch = hashtable_get (hook_dispatch[type], name);
+    if (ptr_dispatch && ptr_dispatch->running
+        && (ptr_dispatch->generation != hook_dispatch_generation[type]))
+    {
+        /* list in use and outdated: use a temporary list */
+        ptr_dispatch = calloc (1, sizeof (*ptr_dispatch));
+        if (!ptr_dispatch)
+            return NULL;
+        ptr_dispatch->temporary = 1;
+        if (!hook_dispatch_build (ptr_dispatch, type, name))
+        {
+            hook_dispatch_free (ptr_dispatch);
+            return NULL;
+        }
+    }
+    else if (!ptr_dispatch)
+    {
+        ptr_dispatch = calloc (1, sizeof (*ptr_dispatch));
+        if (!ptr_dispatch)
+            return NULL;
+        /*
+         * names may come from remote data (for example IRC commands in
+         * signals/modifiers "irc_in_xxx"), so the index is limited: when it
+         * is full, a temporary list is used
+         */
+        if (hook_dispatch[type]->items_count >= HOOK_DISPATCH_MAX_NAMES)
+            ptr_dispatch->temporary = 1;
+        if (!hook_dispatch_build (ptr_dispatch, type, name)
+            || (!ptr_dispatch->temporary
+                && !hashtable_set (hook_dispatch[type], name, ptr_dispatch)))
+        {
+            hook_dispatch_free (ptr_dispatch);
+            return NULL;
+        }
+    }
+    else if (ptr_dispatch->generation != hook_dispatch_generation[type])
+    {
+        if (!hook_dispatch_build (ptr_dispatch, type, name))
+            return NULL;
+    }
+
+    ptr_dispatch->running++;
+
+    return ptr_dispatch;
+}
+
+/*
+ * Ends dispatch of a signal: updates counters of dispatch entry.
+ */
+
+void
+hook_dispatch_end (struct t_hook_dispatch *dispatch,
+                   struct timeval *tv_start)
+{
+    struct timeval tv_end;
+
+    if (!dispatch)
+        return;
+
+    if (dispatch->temporary)
+    {
+        hook_dispatch_free (dispatch);
+        return;
+    }
+
+    gettimeofday (&tv_end, NULL);
+    dispatch->sends++;
+    dispatch->time_usec += util_timeval_diff (tv_start, &tv_end);
+    dispatch->running--;
+}
+
 /*
  * Hooks a signal.
  *
@@ -2546,21 +3355,27 @@ hook_signal (struct t_weechat_plugin *plugin, const char *signal,
 int
 hook_signal_send (const char *signal, const char *type_data, void *signal_data)
 {
-    struct t_hook *ptr_hook, *next_hook;
-    int rc;
+    struct t_hook_dispatch *ptr_dispatch;
+    struct t_hook *ptr_hook;
+    struct timeval tv_start;
+    int i, rc;
 
     rc = WEECHAT_RC_OK;
 
+    if (!signal)
+        return rc;
+
+    gettimeofday (&tv_start, NULL);
+
     hook_exec_start ();
 
-    ptr_hook = weechat_hooks[HOOK_TYPE_SIGNAL];
-    while (ptr_hook)
+    ptr_dispatch = hook_dispatch_start (HOOK_TYPE_SIGNAL, signal);
+    for (i = 0; ptr_dispatch && (i < ptr_dispatch->hooks_count); i++)
     {
-        next_hook = ptr_hook->next_hook;
+        ptr_hook = ptr_dispatch->hooks[i];
 
         if (!ptr_hook->deleted
-            && !ptr_hook->running
-            && (string_match (signal, HOOK_SIGNAL(ptr_hook, signal), 0)))
+            && !ptr_hook->running)
         {
             ptr_hook->running = 1;
             rc = (HOOK_SIGNAL(ptr_hook, callback))
@@ -2570,13 +3385,13 @@ hook_signal_send (const char *signal, const char *type_data, void *signal_data)
                  type_data,
                  signal_data);
             ptr_hook->running = 0;
+            ptr_dispatch->callbacks++;
 
             if (rc == WEECHAT_RC_OK_EAT)
                 break;
         }
-
-        ptr_hook = next_hook;
     }
+    hook_dispatch_end (ptr_dispatch, &tv_start);
 
     hook_exec_end ();
 
@@ -2633,21 +3448,27 @@ hook_hsignal (struct t_weechat_plugin *plugin, const char *signal,
 int
 hook_hsignal_send (const char *signal, struct t_hashtable *hashtable)
 {
-    struct t_hook *ptr_hook, *next_hook;
-    int rc;
+    struct t_hook_dispatch *ptr_dispatch;
+    struct t_hook *ptr_hook;
+    struct timeval tv_start;
+    int i, rc;
 
     rc = WEECHAT_RC_OK;
 
+    if (!signal)
+        return rc;
+
+    gettimeofday (&tv_start, NULL);
+
     hook_exec_start ();
 
-    ptr_hook = weechat_hooks[HOOK_TYPE_HSIGNAL];
-    while (ptr_hook)
+    ptr_dispatch = hook_dispatch_start (HOOK_TYPE_HSIGNAL, signal);
+    for (i = 0; ptr_dispatch && (i < ptr_dispatch->hooks_count); i++)
     {
-        next_hook = ptr_hook->next_hook;
+        ptr_hook = ptr_dispatch->hooks[i];
 
         if (!ptr_hook->deleted
-            && !ptr_hook->running
-            && (string_match (signal, HOOK_HSIGNAL(ptr_hook, signal), 0)))
+            && !ptr_hook->running)
         {
             ptr_hook->running = 1;
             rc = (HOOK_HSIGNAL(ptr_hook, callback))
@@ -2656,13 +3477,13 @@ hook_hsignal_send (const char *signal, struct t_hashtable *hashtable)
                  signal,
                  hashtable);
             ptr_hook->running = 0;
+            ptr_dispatch->callbacks++;
 
             if (rc == WEECHAT_RC_OK_EAT)
                 break;
         }
-
-        ptr_hook = next_hook;
     }
+    hook_dispatch_end (ptr_dispatch, &tv_start);
 
     hook_exec_end ();
 
@@ -2916,8 +3737,11 @@ char *
 hook_modifier_exec (struct t_weechat_plugin *plugin, const char *modifier,
                     const char *modifier_data, const char *string)
 {
-    struct t_hook *ptr_hook, *next_hook;
+    struct t_hook_dispatch *ptr_dispatch;
+    struct t_hook *ptr_hook;
+    struct timeval tv_start;
     char *new_msg, *message_modified;
+    int i;
 
     /* make C compiler happy */
     (void) plugin;
@@ -2930,17 +3754,21 @@ hook_modifier_exec (struct t_weechat_plugin *plugin, const char *modifier,
     if (!message_modified)
         return NULL;
 
+    /* no modifier hooked at all: return string unchanged */
+    if (hooks_count[HOOK_TYPE_MODIFIER] == 0)
+        return message_modified;
+
+    gettimeofday (&tv_start, NULL);
+
     hook_exec_start ();
 
-    ptr_hook = weechat_hooks[HOOK_TYPE_MODIFIER];
-    while (ptr_hook)
+    ptr_dispatch = hook_dispatch_start (HOOK_TYPE_MODIFIER, modifier);
+    for (i = 0; ptr_dispatch && (i < ptr_dispatch->hooks_count); i++)
     {
-        next_hook = ptr_hook->next_hook;
+        ptr_hook = ptr_dispatch->hooks[i];
 
         if (!ptr_hook->deleted
-            && !ptr_hook->running
-            && (string_strcasecmp (HOOK_MODIFIER(ptr_hook, modifier),
-                                   modifier) == 0))
+            && !ptr_hook->running)
         {
             ptr_hook->running = 1;
             new_msg = (HOOK_MODIFIER(ptr_hook, callback))
@@ -2950,13 +3778,14 @@ hook_modifier_exec (struct t_weechat_plugin *plugin, const char *modifier,
                  modifier_data,
                  message_modified);
             ptr_hook->running = 0;
+            ptr_dispatch->callbacks++;
 
             /* empty string returned => message dropped */
             if (new_msg && !new_msg[0])
             {
                 free (message_modified);
-                hook_exec_end ();
-                return new_msg;
+                message_modified = new_msg;
+                break;
             }
 
             /* new message => keep it as base for next modifier */
@@ -2966,9 +3795,8 @@ hook_modifier_exec (struct t_weechat_plugin *plugin, const char *modifier,
                 message_modified = new_msg;
             }
         }
-
-        ptr_hook = next_hook;
     }
+    hook_dispatch_end (ptr_dispatch, &tv_start);
 
     hook_exec_end ();
 
@@ -3779,8 +4607,10 @@ unhook (struct t_hook *hook)
                 }
                 break;
             case HOOK_TYPE_TIMER:
+                hook_timer_heap_remove (hook);
                 break;
             case HOOK_TYPE_FD:
+                hook_fd_unregister (hook);
                 break;
             case HOOK_TYPE_PROCESS:
                 if (HOOK_PROCESS(hook, command))
@@ -3956,6 +4786,13 @@ unhook (struct t_hook *hook)
 #endif /* HOOK_CONNECT_MAX_SOCKETS */
                 break;
             case HOOK_TYPE_PRINT:
+                if (HOOK_PRINT(hook, tags_compiled))
+                {
+                    gui_line_tags_compiled_free (HOOK_PRINT(hook, tags_count),
+                                                 HOOK_PRINT(hook, tags_array),
+                                                 HOOK_PRINT(hook, tags_compiled));
+                    HOOK_PRINT(hook, tags_compiled) = NULL;
+                }
                 if (HOOK_PRINT(hook, tags_array))
                 {
                     for (i = 0; i < HOOK_PRINT(hook, tags_count); i++)
@@ -4114,6 +4951,8 @@ unhook (struct t_hook *hook)
         hook->callback_data = NULL;
     }
 
+    hook_dispatch_invalidate (hook->type);
+
     /* remove hook from list (if there's no hook exec pending) */
     if (hook_exec_recursion == 0)
     {
@@ -4836,6 +5675,7 @@ hook_print_log ()
                     log_printf ("    buffer. . . . . . . . : 0x%lx", HOOK_PRINT(ptr_hook, buffer));
                     log_printf ("    tags_count. . . . . . : %d",    HOOK_PRINT(ptr_hook, tags_count));
                     log_printf ("    tags_array. . . . . . : 0x%lx", HOOK_PRINT(ptr_hook, tags_array));
+                    log_printf ("    tags_compiled . . . . : 0x%lx", HOOK_PRINT(ptr_hook, tags_compiled));
                     log_printf ("    message . . . . . . . : '%s'",  HOOK_PRINT(ptr_hook, message));
                     log_printf ("    strip_colors. . . . . : %d",    HOOK_PRINT(ptr_hook, strip_colors));
                     break;
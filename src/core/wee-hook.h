@@ -198,6 +198,8 @@ struct t_hook_timer
     int remaining_calls;               /* calls remaining (0 = unlimited)   */
     struct timeval last_exec;          /* last time hook was executed       */
     struct timeval next_exec;          /* next scheduled execution          */
+    int heap_index;                    /* index in heap of timers           */
+                                       /* (-1 if not in heap)               */
 };
 
 /* hook fd */
@@ -306,6 +308,7 @@ struct t_hook_print
     struct t_gui_buffer *buffer;       /* buffer selected (NULL = all)      */
     int tags_count;                    /* number of tags selected           */
     char ***tags_array;                /* tags selected (NULL = any)        */
+    const char ***tags_compiled;       /* compiled tags (to match lines)    */
     char *message;                     /* part of message (NULL/empty = all)*/
     int strip_colors;                  /* strip colors in msg for callback? */
 };
@@ -336,6 +339,27 @@ struct t_hook_hsignal
                                        /* with "*", "*" == any signal)      */
 };
 
+/*
+ * dispatch index for signals/hsignals/modifiers (hooks matching a signal or
+ * modifier name)
+ */
+
+#define HOOK_DISPATCH_MAX_NAMES 4096
+
+struct t_hook_dispatch
+{
+    int generation;                    /* generation of hooks when the list */
+                                       /* was built (rebuilt if different)  */
+    int running;                       /* >0 if list is used by a dispatch  */
+    int temporary;                     /* 1 if not stored in dispatch index */
+    struct t_hook **hooks;             /* hooks matching the signal name,   */
+                                       /* sorted by priority                */
+    int hooks_count;                   /* number of hooks in list           */
+    long long sends;                   /* number of times signal was sent   */
+    long long callbacks;               /* number of callbacks called        */
+    long long time_usec;               /* total time spent in dispatch      */
+};
+
 /* hook config */
 
 typedef int (t_hook_callback_config)(const void *pointer, void *data,
@@ -454,6 +478,7 @@ extern struct t_hook *weechat_hooks[];
 extern struct t_hook *last_weechat_hook[];
 extern int hooks_count[];
 extern int hooks_count_total;
+extern struct t_hashtable *hook_dispatch[];
 
 /* hook functions */
 
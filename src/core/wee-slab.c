@@ -0,0 +1,218 @@
+/*
+ * wee-slab.c - slab allocator (items with fixed size allocated in chunks)
+ *
+ * Copyright (C) 2016 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+
+#include "weechat.h"
+#include "wee-slab.h"
+#include "wee-log.h"
+
+
+/* alignment of items in chunks (enough for pointers, integers, time_t) */
+#define SLAB_ALIGN(size) ((((size) + 7) / 8) * 8)
+
+/* offset of first item in a chunk (after the chunk header) */
+#define SLAB_CHUNK_ITEMS(chunk)                                         \
+    (((char *)(chunk)) + SLAB_ALIGN(sizeof (struct t_slab_chunk)))
+
+
+/*
+ * Creates a new slab allocator.
+ *
+ * Items are allocated in chunks: the first chunk has "chunk_size_min" items,
+ * and each new chunk has twice the size of previous one, up to
+ * "chunk_size_max" items. So a slab with few items uses little memory, and a
+ * slab with many items does few allocations.
+ *
+ * Returns pointer to slab, NULL if error.
+ */
+
+struct t_slab *
+slab_new (int item_size, int chunk_size_min, int chunk_size_max)
+{
+    struct t_slab *new_slab;
+
+    /* check arguments */
+    if ((item_size <= 0) || (chunk_size_min <= 0)
+        || (chunk_size_max < chunk_size_min))
+    {
+        return NULL;
+    }
+
+    new_slab = malloc (sizeof (*new_slab));
+    if (!new_slab)
+        return NULL;
+
+    /* an item must be large enough to store a pointer when it is free */
+    if (item_size < (int)sizeof (void *))
+        item_size = sizeof (void *);
+    new_slab->item_size = SLAB_ALIGN(item_size);
+    new_slab->chunk_size_min = chunk_size_min;
+    new_slab->chunk_size_max = chunk_size_max;
+    new_slab->chunks = NULL;
+    new_slab->chunks_count = 0;
+    new_slab->chunk_used = 0;
+    new_slab->free_items = NULL;
+    new_slab->items_count = 0;
+    new_slab->items_alloc = 0;
+
+    return new_slab;
+}
+
+/*
+ * Allocates an item in a slab.
+ *
+ * A free item (released with function slab_release) is reused first, then the
+ * item is taken in the last chunk; a new chunk is allocated only if the last
+ * chunk is full.
+ *
+ * Returns pointer to the item (content is not initialized), NULL if error.
+ */
+
+void *
+slab_alloc (struct t_slab *slab)
+{
+    struct t_slab_chunk *new_chunk;
+    void *item;
+    int size;
+
+    if (!slab)
+        return NULL;
+
+    /* reuse a free item */
+    if (slab->free_items)
+    {
+        item = slab->free_items;
+        slab->free_items = *((void **)item);
+        slab->items_count++;
+        return item;
+    }
+
+    /* allocate a new chunk if needed */
+    if (!slab->chunks || (slab->chunk_used >= slab->chunks->size))
+    {
+        size = (slab->chunks) ? slab->chunks->size * 2 : slab->chunk_size_min;
+        if (size > slab->chunk_size_max)
+            size = slab->chunk_size_max;
+        new_chunk = malloc (SLAB_ALIGN(sizeof (*new_chunk))
+                            + (size * slab->item_size));
+        if (!new_chunk)
+            return NULL;
+        new_chunk->size = size;
+        new_chunk->next_chunk = slab->chunks;
+        slab->chunks = new_chunk;
+        slab->chunks_count++;
+        slab->chunk_used = 0;
+        slab->items_alloc += size;
+    }
+
+    /* take next item in last chunk */
+    item = SLAB_CHUNK_ITEMS(slab->chunks)
+        + (slab->chunk_used * slab->item_size);
+    slab->chunk_used++;
+    slab->items_count++;
+
+    return item;
+}
+
+/*
+ * Releases an item allocated with function slab_alloc: the item will be reused
+ * by next allocation.
+ *
+ * When the last item of the slab is released, all chunks are freed.
+ */
+
+void
+slab_release (struct t_slab *slab, void *item)
+{
+    if (!slab || !item)
+        return;
+
+    *((void **)item) = slab->free_items;
+    slab->free_items = item;
+    slab->items_count--;
+
+    if (slab->items_count <= 0)
+        slab_clear (slab);
+}
+
+/*
+ * Frees all chunks of a slab (all items allocated in the slab are freed).
+ */
+
+void
+slab_clear (struct t_slab *slab)
+{
+    struct t_slab_chunk *ptr_next_chunk;
+
+    if (!slab)
+        return;
+
+    while (slab->chunks)
+    {
+        ptr_next_chunk = slab->chunks->next_chunk;
+        free (slab->chunks);
+        slab->chunks = ptr_next_chunk;
+    }
+    slab->chunks_count = 0;
+    slab->chunk_used = 0;
+    slab->free_items = NULL;
+    slab->items_count = 0;
+    slab->items_alloc = 0;
+}
+
+/*
+ * Frees a slab and all its items.
+ */
+
+void
+slab_free (struct t_slab *slab)
+{
+    if (!slab)
+        return;
+
+    slab_clear (slab);
+    free (slab);
+}
+
+/*
+ * Prints slab in WeeChat log file (usually for crash dump).
+ */
+
+void
+slab_print_log (struct t_slab *slab, const char *name)
+{
+    log_printf ("");
+    log_printf ("[slab %s (addr:0x%lx)]", name, slab);
+    log_printf ("  item_size. . . . . . . : %d",    slab->item_size);
+    log_printf ("  chunk_size_min . . . . : %d",    slab->chunk_size_min);
+    log_printf ("  chunk_size_max . . . . : %d",    slab->chunk_size_max);
+    log_printf ("  chunks . . . . . . . . : 0x%lx", slab->chunks);
+    log_printf ("  chunks_count . . . . . : %d",    slab->chunks_count);
+    log_printf ("  chunk_used . . . . . . : %d",    slab->chunk_used);
+    log_printf ("  free_items . . . . . . : 0x%lx", slab->free_items);
+    log_printf ("  items_count. . . . . . : %d",    slab->items_count);
+    log_printf ("  items_alloc. . . . . . : %d",    slab->items_alloc);
+}
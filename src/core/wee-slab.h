@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2016 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WEECHAT_SLAB_H
+#define WEECHAT_SLAB_H 1
+
+struct t_slab_chunk
+{
+    struct t_slab_chunk *next_chunk;   /* link to next (older) chunk        */
+    int size;                          /* number of items in chunk          */
+};
+
+struct t_slab
+{
+    int item_size;                     /* size of an item (aligned)         */
+    int chunk_size_min;                /* items in first chunk              */
+    int chunk_size_max;                /* max items in a chunk              */
+    struct t_slab_chunk *chunks;       /* chunks (last allocated first)     */
+    int chunks_count;                  /* number of chunks                  */
+    int chunk_used;                    /* items used in last chunk          */
+    void *free_items;                  /* list of free items (to reuse)     */
+    int items_count;                   /* number of items allocated         */
+    int items_alloc;                   /* number of items in all chunks     */
+};
+
+extern struct t_slab *slab_new (int item_size, int chunk_size_min,
+                                int chunk_size_max);
+extern void *slab_alloc (struct t_slab *slab);
+extern void slab_release (struct t_slab *slab, void *item);
+extern void slab_clear (struct t_slab *slab);
+extern void slab_free (struct t_slab *slab);
+extern void slab_print_log (struct t_slab *slab, const char *name);
+
+#endif /* WEECHAT_SLAB_H */
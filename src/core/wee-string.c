@@ -62,6 +62,13 @@
 
 typedef uint32_t string_shared_count_t;
 
+struct t_string_shared
+{
+    string_shared_count_t count;       /* reference count                   */
+    const char *lower;                 /* shared string in lower case       */
+                                       /* (NULL if not yet computed)        */
+};
+
 struct t_hashtable *string_hashtable_shared = NULL;
 
 
@@ -3048,12 +3055,12 @@ string_shared_hash_key (struct t_hashtable *hashtable,
     /* make C compiler happy */
     (void) hashtable;
 
-    return hashtable_hash_key_djb2 (((const char *)key) + sizeof (string_shared_count_t));
+    return hashtable_hash_key_djb2 (((const char *)key) + sizeof (struct t_string_shared));
 }
 
 /*
  * Compares two shared strings.
- * Each string starts after the reference count, which is skipped.
+ * Each string starts after the header (reference count), which is skipped.
  *
  * Returns:
  *   < 0: key1 < key2
@@ -3068,8 +3075,8 @@ string_shared_keycmp (struct t_hashtable *hashtable,
     /* make C compiler happy */
     (void) hashtable;
 
-    return strcmp (((const char *)key1) + sizeof (string_shared_count_t),
-                   ((const char *)key2) + sizeof (string_shared_count_t));
+    return strcmp (((const char *)key1) + sizeof (struct t_string_shared),
+                   ((const char *)key2) + sizeof (struct t_string_shared));
 }
 
 /*
@@ -3089,7 +3096,8 @@ string_shared_free_key (struct t_hashtable *hashtable, void *key)
  * Gets a pointer to a shared string.
  *
  * A shared string is an entry in the hashtable "string_hashtable_shared", with:
- * - key: reference count (unsigned integer on 32 bits) + string
+ * - key: header (reference count and pointer to the lower case string) +
+ *        string
  * - value: NULL pointer (not used)
  *
  * The initial reference count is set to 1 and is incremented each time this
@@ -3128,12 +3136,13 @@ string_shared_get (const char *string)
         string_hashtable_shared->callback_free_key = &string_shared_free_key;
     }
 
-    length = sizeof (string_shared_count_t) + strlen (string) + 1;
+    length = sizeof (struct t_string_shared) + strlen (string) + 1;
     key = malloc (length);
     if (!key)
         return NULL;
-    *((string_shared_count_t *)key) = 1;
-    strcpy (key + sizeof (string_shared_count_t), string);
+    ((struct t_string_shared *)key)->count = 1;
+    ((struct t_string_shared *)key)->lower = NULL;
+    strcpy (key + sizeof (struct t_string_shared), string);
 
     ptr_item = hashtable_get_item (string_hashtable_shared, key, NULL);
     if (ptr_item)
@@ -3142,7 +3151,7 @@ string_shared_get (const char *string)
          * the string already exists in the hashtable, then just increase the
          * reference count on the string
          */
-        (*((string_shared_count_t *)(ptr_item->key)))++;
+        (((struct t_string_shared *)(ptr_item->key))->count)++;
         free (key);
     }
     else
@@ -3154,7 +3163,49 @@ string_shared_get (const char *string)
     }
 
     return (ptr_item) ?
-        ((const char *)ptr_item->key) + sizeof (string_shared_count_t) : NULL;
+        ((const char *)ptr_item->key) + sizeof (struct t_string_shared) : NULL;
+}
+
+/*
+ * Gets the shared string with the content of a shared string in lower case
+ * (only ASCII chars are converted).
+ *
+ * The result is computed on first call and kept with the shared string, so
+ * next calls are fast. Two shared strings which differ only by case have the
+ * same lower case shared string: comparing these pointers is then a fast
+ * case-insensitive comparison of the strings (used for example to match tags
+ * of lines).
+ *
+ * IMPORTANT: the string must be a shared string (returned by function
+ * string_shared_get), and the returned string must NOT be freed: it is freed
+ * with the shared string.
+ *
+ * Returns the pointer to the shared string in lower case, NULL if error.
+ */
+
+const char *
+string_shared_get_lower (const char *string)
+{
+    struct t_string_shared *ptr_shared;
+    char *lower;
+
+    if (!string)
+        return NULL;
+
+    ptr_shared = (struct t_string_shared *)(string - sizeof (*ptr_shared));
+
+    if (!ptr_shared->lower)
+    {
+        lower = strdup (string);
+        if (!lower)
+            return NULL;
+        string_tolower (lower);
+        ptr_shared->lower = (strcmp (lower, string) == 0) ?
+            string : string_shared_get (lower);
+        free (lower);
+    }
+
+    return ptr_shared->lower;
 }
 
 /*
@@ -3168,14 +3219,18 @@ string_shared_get (const char *string)
 void
 string_shared_free (const char *string)
 {
-    string_shared_count_t *ptr_count;
+    struct t_string_shared *ptr_shared;
 
-    ptr_count = (string_shared_count_t *)(string - sizeof (string_shared_count_t));
+    ptr_shared = (struct t_string_shared *)(string - sizeof (*ptr_shared));
 
-    (*ptr_count)--;
+    (ptr_shared->count)--;
 
-    if (*ptr_count == 0)
-        hashtable_remove (string_hashtable_shared, ptr_count);
+    if (ptr_shared->count == 0)
+    {
+        if (ptr_shared->lower && (ptr_shared->lower != string))
+            string_shared_free (ptr_shared->lower);
+        hashtable_remove (string_hashtable_shared, ptr_shared);
+    }
 }
 
 /*
@@ -103,6 +103,7 @@ extern char *string_replace_with_callback (const char *string,
                                            void *callback_data,
                                            int *errors);
 extern const char *string_shared_get (const char *string);
+extern const char *string_shared_get_lower (const char *string);
 extern void string_shared_free (const char *string);
 extern void string_end ();
 
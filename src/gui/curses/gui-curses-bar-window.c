@@ -64,6 +64,8 @@ gui_bar_window_objects_init (struct t_gui_bar_window *bar_window)
         bar_window->gui_objects = new_objects;
         GUI_BAR_WINDOW_OBJECTS(bar_window)->win_bar = NULL;
         GUI_BAR_WINDOW_OBJECTS(bar_window)->win_separator = NULL;
+        GUI_BAR_WINDOW_OBJECTS(bar_window)->drawn = 0;
+        GUI_BAR_WINDOW_OBJECTS(bar_window)->drawn_content = NULL;
         return 1;
     }
     return 0;
@@ -89,6 +91,122 @@ gui_bar_window_objects_free (struct t_gui_bar_window *bar_window)
         delwin (GUI_BAR_WINDOW_OBJECTS(bar_window)->win_separator);
         GUI_BAR_WINDOW_OBJECTS(bar_window)->win_separator = NULL;
     }
+    gui_bar_window_drawn_reset (bar_window);
+}
+
+/*
+ * Resets content drawn in bar window (next draw will draw bar again, even if
+ * content is the same).
+ */
+
+void
+gui_bar_window_drawn_reset (struct t_gui_bar_window *bar_window)
+{
+    if (GUI_BAR_WINDOW_OBJECTS(bar_window)->drawn_content)
+    {
+        free (GUI_BAR_WINDOW_OBJECTS(bar_window)->drawn_content);
+        GUI_BAR_WINDOW_OBJECTS(bar_window)->drawn_content = NULL;
+    }
+    GUI_BAR_WINDOW_OBJECTS(bar_window)->drawn = 0;
+}
+
+/*
+ * Checks if content and display of bar window are the same as the last time
+ * bar window was drawn.
+ *
+ * Returns:
+ *   1: bar window is unchanged (no need to draw it again)
+ *   0: bar window has changed
+ */
+
+int
+gui_bar_window_drawn_unchanged (struct t_gui_bar_window *bar_window,
+                                const char *content)
+{
+    struct t_gui_bar_window_curses_objects *ptr_objects;
+
+    ptr_objects = GUI_BAR_WINDOW_OBJECTS(bar_window);
+
+    if (!ptr_objects->drawn
+        || (ptr_objects->drawn_generation != gui_chat_layout_generation))
+    {
+        return 0;
+    }
+
+    if ((ptr_objects->drawn_width != bar_window->width)
+        || (ptr_objects->drawn_height != bar_window->height)
+        || (ptr_objects->drawn_scroll_x != bar_window->scroll_x)
+        || (ptr_objects->drawn_scroll_y != bar_window->scroll_y)
+        || (ptr_objects->drawn_color_fg != CONFIG_COLOR(bar_window->bar->options[GUI_BAR_OPTION_COLOR_FG]))
+        || (ptr_objects->drawn_color_delim != CONFIG_COLOR(bar_window->bar->options[GUI_BAR_OPTION_COLOR_DELIM]))
+        || (ptr_objects->drawn_color_bg != CONFIG_COLOR(bar_window->bar->options[GUI_BAR_OPTION_COLOR_BG])))
+    {
+        return 0;
+    }
+
+    if (!content || !ptr_objects->drawn_content)
+        return (!content && !ptr_objects->drawn_content) ? 1 : 0;
+
+    return (strcmp (content, ptr_objects->drawn_content) == 0) ? 1 : 0;
+}
+
+/*
+ * Saves content and display of bar window after it has been drawn.
+ *
+ * Note: content is not duplicated, it is freed by bar window.
+ */
+
+void
+gui_bar_window_drawn_save (struct t_gui_bar_window *bar_window,
+                           char *content)
+{
+    struct t_gui_bar_window_curses_objects *ptr_objects;
+
+    ptr_objects = GUI_BAR_WINDOW_OBJECTS(bar_window);
+
+    if (ptr_objects->drawn_content)
+        free (ptr_objects->drawn_content);
+    ptr_objects->drawn_content = content;
+    ptr_objects->drawn_width = bar_window->width;
+    ptr_objects->drawn_height = bar_window->height;
+    ptr_objects->drawn_scroll_x = bar_window->scroll_x;
+    ptr_objects->drawn_scroll_y = bar_window->scroll_y;
+    ptr_objects->drawn_color_fg = CONFIG_COLOR(bar_window->bar->options[GUI_BAR_OPTION_COLOR_FG]);
+    ptr_objects->drawn_color_delim = CONFIG_COLOR(bar_window->bar->options[GUI_BAR_OPTION_COLOR_DELIM]);
+    ptr_objects->drawn_color_bg = CONFIG_COLOR(bar_window->bar->options[GUI_BAR_OPTION_COLOR_BG]);
+    ptr_objects->drawn_generation = gui_chat_layout_generation;
+    ptr_objects->drawn = 1;
+}
+
+/*
+ * Refreshes Curses window of bar and moves cursor if it was asked in an item
+ * content (input_text does that to move cursor in user input text).
+ */
+
+void
+gui_bar_window_refresh_win (struct t_gui_bar_window *bar_window,
+                            struct t_gui_window *window)
+{
+    int x, y;
+
+    if ((!window || (gui_current_window == window))
+        && (bar_window->cursor_x >= 0) && (bar_window->cursor_y >= 0))
+    {
+        y = bar_window->cursor_y - bar_window->y;
+        x = bar_window->cursor_x - bar_window->x;
+        if (x > bar_window->width - 2)
+            x = bar_window->width - 2;
+        wmove (GUI_BAR_WINDOW_OBJECTS(bar_window)->win_bar, y, x);
+        gui_window_refresh_win (GUI_BAR_WINDOW_OBJECTS(bar_window)->win_bar);
+        if (!gui_cursor_mode)
+        {
+            gui_window_cursor_x = bar_window->cursor_x;
+            gui_window_cursor_y = bar_window->cursor_y;
+            move (bar_window->cursor_y, bar_window->cursor_x);
+        }
+    }
+    else
+        gui_window_refresh_win (GUI_BAR_WINDOW_OBJECTS(bar_window)->win_bar);
 }
 
 /*
@@ -98,11 +216,14 @@ gui_bar_window_objects_free (struct t_gui_bar_window *bar_window)
 void
 gui_bar_window_create_win (struct t_gui_bar_window *bar_window)
 {
-    if (!bar_window
-        || CONFIG_BOOLEAN(bar_window->bar->options[GUI_BAR_OPTION_HIDDEN]))
-    {
+    if (!bar_window)
+        return;
+
+    /* new Curses window: bar must be drawn again */
+    gui_bar_window_drawn_reset (bar_window);
+
+    if (CONFIG_BOOLEAN(bar_window->bar->options[GUI_BAR_OPTION_HIDDEN]))
         return;
-    }
 
     if (GUI_BAR_WINDOW_OBJECTS(bar_window)->win_bar)
     {
@@ -453,6 +574,24 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
                   GUI_COLOR_BAR_MOVE_CURSOR_CHAR);
     }
 
+    filling = gui_bar_get_filling (bar_window->bar);
+
+    content = gui_bar_window_content_get_with_filling (bar_window, window);
+    if (content)
+        utf8_normalize (content, '?');
+
+    /*
+     * same content displayed with same size, scroll and colors: the Curses
+     * window already contains the bar, just refresh it (and move cursor)
+     */
+    if (gui_bar_window_drawn_unchanged (bar_window, content))
+    {
+        if (content)
+            free (content);
+        gui_bar_window_refresh_win (bar_window, window);
+        return;
+    }
+
     /*
      * these values will be overwritten later (by gui_bar_window_print_string)
      * if cursor has to move somewhere in bar window
@@ -468,12 +607,8 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
 
     gui_window_current_emphasis = 0;
 
-    filling = gui_bar_get_filling (bar_window->bar);
-
-    content = gui_bar_window_content_get_with_filling (bar_window, window);
     if (content)
     {
-        utf8_normalize (content, '?');
         if ((filling == GUI_BAR_FILLING_HORIZONTAL)
             && (bar_window->scroll_x > 0))
         {
@@ -731,7 +866,6 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
         }
         if (items)
             string_free_split (items);
-        free (content);
     }
     else
     {
@@ -742,28 +876,7 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
                           CONFIG_COLOR(bar_window->bar->options[GUI_BAR_OPTION_COLOR_BG]));
     }
 
-    /*
-     * move cursor if it was asked in an item content (input_text does that
-     * to move cursor in user input text)
-     */
-    if ((!window || (gui_current_window == window))
-        && (bar_window->cursor_x >= 0) && (bar_window->cursor_y >= 0))
-    {
-        y = bar_window->cursor_y - bar_window->y;
-        x = bar_window->cursor_x - bar_window->x;
-        if (x > bar_window->width - 2)
-            x = bar_window->width - 2;
-        wmove (GUI_BAR_WINDOW_OBJECTS(bar_window)->win_bar, y, x);
-        wrefresh (GUI_BAR_WINDOW_OBJECTS(bar_window)->win_bar);
-        if (!gui_cursor_mode)
-        {
-            gui_window_cursor_x = bar_window->cursor_x;
-            gui_window_cursor_y = bar_window->cursor_y;
-            move (bar_window->cursor_y, bar_window->cursor_x);
-        }
-    }
-    else
-        wnoutrefresh (GUI_BAR_WINDOW_OBJECTS(bar_window)->win_bar);
+    gui_bar_window_refresh_win (bar_window, window);
 
     if (CONFIG_INTEGER(bar_window->bar->options[GUI_BAR_OPTION_SEPARATOR]))
     {
@@ -800,10 +913,11 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
             case GUI_BAR_NUM_POSITIONS:
                 break;
         }
-        wnoutrefresh (GUI_BAR_WINDOW_OBJECTS(bar_window)->win_separator);
+        gui_window_refresh_win (GUI_BAR_WINDOW_OBJECTS(bar_window)->win_separator);
     }
 
-    refresh ();
+    /* save content drawn (freed by bar window) */
+    gui_bar_window_drawn_save (bar_window, content);
 }
 
 /*
@@ -816,4 +930,11 @@ gui_bar_window_objects_print_log (struct t_gui_bar_window *bar_window)
     log_printf ("    bar window specific objects for Curses:");
     log_printf ("      win_bar. . . . . . . : 0x%lx", GUI_BAR_WINDOW_OBJECTS(bar_window)->win_bar);
     log_printf ("      win_separator. . . . : 0x%lx", GUI_BAR_WINDOW_OBJECTS(bar_window)->win_separator);
+    log_printf ("      drawn. . . . . . . . : %d",    GUI_BAR_WINDOW_OBJECTS(bar_window)->drawn);
+    log_printf ("      drawn_content. . . . : '%s'",  GUI_BAR_WINDOW_OBJECTS(bar_window)->drawn_content);
+    log_printf ("      drawn_width. . . . . : %d",    GUI_BAR_WINDOW_OBJECTS(bar_window)->drawn_width);
+    log_printf ("      drawn_height . . . . : %d",    GUI_BAR_WINDOW_OBJECTS(bar_window)->drawn_height);
+    log_printf ("      drawn_scroll_x . . . : %d",    GUI_BAR_WINDOW_OBJECTS(bar_window)->drawn_scroll_x);
+    log_printf ("      drawn_scroll_y . . . : %d",    GUI_BAR_WINDOW_OBJECTS(bar_window)->drawn_scroll_y);
+    log_printf ("      drawn_generation . . : %d",    GUI_BAR_WINDOW_OBJECTS(bar_window)->drawn_generation);
 }
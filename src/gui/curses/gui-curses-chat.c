@@ -684,6 +684,7 @@ gui_chat_display_time_to_prefix (struct t_gui_window *window,
     char *prefix_no_color, *prefix_highlighted, *ptr_prefix, *ptr_prefix2;
     char *ptr_prefix_color;
     const char *short_name, *str_color, *ptr_nick_prefix, *ptr_nick_suffix;
+    const char *str_time;
     int i, length, length_allowed, num_spaces, prefix_length, extra_spaces;
     int chars_displayed, nick_offline, prefix_is_nick, length_nick_prefix_suffix;
     int chars_to_display;
@@ -701,12 +702,13 @@ gui_chat_display_time_to_prefix (struct t_gui_window *window,
     }
 
     /* display time */
-    if (window->buffer->time_for_each_line
-        && line->data->str_time && line->data->str_time[0])
+    str_time = (window->buffer->time_for_each_line) ?
+        gui_chat_get_time_string_cached (line->data->date) : NULL;
+    if (str_time && str_time[0])
     {
         if (window->win_chat_cursor_y < window->coords_size)
             window->coords[window->win_chat_cursor_y].time_x1 = window->win_chat_cursor_x;
-        gui_chat_display_word (window, line, line->data->str_time,
+        gui_chat_display_word (window, line, str_time,
                                NULL, 1, num_lines, count,
                                pre_lines_displayed, lines_displayed,
                                simulate,
@@ -1212,6 +1214,245 @@ gui_chat_display_time_to_prefix (struct t_gui_window *window,
         free (ptr_prefix);
 }
 
+/*
+ * Displays message of a line (with word wrapping).
+ */
+
+void
+gui_chat_display_message (struct t_gui_window *window,
+                          struct t_gui_line *line,
+                          int num_lines, int count,
+                          int pre_lines_displayed, int *lines_displayed,
+                          int simulate)
+{
+    int word_start_offset, word_end_offset;
+    int word_length_with_spaces, word_length, line_align;
+    char *message_with_tags, *message_with_search;
+    const char *ptr_data, *ptr_end_offset, *ptr_style, *next_char;
+
+    message_with_tags = (gui_chat_display_tags) ?
+        gui_chat_build_string_message_tags (line) : NULL;
+    ptr_data = (message_with_tags) ?
+        message_with_tags : line->data->message;
+    message_with_search = NULL;
+    if ((window->buffer->text_search != GUI_TEXT_SEARCH_DISABLED)
+        && (window->buffer->text_search_where & GUI_TEXT_SEARCH_IN_MESSAGE)
+        && (!window->buffer->text_search_regex
+            || window->buffer->text_search_regex_compiled))
+    {
+        message_with_search = gui_color_emphasize (ptr_data,
+                                                   window->buffer->input_buffer,
+                                                   window->buffer->text_search_exact,
+                                                   window->buffer->text_search_regex_compiled);
+        if (message_with_search)
+            ptr_data = message_with_search;
+    }
+    while (ptr_data && ptr_data[0])
+    {
+        gui_chat_get_word_info (window,
+                                ptr_data,
+                                &word_start_offset,
+                                &word_end_offset,
+                                &word_length_with_spaces, &word_length);
+
+        ptr_end_offset = ptr_data + word_end_offset;
+
+        /* if message ends with spaces, display them */
+        if ((word_length <= 0) && (word_length_with_spaces > 0)
+            && !ptr_data[word_end_offset + 1])
+        {
+            word_length = word_length_with_spaces;
+        }
+
+        if (word_length >= 0)
+        {
+            line_align = gui_line_get_align (window->buffer, line, 1,
+                                             (*lines_displayed == 0) ? 1 : 0);
+            if ((window->win_chat_cursor_x + word_length_with_spaces > gui_chat_get_real_width (window))
+                && (word_length <= gui_chat_get_real_width (window) - line_align))
+            {
+                /* spaces + word too long for current line but OK for next line */
+                gui_chat_display_new_line (window, num_lines, count,
+                                           lines_displayed, simulate);
+                /* apply styles before jumping to start of word */
+                if (!simulate && (word_start_offset > 0))
+                {
+                    ptr_style = ptr_data;
+                    while (ptr_style < ptr_data + word_start_offset)
+                    {
+                        /* loop until no style/char available */
+                        ptr_style = gui_chat_string_next_char (window, line,
+                                                               (unsigned char *)ptr_style,
+                                                               1,
+                                                               CONFIG_BOOLEAN(config_look_color_inactive_message),
+                                                               0);
+                        if (!ptr_style)
+                            break;
+                        ptr_style = utf8_next_char (ptr_style);
+                    }
+                }
+                /* jump to start of word */
+                ptr_data += word_start_offset;
+            }
+
+            /* display word */
+            gui_chat_display_word (window, line, ptr_data,
+                                   ptr_end_offset + 1,
+                                   0, num_lines, count,
+                                   pre_lines_displayed, lines_displayed,
+                                   simulate,
+                                   CONFIG_BOOLEAN(config_look_color_inactive_message),
+                                   0);
+
+            if ((!simulate) && (window->win_chat_cursor_y >= window->win_chat_height))
+                ptr_data = NULL;
+            else
+            {
+                /* move pointer after end of word */
+                ptr_data = ptr_end_offset + 1;
+                if (*(ptr_data - 1) == '\0')
+                    ptr_data = NULL;
+
+                if (window->win_chat_cursor_x == 0)
+                {
+                    while (ptr_data && (ptr_data[0] == ' '))
+                    {
+                        next_char = utf8_next_char (ptr_data);
+                        if (!next_char)
+                            break;
+                        ptr_data = gui_chat_string_next_char (window, line,
+                                                              (unsigned char *)next_char,
+                                                              1,
+                                                              CONFIG_BOOLEAN(config_look_color_inactive_message),
+                                                              0);
+                    }
+                }
+            }
+        }
+        else
+        {
+            gui_chat_display_new_line (window, num_lines, count,
+                                       lines_displayed, simulate);
+            ptr_data = NULL;
+        }
+    }
+    if (message_with_tags)
+        free (message_with_tags);
+    if (message_with_search)
+        free (message_with_search);
+}
+
+/*
+ * Searches entry for a line in cache of layouts of a window (the cache is
+ * allocated on first call).
+ *
+ * Returns pointer to entry (the entry is used by another line or is empty if
+ * entry->line != line), NULL if error.
+ */
+
+struct t_gui_chat_layout *
+gui_chat_layout_search (struct t_gui_window *window, struct t_gui_line *line)
+{
+    if (!GUI_WINDOW_OBJECTS(window)->chat_layouts)
+    {
+        GUI_WINDOW_OBJECTS(window)->chat_layouts =
+            calloc (GUI_CURSES_CHAT_LAYOUTS_SIZE,
+                    sizeof (*(GUI_WINDOW_OBJECTS(window)->chat_layouts)));
+        if (!GUI_WINDOW_OBJECTS(window)->chat_layouts)
+            return NULL;
+    }
+
+    return &(GUI_WINDOW_OBJECTS(window)->chat_layouts[
+                 ((unsigned long)line >> 4) % GUI_CURSES_CHAT_LAYOUTS_SIZE]);
+}
+
+/*
+ * Removes layout of a line from cache of a window (called when a line is
+ * freed).
+ */
+
+void
+gui_chat_layout_remove_line (struct t_gui_window *window,
+                             struct t_gui_line *line)
+{
+    struct t_gui_chat_layout *ptr_layout;
+
+    if (!window->gui_objects || !GUI_WINDOW_OBJECTS(window)->chat_layouts)
+        return;
+
+    ptr_layout = gui_chat_layout_search (window, line);
+    if (ptr_layout && (ptr_layout->line == line))
+        ptr_layout->line = NULL;
+}
+
+/*
+ * Simulates display of message of a line: the number of lines is taken from
+ * the cache of layouts if possible, so that lines are not wrapped again each
+ * time lines are counted (for example when scrolling).
+ *
+ * The layout in cache is used only if the line, options (generation), size of
+ * window, position of message and alignment did not change.
+ */
+
+void
+gui_chat_display_message_simulate (struct t_gui_window *window,
+                                   struct t_gui_line *line, int count,
+                                   int pre_lines_displayed,
+                                   int *lines_displayed)
+{
+    struct t_gui_chat_layout layout, *ptr_layout;
+    int lines_start;
+
+    ptr_layout = NULL;
+
+    if ((count == 0)
+        && !gui_chat_display_tags
+        && (window->buffer->text_search == GUI_TEXT_SEARCH_DISABLED))
+    {
+        layout.line = line;
+        layout.generation = gui_chat_layout_generation;
+        layout.width = window->win_chat_width;
+        layout.real_width = gui_chat_get_real_width (window);
+        layout.x_start = window->win_chat_cursor_x;
+        layout.lines_start = *lines_displayed;
+        layout.pre_lines = pre_lines_displayed;
+        layout.align_first = gui_line_get_align (window->buffer, line, 1, 1);
+        layout.align_next = gui_line_get_align (window->buffer, line, 1, 0);
+        layout.align_word = gui_line_get_align (window->buffer, line, 0, 0);
+
+        ptr_layout = gui_chat_layout_search (window, line);
+        if (ptr_layout
+            && (ptr_layout->line == layout.line)
+            && (ptr_layout->generation == layout.generation)
+            && (ptr_layout->width == layout.width)
+            && (ptr_layout->real_width == layout.real_width)
+            && (ptr_layout->x_start == layout.x_start)
+            && (ptr_layout->lines_start == layout.lines_start)
+            && (ptr_layout->pre_lines == layout.pre_lines)
+            && (ptr_layout->align_first == layout.align_first)
+            && (ptr_layout->align_next == layout.align_next)
+            && (ptr_layout->align_word == layout.align_word))
+        {
+            *lines_displayed += ptr_layout->lines;
+            window->win_chat_cursor_y += ptr_layout->lines;
+            window->win_chat_cursor_x = ptr_layout->x_end;
+            return;
+        }
+    }
+
+    lines_start = *lines_displayed;
+
+    gui_chat_display_message (window, line, 0, count, pre_lines_displayed,
+                              lines_displayed, 1);
+
+    if (ptr_layout)
+    {
+        layout.lines = *lines_displayed - lines_start;
+        layout.x_end = window->win_chat_cursor_x;
+        memcpy (ptr_layout, &layout, sizeof (layout));
+    }
+}
+
 /*
  * Displays a line in the chat window.
  *
@@ -1227,12 +1468,9 @@ int
 gui_chat_display_line (struct t_gui_window *window, struct t_gui_line *line,
                        int count, int simulate)
 {
-    int num_lines, x, y, pre_lines_displayed, lines_displayed, line_align;
+    int num_lines, x, y, pre_lines_displayed, lines_displayed;
     int read_marker_x, read_marker_y;
-    int word_start_offset, word_end_offset;
-    int word_length_with_spaces, word_length;
-    char *message_with_tags, *message_with_search;
-    const char *ptr_data, *ptr_end_offset, *ptr_style, *next_char;
+    const char *str_time;
     struct t_gui_line *ptr_prev_line, *ptr_next_line;
     struct tm local_time, local_time2;
     struct timeval tv_time;
@@ -1298,8 +1536,10 @@ gui_chat_display_line (struct t_gui_window *window, struct t_gui_line *line,
     }
 
     /* calculate marker position (maybe not used for this line!) */
-    if (window->buffer->time_for_each_line && line->data->str_time)
-        read_marker_x = x + gui_chat_strlen_screen (line->data->str_time);
+    str_time = (window->buffer->time_for_each_line) ?
+        gui_chat_get_time_string_cached (line->data->date) : NULL;
+    if (str_time)
+        read_marker_x = x + gui_chat_strlen_screen (str_time);
     else
         read_marker_x = x;
     read_marker_y = y;
@@ -1337,116 +1577,18 @@ gui_chat_display_line (struct t_gui_window *window, struct t_gui_line *line,
     /* display message */
     if (line->data->message && line->data->message[0])
     {
-        message_with_tags = (gui_chat_display_tags) ?
-            gui_chat_build_string_message_tags (line) : NULL;
-        ptr_data = (message_with_tags) ?
-            message_with_tags : line->data->message;
-        message_with_search = NULL;
-        if ((window->buffer->text_search != GUI_TEXT_SEARCH_DISABLED)
-            && (window->buffer->text_search_where & GUI_TEXT_SEARCH_IN_MESSAGE)
-            && (!window->buffer->text_search_regex
-                || window->buffer->text_search_regex_compiled))
-        {
-            message_with_search = gui_color_emphasize (ptr_data,
-                                                       window->buffer->input_buffer,
-                                                       window->buffer->text_search_exact,
-                                                       window->buffer->text_search_regex_compiled);
-            if (message_with_search)
-                ptr_data = message_with_search;
-        }
-        while (ptr_data && ptr_data[0])
-        {
-            gui_chat_get_word_info (window,
-                                    ptr_data,
-                                    &word_start_offset,
-                                    &word_end_offset,
-                                    &word_length_with_spaces, &word_length);
-
-            ptr_end_offset = ptr_data + word_end_offset;
-
-            /* if message ends with spaces, display them */
-            if ((word_length <= 0) && (word_length_with_spaces > 0)
-                && !ptr_data[word_end_offset + 1])
-            {
-                word_length = word_length_with_spaces;
-            }
-
-            if (word_length >= 0)
-            {
-                line_align = gui_line_get_align (window->buffer, line, 1,
-                                                 (lines_displayed == 0) ? 1 : 0);
-                if ((window->win_chat_cursor_x + word_length_with_spaces > gui_chat_get_real_width (window))
-                    && (word_length <= gui_chat_get_real_width (window) - line_align))
-                {
-                    /* spaces + word too long for current line but OK for next line */
-                    gui_chat_display_new_line (window, num_lines, count,
-                                               &lines_displayed, simulate);
-                    /* apply styles before jumping to start of word */
-                    if (!simulate && (word_start_offset > 0))
-                    {
-                        ptr_style = ptr_data;
-                        while (ptr_style < ptr_data + word_start_offset)
-                        {
-                            /* loop until no style/char available */
-                            ptr_style = gui_chat_string_next_char (window, line,
-                                                                   (unsigned char *)ptr_style,
-                                                                   1,
-                                                                   CONFIG_BOOLEAN(config_look_color_inactive_message),
-                                                                   0);
-                            if (!ptr_style)
-                                break;
-                            ptr_style = utf8_next_char (ptr_style);
-                        }
-                    }
-                    /* jump to start of word */
-                    ptr_data += word_start_offset;
-                }
-
-                /* display word */
-                gui_chat_display_word (window, line, ptr_data,
-                                       ptr_end_offset + 1,
-                                       0, num_lines, count,
-                                       pre_lines_displayed, &lines_displayed,
-                                       simulate,
-                                       CONFIG_BOOLEAN(config_look_color_inactive_message),
-                                       0);
-
-                if ((!simulate) && (window->win_chat_cursor_y >= window->win_chat_height))
-                    ptr_data = NULL;
-                else
-                {
-                    /* move pointer after end of word */
-                    ptr_data = ptr_end_offset + 1;
-                    if (*(ptr_data - 1) == '\0')
-                        ptr_data = NULL;
-
-                    if (window->win_chat_cursor_x == 0)
-                    {
-                        while (ptr_data && (ptr_data[0] == ' '))
-                        {
-                            next_char = utf8_next_char (ptr_data);
-                            if (!next_char)
-                                break;
-                            ptr_data = gui_chat_string_next_char (window, line,
-                                                                  (unsigned char *)next_char,
-                                                                  1,
-                                                                  CONFIG_BOOLEAN(config_look_color_inactive_message),
-                                                                  0);
-                        }
-                    }
-                }
-            }
-            else
-            {
-                gui_chat_display_new_line (window, num_lines, count,
-                                           &lines_displayed, simulate);
-                ptr_data = NULL;
-            }
+        if (simulate)
+        {
+            gui_chat_display_message_simulate (window, line, count,
+                                               pre_lines_displayed,
+                                               &lines_displayed);
+        }
+        else
+        {
+            gui_chat_display_message (window, line, num_lines, count,
+                                      pre_lines_displayed, &lines_displayed,
+                                      0);
         }
-        if (message_with_tags)
-            free (message_with_tags);
-        if (message_with_search)
-            free (message_with_search);
     }
     else
     {
@@ -2082,12 +2224,10 @@ gui_chat_draw (struct t_gui_buffer *buffer, int clear_chat)
                 case GUI_BUFFER_NUM_TYPES:
                     break;
             }
-            wnoutrefresh (GUI_WINDOW_OBJECTS(ptr_win)->win_chat);
+            gui_window_refresh_win (GUI_WINDOW_OBJECTS(ptr_win)->win_chat);
         }
     }
 
-    refresh ();
-
     if (buffer->type == GUI_BUFFER_TYPE_FREE)
     {
         for (ptr_line = buffer->lines->first_line; ptr_line;
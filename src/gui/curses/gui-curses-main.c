@@ -373,6 +373,9 @@ gui_main_refreshs ()
         if (gui_cursor_mode)
             gui_window_move_cursor ();
     }
+
+    /* update terminal (once for all windows and bars refreshed) */
+    gui_window_update ();
 }
 
 /*
@@ -407,6 +410,9 @@ gui_main_loop ()
             gui_color_pairs_auto_reset_pending = 1;
         }
 
+        /* send signal "hotlist_changed" once for all changes in hotlist */
+        gui_hotlist_changed_signal_flush ();
+
         gui_main_refreshs ();
         if (gui_window_refresh_needed && !gui_window_bare_display)
             gui_main_refreshs ();
@@ -68,6 +68,11 @@ int gui_window_current_emphasis;       /* 1 if text emphasis is enabled     */
 struct t_gui_window_saved_style gui_window_saved_style[GUI_WINDOW_MAX_SAVED_STYLES];
                                        /* circular list of saved styles     */
 int gui_window_saved_style_index = 0;  /* index in list of savec styles     */
+int gui_window_update_needed = 0;      /* 1 if terminal must be updated     */
+int gui_window_cells_refreshed = 0;    /* cells refreshed (next update)     */
+int gui_window_cells_last_update = 0;  /* cells refreshed (last update)     */
+long gui_window_updates_count = 0;     /* number of updates of terminal     */
+long long gui_window_cells_total = 0;  /* cells refreshed (all updates)     */
 
 
 /*
@@ -114,6 +119,54 @@ gui_window_read_terminal_size ()
     }
 }
 
+/*
+ * Copies a Curses window to the virtual screen: the terminal is updated later,
+ * once for all windows, by function gui_window_update.
+ *
+ * Only lines changed in the window are copied by Curses: their size is added to
+ * the number of cells refreshed (displayed with /debug term).
+ */
+
+void
+gui_window_refresh_win (WINDOW *window)
+{
+    int y, width, height;
+
+    if (!window)
+        return;
+
+    getmaxyx (window, height, width);
+    for (y = 0; y < height; y++)
+    {
+        if (is_linetouched (window, y))
+            gui_window_cells_refreshed += width;
+    }
+
+    wnoutrefresh (window);
+
+    gui_window_update_needed = 1;
+}
+
+/*
+ * Updates terminal with the Curses windows refreshed since last update (if
+ * any).
+ */
+
+void
+gui_window_update ()
+{
+    if (!gui_window_update_needed)
+        return;
+
+    refresh ();
+
+    gui_window_updates_count++;
+    gui_window_cells_last_update = gui_window_cells_refreshed;
+    gui_window_cells_total += gui_window_cells_refreshed;
+    gui_window_cells_refreshed = 0;
+    gui_window_update_needed = 0;
+}
+
 /*
  * Initializes Curses windows.
  *
@@ -134,6 +187,7 @@ gui_window_objects_init (struct t_gui_window *window)
         GUI_WINDOW_OBJECTS(window)->win_chat = NULL;
         GUI_WINDOW_OBJECTS(window)->win_separator_horiz = NULL;
         GUI_WINDOW_OBJECTS(window)->win_separator_vertic = NULL;
+        GUI_WINDOW_OBJECTS(window)->chat_layouts = NULL;
         return 1;
     }
     return 0;
@@ -163,6 +217,11 @@ gui_window_objects_free (struct t_gui_window *window, int free_separators)
             delwin (GUI_WINDOW_OBJECTS(window)->win_separator_vertic);
             GUI_WINDOW_OBJECTS(window)->win_separator_vertic = NULL;
         }
+        if (GUI_WINDOW_OBJECTS(window)->chat_layouts)
+        {
+            free (GUI_WINDOW_OBJECTS(window)->chat_layouts);
+            GUI_WINDOW_OBJECTS(window)->chat_layouts = NULL;
+        }
     }
 }
 
@@ -1144,7 +1203,7 @@ gui_window_draw_separators (struct t_gui_window *window)
         gui_window_hline (GUI_WINDOW_OBJECTS(window)->win_separator_horiz,
                           0, 0, width,
                           CONFIG_STRING(config_look_separator_horizontal));
-        wnoutrefresh (GUI_WINDOW_OBJECTS(window)->win_separator_horiz);
+        gui_window_refresh_win (GUI_WINDOW_OBJECTS(window)->win_separator_horiz);
     }
 
     /* create/draw vertical separator */
@@ -1159,7 +1218,7 @@ gui_window_draw_separators (struct t_gui_window *window)
         gui_window_vline (GUI_WINDOW_OBJECTS(window)->win_separator_vertic,
                           0, 0, window->win_height,
                           CONFIG_STRING(config_look_separator_vertical));
-        wnoutrefresh (GUI_WINDOW_OBJECTS(window)->win_separator_vertic);
+        gui_window_refresh_win (GUI_WINDOW_OBJECTS(window)->win_separator_vertic);
     }
 }
 
@@ -2577,6 +2636,12 @@ gui_window_term_display_infos ()
     gui_chat_printf (NULL, _("Terminal infos:"));
     gui_chat_printf (NULL, _("  TERM='%s', size: %dx%d"),
                      getenv("TERM"), gui_term_cols, gui_term_lines);
+    gui_chat_printf (NULL,
+                     _("  screen updates: %ld, cells refreshed: %d (last "
+                       "update), %lld (total)"),
+                     gui_window_updates_count,
+                     gui_window_cells_last_update,
+                     gui_window_cells_total);
 }
 
 /*
@@ -2591,4 +2656,5 @@ gui_window_objects_print_log (struct t_gui_window *window)
     log_printf ("    win_chat. . . . . . . : 0x%lx", GUI_WINDOW_OBJECTS(window)->win_chat);
     log_printf ("    win_separator_horiz . : 0x%lx", GUI_WINDOW_OBJECTS(window)->win_separator_horiz);
     log_printf ("    win_separator_vertic. : 0x%lx", GUI_WINDOW_OBJECTS(window)->win_separator_vertic);
+    log_printf ("    chat_layouts. . . . . : 0x%lx", GUI_WINDOW_OBJECTS(window)->chat_layouts);
 }
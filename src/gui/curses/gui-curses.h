@@ -58,17 +58,47 @@ struct t_gui_window_saved_style
     short pair;
 };
 
+/* layout of message of a line, in cache of window */
+
+#define GUI_CURSES_CHAT_LAYOUTS_SIZE 1024
+
+struct t_gui_chat_layout
+{
+    struct t_gui_line *line;        /* line (NULL if entry is not used)     */
+    int generation;                 /* gui_chat_layout_generation           */
+    int width;                      /* width of chat area                   */
+    int real_width;                 /* real width of chat area              */
+    int x_start;                    /* x where message starts               */
+    int lines_start;                /* lines displayed before message       */
+    int pre_lines;                  /* lines displayed before time/prefix   */
+    int align_first;                /* align for first line of message      */
+    int align_next;                 /* align for next lines of message      */
+    int align_word;                 /* align for words on many lines        */
+    int lines;                      /* number of lines used by message      */
+    int x_end;                      /* x after message                      */
+};
+
 struct t_gui_window_curses_objects
 {
     WINDOW *win_chat;               /* chat window (example: channel)       */
     WINDOW *win_separator_horiz;    /* horizontal separator (optional)      */
     WINDOW *win_separator_vertic;   /* vertical separator (optional)        */
+    struct t_gui_chat_layout *chat_layouts; /* layouts of messages (cache)  */
 };
 
 struct t_gui_bar_window_curses_objects
 {
     WINDOW *win_bar;                /* bar Curses window                    */
     WINDOW *win_separator;          /* separator (optional)                 */
+    int drawn;                      /* 1 if bar drawn in Curses window      */
+    char *drawn_content;            /* content drawn (may be NULL)          */
+    int drawn_width, drawn_height;  /* size of bar when drawn               */
+    int drawn_scroll_x;             /* scroll X when drawn                  */
+    int drawn_scroll_y;             /* scroll Y when drawn                  */
+    int drawn_color_fg;             /* bar colors when drawn                */
+    int drawn_color_delim;
+    int drawn_color_bg;
+    int drawn_generation;           /* gui_chat_layout_generation           */
 };
 
 extern int gui_term_cols, gui_term_lines;
@@ -80,6 +110,11 @@ extern int gui_color_pairs_auto_reset_pending;
 extern time_t gui_color_pairs_auto_reset_last;
 extern int gui_color_buffer_refresh_needed;
 extern int gui_window_current_emphasis;
+extern int gui_window_update_needed;
+extern int gui_window_cells_refreshed;
+extern int gui_window_cells_last_update;
+extern long gui_window_updates_count;
+extern long long gui_window_cells_total;
 
 /* main functions */
 extern void gui_main_init ();
@@ -91,6 +126,15 @@ extern int gui_color_get_pair (int fg, int bg);
 extern int gui_color_weechat_get_pair (int weechat_color);
 extern void gui_color_alloc ();
 
+/* bar window functions */
+extern void gui_bar_window_drawn_reset (struct t_gui_bar_window *bar_window);
+extern int gui_bar_window_drawn_unchanged (struct t_gui_bar_window *bar_window,
+                                           const char *content);
+extern void gui_bar_window_drawn_save (struct t_gui_bar_window *bar_window,
+                                       char *content);
+extern void gui_bar_window_refresh_win (struct t_gui_bar_window *bar_window,
+                                        struct t_gui_window *window);
+
 /* chat functions */
 extern void gui_chat_calculate_line_diff (struct t_gui_window *window,
                                           struct t_gui_line **line,
@@ -102,6 +146,8 @@ extern int gui_key_read_cb (const void *pointer, void *data, int fd);
 
 /* window functions */
 extern void gui_window_read_terminal_size ();
+extern void gui_window_refresh_win (WINDOW *window);
+extern void gui_window_update ();
 extern void gui_window_clear (WINDOW *window, int fg, int bg);
 extern void gui_window_clrtoeol (WINDOW *window);
 extern void gui_window_save_style (WINDOW *window);
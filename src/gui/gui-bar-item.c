@@ -25,6 +25,7 @@
 
 #include <stdlib.h>
 #include <stddef.h>
+#include <stdio.h>
 #include <string.h>
 #include <time.h>
 
@@ -356,6 +357,23 @@ gui_bar_item_get_vars (const char *item_name,
         *suffix = strdup (end + 1);
 }
 
+/*
+ * Returns buffer used to build a bar item: buffer forced in item name
+ * ("@buffer:item"), or buffer displayed in window (or in current window if
+ * window is NULL, for a root bar).
+ */
+
+struct t_gui_buffer *
+gui_bar_item_get_buffer (struct t_gui_bar *bar, struct t_gui_window *window,
+                         int item, int subitem)
+{
+    if (bar && bar->items_buffer[item][subitem])
+        return gui_buffer_search_by_full_name (bar->items_buffer[item][subitem]);
+
+    return (window) ?
+        window->buffer : ((gui_current_window) ? gui_current_window->buffer : NULL);
+}
+
 /*
  * Returns value of a bar item.
  *
@@ -382,18 +400,12 @@ gui_bar_item_get_value (struct t_gui_bar *bar, struct t_gui_window *window,
     if (!bar || !bar->items_array[item][subitem])
         return NULL;
 
-    buffer = (window) ?
-        window->buffer : ((gui_current_window) ? gui_current_window->buffer : NULL);
-
     item_value = NULL;
     if (bar->items_name[item][subitem])
     {
-        if (bar->items_buffer[item][subitem])
-        {
-            buffer = gui_buffer_search_by_full_name (bar->items_buffer[item][subitem]);
-            if (!buffer)
-                return NULL;
-        }
+        buffer = gui_bar_item_get_buffer (bar, window, item, subitem);
+        if (!buffer && bar->items_buffer[item][subitem])
+            return NULL;
         ptr_item = gui_bar_item_search_with_plugin ((buffer) ? buffer->plugin : NULL,
                                                     0,
                                                     bar->items_name[item][subitem]);
@@ -575,16 +587,44 @@ gui_bar_item_new (struct t_weechat_plugin *plugin, const char *name,
 }
 
 /*
- * Updates an item on all bars displayed on screen.
+ * Checks if content of an item in a bar window must be built again after a
+ * change in a buffer.
+ *
+ * If buffer is NULL, the item is always built again.
+ *
+ * Returns:
+ *   1: item must be built again
+ *   0: item is unchanged (it has been built for another buffer)
+ */
+
+int
+gui_bar_item_refresh_needed (struct t_gui_bar_window *bar_window,
+                             struct t_gui_buffer *buffer,
+                             int item, int subitem)
+{
+    if (!buffer || !bar_window->items_buffer)
+        return 1;
+
+    return (!bar_window->items_buffer[item][subitem]
+            || (bar_window->items_buffer[item][subitem] == buffer)) ? 1 : 0;
+}
+
+/*
+ * Updates an item on all bars displayed on screen, only where the item has
+ * been built for this buffer (if buffer is NULL, item is updated everywhere).
+ *
+ * The content of items built for other buffers is kept (the item callback is
+ * not called again and the bar is not redrawn).
  */
 
 void
-gui_bar_item_update (const char *item_name)
+gui_bar_item_update_buffer (const char *item_name,
+                            struct t_gui_buffer *buffer)
 {
     struct t_gui_bar *ptr_bar;
     struct t_gui_window *ptr_window;
     struct t_gui_bar_window *ptr_bar_window;
-    int i, j, check_bar_conditions, condition_ok;
+    int i, j, check_bar_conditions, condition_ok, refresh_bar;
 
     if (!item_name)
         return;
@@ -603,11 +643,15 @@ gui_bar_item_update (const char *item_name)
                     if (!CONFIG_BOOLEAN(ptr_bar->options[GUI_BAR_OPTION_HIDDEN]))
                         check_bar_conditions = 1;
 
+                    refresh_bar = (buffer) ? 0 : 1;
                     if (CONFIG_INTEGER(ptr_bar->options[GUI_BAR_OPTION_TYPE]) == GUI_BAR_TYPE_ROOT)
                     {
-                        if (ptr_bar->bar_window)
+                        if (ptr_bar->bar_window
+                            && gui_bar_item_refresh_needed (ptr_bar->bar_window,
+                                                            buffer, i, j))
                         {
                             ptr_bar->bar_window->items_refresh_needed[i][j] = 1;
+                            refresh_bar = 1;
                         }
                     }
                     else
@@ -619,14 +663,18 @@ gui_bar_item_update (const char *item_name)
                                  ptr_bar_window;
                                  ptr_bar_window = ptr_bar_window->next_bar_window)
                             {
-                                if (ptr_bar_window->bar == ptr_bar)
+                                if ((ptr_bar_window->bar == ptr_bar)
+                                    && gui_bar_item_refresh_needed (ptr_bar_window,
+                                                                    buffer, i, j))
                                 {
                                     ptr_bar_window->items_refresh_needed[i][j] = 1;
+                                    refresh_bar = 1;
                                 }
                             }
                         }
                     }
-                    gui_bar_ask_refresh (ptr_bar);
+                    if (refresh_bar)
+                        gui_bar_ask_refresh (ptr_bar);
                 }
             }
         }
@@ -666,6 +714,16 @@ gui_bar_item_update (const char *item_name)
     }
 }
 
+/*
+ * Updates an item on all bars displayed on screen.
+ */
+
+void
+gui_bar_item_update (const char *item_name)
+{
+    gui_bar_item_update_buffer (item_name, NULL);
+}
+
 /*
  * Deletes a bar item.
  */
@@ -1664,8 +1722,80 @@ gui_bar_item_buffer_title_cb (const void *pointer, void *data,
     return (buffer->title) ? strdup (buffer->title) : NULL;
 }
 
+/*
+ * Returns color code for a nick or group in nicklist: color can be a color
+ * name or a WeeChat color option ("file.section.option").
+ *
+ * Colors of nicks and groups are shared strings, so the codes already
+ * resolved are searched by pointer in "colors" (most nicks have the same
+ * colors).
+ */
+
+const char *
+gui_bar_item_buffer_nicklist_color (struct t_gui_bar_item_nicklist_color *colors,
+                                    int *num_colors,
+                                    const char *color)
+{
+    struct t_config_option *ptr_option;
+    const char *ptr_code;
+    int i;
+
+    if (!color)
+        return NULL;
+
+    for (i = 0; (i < *num_colors) && (i < GUI_BAR_ITEM_NICKLIST_COLORS); i++)
+    {
+        if (colors[i].name == color)
+            return colors[i].code;
+    }
+
+    ptr_code = NULL;
+    if (strchr (color, '.'))
+    {
+        config_file_search_with_string (color, NULL, NULL, &ptr_option, NULL);
+        if (ptr_option)
+            ptr_code = gui_color_get_custom (gui_color_get_name (CONFIG_COLOR(ptr_option)));
+    }
+    else
+    {
+        ptr_code = gui_color_get_custom (color);
+    }
+
+    /* save color code (replace the oldest one if all colors are used) */
+    i = *num_colors % GUI_BAR_ITEM_NICKLIST_COLORS;
+    colors[i].name = color;
+    snprintf (colors[i].code, sizeof (colors[i].code),
+              "%s", (ptr_code) ? ptr_code : "");
+    (*num_colors)++;
+
+    return colors[i].code;
+}
+
+/*
+ * Copies a string at the end of nicklist being built, returns pointer to the
+ * new end of nicklist.
+ */
+
+char *
+gui_bar_item_buffer_nicklist_add (char *ptr_end, const char *string)
+{
+    int length;
+
+    if (!string)
+        return ptr_end;
+
+    length = strlen (string);
+    memcpy (ptr_end, string, length);
+    ptr_end[length] = '\0';
+
+    return ptr_end + length;
+}
+
 /*
  * Bar item with nicklist.
+ *
+ * The string is built with a pointer on its end (the nicklist of a buffer
+ * can have thousands of nicks).
  */
 
 char *
@@ -1677,9 +1807,9 @@ gui_bar_item_buffer_nicklist_cb (const void *pointer, void *data,
 {
     struct t_gui_nick_group *ptr_group;
     struct t_gui_nick *ptr_nick;
-    struct t_config_option *ptr_option;
-    int i, length;
-    char *str_nicklist;
+    struct t_gui_bar_item_nicklist_color colors[GUI_BAR_ITEM_NICKLIST_COLORS];
+    int i, length, num_colors;
+    char *str_nicklist, *ptr_end;
 
     /* make C compiler happy */
     (void) pointer;
@@ -1720,6 +1850,8 @@ gui_bar_item_buffer_nicklist_cb (const void *pointer, void *data,
     if (str_nicklist)
     {
         str_nicklist[0] = '\0';
+        ptr_end = str_nicklist;
+        num_colors = 0;
         ptr_group = NULL;
         ptr_nick = NULL;
         gui_nicklist_get_next_item (buffer, &ptr_group, &ptr_nick);
@@ -1730,8 +1862,8 @@ gui_bar_item_buffer_nicklist_cb (const void *pointer, void *data,
                     && buffer->nicklist_display_groups
                     && ptr_group->visible))
             {
-                if (str_nicklist[0])
-                    strcat (str_nicklist, "\n");
+                if (ptr_end > str_nicklist)
+                    ptr_end = gui_bar_item_buffer_nicklist_add (ptr_end, "\n");
 
                 if (ptr_nick)
                 {
@@ -1739,65 +1871,35 @@ gui_bar_item_buffer_nicklist_cb (const void *pointer, void *data,
                     {
                         for (i = 0; i < ptr_nick->group->level; i++)
                         {
-                            strcat (str_nicklist, " ");
-                        }
-                    }
-                    if (ptr_nick->prefix_color)
-                    {
-                        if (strchr (ptr_nick->prefix_color, '.'))
-                        {
-                            config_file_search_with_string (ptr_nick->prefix_color,
-                                                            NULL, NULL, &ptr_option,
-                                                            NULL);
-                            if (ptr_option)
-                                strcat (str_nicklist, gui_color_get_custom (gui_color_get_name (CONFIG_COLOR(ptr_option))));
-                        }
-                        else
-                        {
-                            strcat (str_nicklist, gui_color_get_custom (ptr_nick->prefix_color));
-                        }
-                    }
-                    if (ptr_nick->prefix)
-                        strcat (str_nicklist, ptr_nick->prefix);
-                    if (ptr_nick->color)
-                    {
-                        if (strchr (ptr_nick->color, '.'))
-                        {
-                            config_file_search_with_string (ptr_nick->color,
-                                                            NULL, NULL, &ptr_option,
-                                                            NULL);
-                            if (ptr_option)
-                                strcat (str_nicklist, gui_color_get_custom (gui_color_get_name (CONFIG_COLOR(ptr_option))));
-                        }
-                        else
-                        {
-                            strcat (str_nicklist, gui_color_get_custom (ptr_nick->color));
+                            ptr_end = gui_bar_item_buffer_nicklist_add (ptr_end, " ");
                         }
                     }
-                    strcat (str_nicklist, ptr_nick->name);
+                    ptr_end = gui_bar_item_buffer_nicklist_add (
+                        ptr_end,
+                        gui_bar_item_buffer_nicklist_color (colors, &num_colors,
+                                                            ptr_nick->prefix_color));
+                    ptr_end = gui_bar_item_buffer_nicklist_add (ptr_end,
+                                                                ptr_nick->prefix);
+                    ptr_end = gui_bar_item_buffer_nicklist_add (
+                        ptr_end,
+                        gui_bar_item_buffer_nicklist_color (colors, &num_colors,
+                                                            ptr_nick->color));
+                    ptr_end = gui_bar_item_buffer_nicklist_add (ptr_end,
+                                                                ptr_nick->name);
                 }
                 else
                 {
                     for (i = 0; i < ptr_group->level - 1; i++)
                     {
-                        strcat (str_nicklist, " ");
+                        ptr_end = gui_bar_item_buffer_nicklist_add (ptr_end, " ");
                     }
-                    if (ptr_group->color)
-                    {
-                        if (strchr (ptr_group->color, '.'))
-                        {
-                            config_file_search_with_string (ptr_group->color,
-                                                            NULL, NULL, &ptr_option,
-                                                            NULL);
-                            if (ptr_option)
-                                strcat (str_nicklist, gui_color_get_custom (gui_color_get_name (CONFIG_COLOR(ptr_option))));
-                        }
-                        else
-                        {
-                            strcat (str_nicklist, gui_color_get_custom (ptr_group->color));
-                        }
-                    }
-                    strcat (str_nicklist, gui_nicklist_get_group_start (ptr_group->name));
+                    ptr_end = gui_bar_item_buffer_nicklist_add (
+                        ptr_end,
+                        gui_bar_item_buffer_nicklist_color (colors, &num_colors,
+                                                            ptr_group->color));
+                    ptr_end = gui_bar_item_buffer_nicklist_add (
+                        ptr_end,
+                        gui_nicklist_get_group_start (ptr_group->name));
                 }
             }
             gui_nicklist_get_next_item (buffer, &ptr_group, &ptr_nick);
@@ -1925,7 +2027,7 @@ gui_bar_item_focus_buffer_nicklist_cb (const void *pointer,
 {
     struct t_gui_nick_group *ptr_group;
     struct t_gui_nick *ptr_nick;
-    int i, rc, bar_item_line;
+    int rc, bar_item_line;
     unsigned long int value;
     const char *str_window, *str_buffer, *str_bar_item_line;
     struct t_gui_window *window;
@@ -1975,25 +2077,8 @@ gui_bar_item_focus_buffer_nicklist_cb (const void *pointer,
     if (!error || error[0])
         return NULL;
 
-    i = 0;
-    ptr_group = NULL;
-    ptr_nick = NULL;
-    gui_nicklist_get_next_item (buffer, &ptr_group, &ptr_nick);
-    while (ptr_group || ptr_nick)
-    {
-        if ((ptr_nick && ptr_nick->visible)
-            || (ptr_group && !ptr_nick
-                && buffer->nicklist_display_groups
-                && ptr_group->visible))
-        {
-            if (i == bar_item_line)
-                break;
-            i++;
-        }
-        gui_nicklist_get_next_item (buffer, &ptr_group, &ptr_nick);
-    }
-
-    if (i != bar_item_line)
+    if (!gui_nicklist_get_visible_item (buffer, bar_item_line,
+                                        &ptr_group, &ptr_nick))
         return NULL;
 
     if (ptr_nick)
@@ -2069,25 +2154,80 @@ gui_bar_item_signal_cb (const void *pointer, void *data,
 }
 
 /*
- * Hooks a signal to update bar items.
+ * Callback when a signal with a buffer pointer (string "0x123abc,...") is
+ * received: rebuilds an item, only where it has been built for this buffer.
+ */
+
+int
+gui_bar_item_signal_buffer_cb (const void *pointer, void *data,
+                               const char *signal,
+                               const char *type_data, void *signal_data)
+{
+    unsigned long value;
+    int rc;
+
+    /* make C compiler happy */
+    (void) data;
+    (void) signal;
+    (void) type_data;
+
+    value = 0;
+    if (signal_data)
+    {
+        rc = sscanf ((const char *)signal_data, "%lx", &value);
+        if ((rc == EOF) || (rc == 0))
+            value = 0;
+    }
+
+    gui_bar_item_update_buffer ((char *)pointer,
+                                (struct t_gui_buffer *)value);
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Hooks a signal to update bar items, with a given callback.
  */
 
 void
-gui_bar_item_hook_signal (const char *signal, const char *item)
+gui_bar_item_hook_signal_with_cb (const char *signal, const char *item,
+                                  t_hook_callback_signal *callback)
 {
     struct t_gui_bar_item_hook *bar_item_hook;
 
     bar_item_hook = malloc (sizeof (*bar_item_hook));
     if (bar_item_hook)
     {
-        bar_item_hook->hook = hook_signal (NULL, signal,
-                                           &gui_bar_item_signal_cb,
+        bar_item_hook->hook = hook_signal (NULL, signal, callback,
                                            (void *)item, NULL);
         bar_item_hook->next_hook = gui_bar_item_hooks;
         gui_bar_item_hooks = bar_item_hook;
     }
 }
 
+/*
+ * Hooks a signal to update bar items.
+ */
+
+void
+gui_bar_item_hook_signal (const char *signal, const char *item)
+{
+    gui_bar_item_hook_signal_with_cb (signal, item, &gui_bar_item_signal_cb);
+}
+
+/*
+ * Hooks a signal to update bar items built for the buffer sent in the signal
+ * (signal data must be a string beginning with a buffer pointer, like
+ * signals "nicklist_xxx").
+ */
+
+void
+gui_bar_item_hook_signal_buffer (const char *signal, const char *item)
+{
+    gui_bar_item_hook_signal_with_cb (signal, item,
+                                      &gui_bar_item_signal_buffer_cb);
+}
+
 /*
  * Initializes default items in WeeChat.
  */
@@ -2265,8 +2405,8 @@ gui_bar_item_init ()
                               gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NICKLIST_COUNT]);
     gui_bar_item_hook_signal ("buffer_switch",
                               gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NICKLIST_COUNT]);
-    gui_bar_item_hook_signal ("nicklist_*",
-                              gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NICKLIST_COUNT]);
+    gui_bar_item_hook_signal_buffer ("nicklist_*",
+                                     gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NICKLIST_COUNT]);
 
     /* scroll indicator */
     gui_bar_item_new (NULL,
@@ -2312,8 +2452,8 @@ gui_bar_item_init ()
     gui_bar_item_new (NULL,
                       gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NICKLIST],
                       &gui_bar_item_buffer_nicklist_cb, NULL, NULL);
-    gui_bar_item_hook_signal ("nicklist_*",
-                              gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NICKLIST]);
+    gui_bar_item_hook_signal_buffer ("nicklist_*",
+                                     gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NICKLIST]);
     gui_bar_item_hook_signal ("window_switch",
                               gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NICKLIST]);
     gui_bar_item_hook_signal ("buffer_switch",
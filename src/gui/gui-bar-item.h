@@ -50,6 +50,8 @@ enum t_gui_bar_item_weechat
 };
 
 struct t_gui_window;
+struct t_gui_bar_window;
+struct t_gui_buffer;
 
 struct t_gui_bar_item
 {
@@ -68,6 +70,16 @@ struct t_gui_bar_item
     struct t_gui_bar_item *next_item; /* link to next bar item              */
 };
 
+/* colors resolved while building item "buffer_nicklist" */
+
+#define GUI_BAR_ITEM_NICKLIST_COLORS 8
+
+struct t_gui_bar_item_nicklist_color
+{
+    const char *name;               /* color name (shared string)           */
+    char code[32];                  /* color code (WeeChat internal)        */
+};
+
 struct t_gui_bar_item_hook
 {
     struct t_hook *hook;                   /* pointer to hook               */
@@ -94,6 +106,9 @@ extern int gui_bar_item_used_in_at_least_one_bar (const char *item_name,
 extern void gui_bar_item_get_vars (const char *item_name,
                                    char **buffer, char **prefix, char **name,
                                    char **suffix);
+extern struct t_gui_buffer *gui_bar_item_get_buffer (struct t_gui_bar *bar,
+                                                     struct t_gui_window *window,
+                                                     int item, int subitem);
 extern char *gui_bar_item_get_value (struct t_gui_bar *bar,
                                      struct t_gui_window *window,
                                      int item, int subitem);
@@ -108,6 +123,11 @@ extern struct t_gui_bar_item *gui_bar_item_new (struct t_weechat_plugin *plugin,
                                                                         struct t_hashtable *extra_info),
                                                 const void *build_callback_pointer,
                                                 void *build_callback_data);
+extern int gui_bar_item_refresh_needed (struct t_gui_bar_window *bar_window,
+                                        struct t_gui_buffer *buffer,
+                                        int item, int subitem);
+extern void gui_bar_item_update_buffer (const char *item_name,
+                                        struct t_gui_buffer *buffer);
 extern void gui_bar_item_update (const char *name);
 extern void gui_bar_item_free (struct t_gui_bar_item *item);
 extern void gui_bar_item_free_all ();
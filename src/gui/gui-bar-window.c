@@ -448,6 +448,7 @@ gui_bar_window_content_alloc (struct t_gui_bar_window *bar_window)
     bar_window->items_content = NULL;
     bar_window->items_num_lines = NULL;
     bar_window->items_refresh_needed = NULL;
+    bar_window->items_buffer = NULL;
     bar_window->screen_col_size = 0;
     bar_window->screen_lines = 0;
     bar_window->items_subcount = calloc (1,
@@ -470,12 +471,18 @@ gui_bar_window_content_alloc (struct t_gui_bar_window *bar_window)
                                                sizeof (*bar_window->items_refresh_needed));
     if (!bar_window->items_refresh_needed)
         goto error;
+    bar_window->items_buffer = calloc (1,
+                                       bar_window->items_count *
+                                       sizeof (*bar_window->items_buffer));
+    if (!bar_window->items_buffer)
+        goto error;
 
     for (i = 0; i < bar_window->items_count; i++)
     {
         bar_window->items_content[i] = NULL;
         bar_window->items_num_lines[i] = NULL;
         bar_window->items_refresh_needed[i] = NULL;
+        bar_window->items_buffer[i] = NULL;
     }
 
     for (i = 0; i < bar_window->items_count; i++)
@@ -493,6 +500,10 @@ gui_bar_window_content_alloc (struct t_gui_bar_window *bar_window)
                                                       sizeof (**bar_window->items_refresh_needed));
         if (!bar_window->items_refresh_needed[i])
             goto error;
+        bar_window->items_buffer[i] = malloc (bar_window->items_subcount[i] *
+                                              sizeof (**bar_window->items_buffer));
+        if (!bar_window->items_buffer[i])
+            goto error;
         for (j = 0; j < bar_window->items_subcount[i]; j++)
         {
             if (bar_window->items_content[i])
@@ -501,6 +512,8 @@ gui_bar_window_content_alloc (struct t_gui_bar_window *bar_window)
                 bar_window->items_num_lines[i][j] = 0;
             if (bar_window->items_refresh_needed[i])
                 bar_window->items_refresh_needed[i][j] = 1;
+            if (bar_window->items_buffer[i])
+                bar_window->items_buffer[i][j] = NULL;
         }
     }
     return;
@@ -541,6 +554,16 @@ error:
         free (bar_window->items_refresh_needed);
         bar_window->items_refresh_needed = NULL;
     }
+    if (bar_window->items_buffer)
+    {
+        for (i = 0; i < bar_window->items_count; i++)
+        {
+            if (bar_window->items_buffer[i])
+                free (bar_window->items_buffer[i]);
+        }
+        free (bar_window->items_buffer);
+        bar_window->items_buffer = NULL;
+    }
 }
 
 /*
@@ -570,6 +593,7 @@ gui_bar_window_content_free (struct t_gui_bar_window *bar_window)
             free (bar_window->items_content[i]);
             free (bar_window->items_num_lines[i]);
             free (bar_window->items_refresh_needed[i]);
+            free (bar_window->items_buffer[i]);
         }
         free (bar_window->items_subcount);
         bar_window->items_subcount = NULL;
@@ -579,6 +603,8 @@ gui_bar_window_content_free (struct t_gui_bar_window *bar_window)
         bar_window->items_num_lines = NULL;
         free (bar_window->items_refresh_needed);
         bar_window->items_refresh_needed = NULL;
+        free (bar_window->items_buffer);
+        bar_window->items_buffer = NULL;
     }
 }
 
@@ -602,6 +628,7 @@ gui_bar_window_content_build_item (struct t_gui_bar_window *bar_window,
             bar_window->items_content[index_item][index_subitem] = NULL;
         }
         bar_window->items_num_lines[index_item][index_subitem] = 0;
+        bar_window->items_buffer[index_item][index_subitem] = NULL;
 
         /* build item, but only if there's a buffer in window */
         if ((window && window->buffer)
@@ -613,6 +640,9 @@ gui_bar_window_content_build_item (struct t_gui_bar_window *bar_window,
             bar_window->items_num_lines[index_item][index_subitem] =
                 gui_bar_item_count_lines (bar_window->items_content[index_item][index_subitem]);
             bar_window->items_refresh_needed[index_item][index_subitem] = 0;
+            bar_window->items_buffer[index_item][index_subitem] =
+                gui_bar_item_get_buffer (bar_window->bar, window,
+                                         index_item, index_subitem);
         }
     }
 }
@@ -644,7 +674,8 @@ gui_bar_window_content_build (struct t_gui_bar_window *bar_window,
 }
 
 /*
- * Gets item or subitem content (first rebuilds content if refresh is needed).
+ * Gets item or subitem content (first rebuilds content if refresh is needed
+ * or if content was built for another buffer).
  */
 
 const char *
@@ -655,8 +686,11 @@ gui_bar_window_content_get (struct t_gui_bar_window *bar_window,
     if (!bar_window)
         return NULL;
 
-    /* rebuild content if refresh is needed */
-    if (bar_window->items_refresh_needed[index_item][index_subitem])
+    /* rebuild content if refresh is needed or if buffer has changed */
+    if (bar_window->items_refresh_needed[index_item][index_subitem]
+        || (bar_window->items_buffer[index_item][index_subitem]
+            != gui_bar_item_get_buffer (bar_window->bar, window,
+                                        index_item, index_subitem)))
     {
         gui_bar_window_content_build_item (bar_window, window,
                                            index_item, index_subitem);
@@ -1154,6 +1188,7 @@ gui_bar_window_new (struct t_gui_bar *bar, struct t_gui_window *window)
         new_bar_window->items_content = NULL;
         new_bar_window->items_num_lines = NULL;
         new_bar_window->items_refresh_needed = NULL;
+        new_bar_window->items_buffer = NULL;
         new_bar_window->screen_col_size = 0;
         new_bar_window->screen_lines = 0;
         new_bar_window->coords_count = 0;
@@ -1552,6 +1587,7 @@ gui_bar_window_hdata_bar_window_cb (const void *pointer, void *data,
         HDATA_VAR(struct t_gui_bar_window, items_content, POINTER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_bar_window, items_num_lines, POINTER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_bar_window, items_refresh_needed, POINTER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_bar_window, items_buffer, POINTER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_bar_window, screen_col_size, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_bar_window, screen_lines, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_bar_window, coords_count, INTEGER, 0, NULL, NULL);
@@ -1668,13 +1704,15 @@ gui_bar_window_print_log (struct t_gui_bar_window *bar_window)
             for (j = 0; j < bar_window->items_subcount[i]; j++)
             {
                 log_printf ("    items_content[%03d][%03d]: '%s' "
-                            "(item: '%s', num_lines: %d, refresh_needed: %d)",
+                            "(item: '%s', num_lines: %d, refresh_needed: %d, "
+                            "buffer: 0x%lx)",
                             i, j,
                             bar_window->items_content[i][j],
                             (bar_window->items_count >= i + 1) ?
                             bar_window->bar->items_array[i][j] : "?",
                             bar_window->items_num_lines[i][j],
-                            bar_window->items_refresh_needed[i][j]);
+                            bar_window->items_refresh_needed[i][j],
+                            bar_window->items_buffer[i][j]);
             }
         }
         else
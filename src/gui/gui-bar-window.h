@@ -48,6 +48,7 @@ struct t_gui_bar_window
     char ***items_content;          /* content for each (sub)item of bar    */
     int **items_num_lines;          /* number of lines for each (sub)item   */
     int **items_refresh_needed;     /* refresh needed for (sub)item?        */
+    struct t_gui_buffer ***items_buffer; /* buffer used to build (sub)item  */
     int screen_col_size;            /* size of columns on screen            */
                                     /* (for filling with columns)           */
     int screen_lines;               /* number of lines on screen            */
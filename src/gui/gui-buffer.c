@@ -64,6 +64,13 @@ struct t_gui_buffer *gui_buffers = NULL;           /* first buffer          */
 struct t_gui_buffer *last_gui_buffer = NULL;       /* last buffer           */
 int gui_buffers_count = 0;                         /* number of buffers     */
 
+/* indexes of buffers (by full name and by number) */
+struct t_hashtable *gui_buffers_index_full_name = NULL; /* full name->buffer*/
+int gui_buffers_index_full_name_dirty = 1;      /* 1 if index must be built */
+int gui_buffers_index_full_name_dups = 0;       /* buffers with same name   */
+struct t_hashtable *gui_buffers_index_number = NULL; /* number -> buffer    */
+int gui_buffers_index_number_dirty = 1;         /* 1 if index must be built */
+
 /* history of last visited buffers */
 struct t_gui_buffer_visited *gui_buffers_visited = NULL;
 struct t_gui_buffer_visited *last_gui_buffer_visited = NULL;
@@ -82,7 +89,8 @@ char *gui_buffer_properties_get_integer[] =
   "prefix_max_length", "time_for_each_line", "nicklist",
   "nicklist_case_sensitive", "nicklist_max_length", "nicklist_display_groups",
   "nicklist_count", "nicklist_groups_count", "nicklist_nicks_count",
-  "nicklist_visible_count", "input", "input_get_unknown_commands",
+  "nicklist_visible_count", "nicklist_bulk", "nickcmp_index", "input",
+  "input_get_unknown_commands",
   "input_size", "input_length", "input_pos", "input_1st_display",
   "num_history", "text_search", "text_search_exact", "text_search_regex",
   "text_search_where", "text_search_found",
@@ -102,7 +110,9 @@ char *gui_buffer_properties_set[] =
 { "hotlist", "unread", "display", "hidden", "print_hooks_enabled", "day_change",
   "clear", "filter", "number", "name", "short_name", "type", "notify", "title",
   "time_for_each_line", "nicklist", "nicklist_case_sensitive",
-  "nicklist_display_groups", "highlight_words", "highlight_words_add",
+  "nicklist_display_groups", "nicklist_bulk", "nickcmp_index",
+  "highlight_words",
+  "highlight_words_add",
   "highlight_words_del", "highlight_regex", "highlight_tags_restrict",
   "highlight_tags", "hotlist_max_level_nicks", "hotlist_max_level_nicks_add",
   "hotlist_max_level_nicks_del", "input", "input_pos",
@@ -145,6 +155,176 @@ gui_buffer_get_short_name (struct t_gui_buffer *buffer)
     return (buffer->short_name) ? buffer->short_name : buffer->name;
 }
 
+/*
+ * Builds index of buffers by full name.
+ *
+ * If many buffers have same full name, the first one in list is kept in index
+ * and the number of duplicates is stored (searches will then loop on buffers).
+ */
+
+void
+gui_buffer_index_full_name_build ()
+{
+    struct t_gui_buffer *ptr_buffer;
+
+    if (!gui_buffers_index_full_name)
+    {
+        gui_buffers_index_full_name = hashtable_new (
+            32,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL, NULL);
+        if (!gui_buffers_index_full_name)
+            return;
+    }
+    else
+    {
+        hashtable_remove_all (gui_buffers_index_full_name);
+    }
+
+    gui_buffers_index_full_name_dups = 0;
+    for (ptr_buffer = gui_buffers; ptr_buffer;
+         ptr_buffer = ptr_buffer->next_buffer)
+    {
+        if (!ptr_buffer->full_name)
+            continue;
+        if (hashtable_has_key (gui_buffers_index_full_name,
+                               ptr_buffer->full_name))
+            gui_buffers_index_full_name_dups++;
+        else
+            hashtable_set (gui_buffers_index_full_name,
+                           ptr_buffer->full_name, ptr_buffer);
+    }
+
+    gui_buffers_index_full_name_dirty = 0;
+}
+
+/*
+ * Adds a buffer in index of buffers by full name.
+ */
+
+void
+gui_buffer_index_full_name_add (struct t_gui_buffer *buffer)
+{
+    struct t_gui_buffer *ptr_buffer;
+
+    if (gui_buffers_index_full_name_dirty || !buffer->full_name)
+        return;
+
+    ptr_buffer = hashtable_get (gui_buffers_index_full_name,
+                                buffer->full_name);
+    if (!ptr_buffer)
+    {
+        hashtable_set (gui_buffers_index_full_name,
+                       buffer->full_name, buffer);
+    }
+    else if (ptr_buffer != buffer)
+    {
+        /* another buffer has same name: the index will be built again */
+        gui_buffers_index_full_name_dirty = 1;
+    }
+}
+
+/*
+ * Removes a buffer from index of buffers by full name.
+ */
+
+void
+gui_buffer_index_full_name_remove (struct t_gui_buffer *buffer)
+{
+    if (gui_buffers_index_full_name_dirty || !buffer->full_name)
+        return;
+
+    if (gui_buffers_index_full_name_dups > 0)
+    {
+        /* another buffer with same name may replace this one in index */
+        gui_buffers_index_full_name_dirty = 1;
+        return;
+    }
+
+    if (hashtable_get (gui_buffers_index_full_name,
+                       buffer->full_name) == buffer)
+    {
+        hashtable_remove (gui_buffers_index_full_name, buffer->full_name);
+    }
+}
+
+/*
+ * Builds index of buffers by number (first buffer in list for each number,
+ * for merged buffers).
+ */
+
+void
+gui_buffer_index_number_build ()
+{
+    struct t_gui_buffer *ptr_buffer;
+
+    if (!gui_buffers_index_number)
+    {
+        gui_buffers_index_number = hashtable_new (
+            32,
+            WEECHAT_HASHTABLE_INTEGER,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL, NULL);
+        if (!gui_buffers_index_number)
+            return;
+    }
+    else
+    {
+        hashtable_remove_all (gui_buffers_index_number);
+    }
+
+    for (ptr_buffer = gui_buffers; ptr_buffer;
+         ptr_buffer = ptr_buffer->next_buffer)
+    {
+        if (!ptr_buffer->prev_buffer
+            || (ptr_buffer->number != ptr_buffer->prev_buffer->number))
+        {
+            hashtable_set (gui_buffers_index_number,
+                           &(ptr_buffer->number), ptr_buffer);
+        }
+    }
+
+    gui_buffers_index_number_dirty = 0;
+}
+
+/*
+ * Invalidates index of buffers by number (it will be built again on next
+ * search by number).
+ *
+ * This function must be called each time numbers of buffers or order of
+ * buffers in list are changed.
+ */
+
+void
+gui_buffer_index_number_invalidate ()
+{
+    gui_buffers_index_number_dirty = 1;
+}
+
+/*
+ * Frees indexes of buffers.
+ */
+
+void
+gui_buffer_index_free ()
+{
+    if (gui_buffers_index_full_name)
+    {
+        hashtable_free (gui_buffers_index_full_name);
+        gui_buffers_index_full_name = NULL;
+    }
+    gui_buffers_index_full_name_dirty = 1;
+    gui_buffers_index_full_name_dups = 0;
+
+    if (gui_buffers_index_number)
+    {
+        hashtable_free (gui_buffers_index_number);
+        gui_buffers_index_number = NULL;
+    }
+    gui_buffers_index_number_dirty = 1;
+}
+
 /*
  * Builds "full_name" of buffer (for example after changing name or
  * plugin_name_for_upgrade).
@@ -159,7 +339,10 @@ gui_buffer_build_full_name (struct t_gui_buffer *buffer)
         return;
 
     if (buffer->full_name)
+    {
+        gui_buffer_index_full_name_remove (buffer);
         free (buffer->full_name);
+    }
     length = strlen (gui_buffer_get_plugin_name (buffer)) + 1 +
         strlen (buffer->name) + 1;
     buffer->full_name = malloc (length);
@@ -167,6 +350,7 @@ gui_buffer_build_full_name (struct t_gui_buffer *buffer)
     {
         snprintf (buffer->full_name, length, "%s.%s",
                   gui_buffer_get_plugin_name (buffer), buffer->name);
+        gui_buffer_index_full_name_add (buffer);
     }
 }
 
@@ -390,6 +574,8 @@ gui_buffer_shift_numbers (struct t_gui_buffer *buffer)
         }
         ptr_buffer->number++;
     }
+
+    gui_buffer_index_number_invalidate ();
 }
 
 /*
@@ -507,6 +693,8 @@ gui_buffer_insert (struct t_gui_buffer *buffer)
         last_gui_buffer = buffer;
     }
 
+    gui_buffer_index_number_invalidate ();
+
     if (merge_buffer)
         gui_buffer_merge (buffer, merge_buffer);
     else
@@ -648,9 +836,14 @@ gui_buffer_new (struct t_weechat_plugin *plugin,
     new_buffer->nicklist_groups_count = 0;
     new_buffer->nicklist_nicks_count = 0;
     new_buffer->nicklist_visible_count = 0;
+    new_buffer->nicklist_bulk = 0;
+    new_buffer->nicklist_bulk_changes = 0;
+    new_buffer->nicklist_nicks_index = NULL;
+    new_buffer->nicklist_nicks_index_collisions = 0;
     new_buffer->nickcmp_callback = NULL;
     new_buffer->nickcmp_callback_pointer = NULL;
     new_buffer->nickcmp_callback_data = NULL;
+    new_buffer->nickcmp_index = 0;
     gui_nicklist_add_group (new_buffer, NULL, "root", NULL, 0);
 
     /* input */
@@ -702,9 +895,11 @@ gui_buffer_new (struct t_weechat_plugin *plugin,
     new_buffer->highlight_tags_restrict = NULL;
     new_buffer->highlight_tags_restrict_count = 0;
     new_buffer->highlight_tags_restrict_array = NULL;
+    new_buffer->highlight_tags_restrict_compiled = NULL;
     new_buffer->highlight_tags = NULL;
     new_buffer->highlight_tags_count = 0;
     new_buffer->highlight_tags_array = NULL;
+    new_buffer->highlight_tags_compiled = NULL;
 
     /* hotlist */
     new_buffer->hotlist_max_level_nicks = hashtable_new (
@@ -1048,6 +1243,10 @@ gui_buffer_get_integer (struct t_gui_buffer *buffer, const char *property)
         return buffer->nicklist_nicks_count;
     else if (string_strcasecmp (property, "nicklist_visible_count") == 0)
         return buffer->nicklist_visible_count;
+    else if (string_strcasecmp (property, "nicklist_bulk") == 0)
+        return buffer->nicklist_bulk;
+    else if (string_strcasecmp (property, "nickcmp_index") == 0)
+        return buffer->nickcmp_index;
     else if (string_strcasecmp (property, "input") == 0)
         return buffer->input;
     else if (string_strcasecmp (property, "input_get_unknown_commands") == 0)
@@ -1530,6 +1729,13 @@ gui_buffer_set_highlight_tags_restrict (struct t_gui_buffer *buffer,
         free (buffer->highlight_tags_restrict);
         buffer->highlight_tags_restrict = NULL;
     }
+    if (buffer->highlight_tags_restrict_compiled)
+    {
+        gui_line_tags_compiled_free (buffer->highlight_tags_restrict_count,
+                                     buffer->highlight_tags_restrict_array,
+                                     buffer->highlight_tags_restrict_compiled);
+        buffer->highlight_tags_restrict_compiled = NULL;
+    }
     if (buffer->highlight_tags_restrict_array)
     {
         for (i = 0; i < buffer->highlight_tags_restrict_count; i++)
@@ -1563,6 +1769,9 @@ gui_buffer_set_highlight_tags_restrict (struct t_gui_buffer *buffer,
                                                                          "+", 0, 0,
                                                                          NULL);
             }
+            buffer->highlight_tags_restrict_compiled =
+                gui_line_tags_compile (buffer->highlight_tags_restrict_count,
+                                       buffer->highlight_tags_restrict_array);
         }
         string_free_split (tags_array);
     }
@@ -1587,6 +1796,13 @@ gui_buffer_set_highlight_tags (struct t_gui_buffer *buffer,
         free (buffer->highlight_tags);
         buffer->highlight_tags = NULL;
     }
+    if (buffer->highlight_tags_compiled)
+    {
+        gui_line_tags_compiled_free (buffer->highlight_tags_count,
+                                     buffer->highlight_tags_array,
+                                     buffer->highlight_tags_compiled);
+        buffer->highlight_tags_compiled = NULL;
+    }
     if (buffer->highlight_tags_array)
     {
         for (i = 0; i < buffer->highlight_tags_count; i++)
@@ -1620,6 +1836,9 @@ gui_buffer_set_highlight_tags (struct t_gui_buffer *buffer,
                                                                 "+", 0, 0,
                                                                 NULL);
             }
+            buffer->highlight_tags_compiled =
+                gui_line_tags_compile (buffer->highlight_tags_count,
+                                       buffer->highlight_tags_array);
         }
         string_free_split (tags_array);
     }
@@ -1942,6 +2161,25 @@ gui_buffer_set (struct t_gui_buffer *buffer, const char *property,
         if (error && !error[0])
             gui_buffer_set_nicklist_display_groups (buffer, number);
     }
+    else if (string_strcasecmp (property, "nicklist_bulk") == 0)
+    {
+        error = NULL;
+        number = strtol (value, &error, 10);
+        if (error && !error[0])
+        {
+            if (number)
+                gui_nicklist_bulk_start (buffer);
+            else
+                gui_nicklist_bulk_end (buffer);
+        }
+    }
+    else if (string_strcasecmp (property, "nickcmp_index") == 0)
+    {
+        error = NULL;
+        number = strtol (value, &error, 10);
+        if (error && !error[0])
+            buffer->nickcmp_index = (number) ? 1 : 0;
+    }
     else if (string_strcasecmp (property, "highlight_words") == 0)
     {
         gui_buffer_set_highlight_words (buffer, value);
@@ -2051,6 +2289,9 @@ gui_buffer_set_pointer (struct t_gui_buffer *buffer, const char *property,
     else if (string_strcasecmp (property, "nickcmp_callback") == 0)
     {
         buffer->nickcmp_callback = pointer;
+        buffer->nickcmp_index = 0;
+        /* keys of nicks in index depend on the callback */
+        gui_nicklist_index_build (buffer);
     }
     else if (string_strcasecmp (property, "nickcmp_callback_pointer") == 0)
     {
@@ -2194,6 +2435,18 @@ gui_buffer_search_by_full_name (const char *full_name)
         full_name += 4;
     }
 
+    /* use index if name is case sensitive and without duplicates */
+    if (case_sensitive)
+    {
+        if (gui_buffers_index_full_name_dirty)
+            gui_buffer_index_full_name_build ();
+        if (!gui_buffers_index_full_name_dirty
+            && (gui_buffers_index_full_name_dups == 0))
+        {
+            return hashtable_get (gui_buffers_index_full_name, full_name);
+        }
+    }
+
     for (ptr_buffer = gui_buffers; ptr_buffer;
          ptr_buffer = ptr_buffer->next_buffer)
     {
@@ -2219,7 +2472,8 @@ struct t_gui_buffer *
 gui_buffer_search_by_name (const char *plugin, const char *name)
 {
     struct t_gui_buffer *ptr_buffer;
-    int plugin_match, case_sensitive;
+    int plugin_match, case_sensitive, length;
+    char *full_name;
 
     if (!name || !name[0])
         return gui_current_window->buffer;
@@ -2234,6 +2488,27 @@ gui_buffer_search_by_name (const char *plugin, const char *name)
         name += 4;
     }
 
+    /* with plugin and case sensitive name: search by full name */
+    if (plugin && plugin[0] && case_sensitive)
+    {
+        length = strlen (plugin) + 1 + strlen (name) + 1;
+        full_name = malloc (length);
+        if (full_name)
+        {
+            snprintf (full_name, length, "%s.%s", plugin, name);
+            ptr_buffer = gui_buffer_search_by_full_name (full_name);
+            free (full_name);
+            /* a plugin name with a dot could match another buffer */
+            if (!ptr_buffer
+                || ((strcmp (plugin,
+                             gui_buffer_get_plugin_name (ptr_buffer)) == 0)
+                    && (strcmp (ptr_buffer->name, name) == 0)))
+            {
+                return ptr_buffer;
+            }
+        }
+    }
+
     for (ptr_buffer = gui_buffers; ptr_buffer;
          ptr_buffer = ptr_buffer->next_buffer)
     {
@@ -2361,6 +2636,11 @@ gui_buffer_search_by_number (int number)
 {
     struct t_gui_buffer *ptr_buffer;
 
+    if (gui_buffers_index_number_dirty)
+        gui_buffer_index_number_build ();
+    if (!gui_buffers_index_number_dirty)
+        return hashtable_get (gui_buffers_index_number, &number);
+
     for (ptr_buffer = gui_buffers; ptr_buffer;
          ptr_buffer = ptr_buffer->next_buffer)
     {
@@ -2691,12 +2971,13 @@ gui_buffer_close (struct t_gui_buffer *buffer)
         {
             ptr_buffer->number--;
         }
+        gui_buffer_index_number_invalidate ();
     }
 
     /* free all lines */
     gui_line_free_all (buffer);
     if (buffer->own_lines)
-        free (buffer->own_lines);
+        gui_lines_free (buffer->own_lines);
     if (buffer->mixed_lines)
         free (buffer->mixed_lines);
 
@@ -2718,7 +2999,10 @@ gui_buffer_close (struct t_gui_buffer *buffer)
     if (buffer->name)
         free (buffer->name);
     if (buffer->full_name)
+    {
+        gui_buffer_index_full_name_remove (buffer);
         free (buffer->full_name);
+    }
     if (buffer->short_name)
         free (buffer->short_name);
     if (buffer->title)
@@ -2745,6 +3029,12 @@ gui_buffer_close (struct t_gui_buffer *buffer)
     }
     if (buffer->highlight_tags_restrict)
         free (buffer->highlight_tags_restrict);
+    if (buffer->highlight_tags_restrict_compiled)
+    {
+        gui_line_tags_compiled_free (buffer->highlight_tags_restrict_count,
+                                     buffer->highlight_tags_restrict_array,
+                                     buffer->highlight_tags_restrict_compiled);
+    }
     if (buffer->highlight_tags_restrict_array)
     {
         for (i = 0; i < buffer->highlight_tags_restrict_count; i++)
@@ -2755,6 +3045,12 @@ gui_buffer_close (struct t_gui_buffer *buffer)
     }
     if (buffer->highlight_tags)
         free (buffer->highlight_tags);
+    if (buffer->highlight_tags_compiled)
+    {
+        gui_line_tags_compiled_free (buffer->highlight_tags_count,
+                                     buffer->highlight_tags_array,
+                                     buffer->highlight_tags_compiled);
+    }
     if (buffer->highlight_tags_array)
     {
         for (i = 0; i < buffer->highlight_tags_count; i++)
@@ -2780,6 +3076,11 @@ gui_buffer_close (struct t_gui_buffer *buffer)
     if (last_gui_buffer == buffer)
         last_gui_buffer = buffer->prev_buffer;
 
+    if (gui_buffers)
+        gui_buffer_index_number_invalidate ();
+    else
+        gui_buffer_index_free ();
+
     for (ptr_window = gui_windows; ptr_window;
          ptr_window = ptr_window->next_window)
     {
@@ -3055,6 +3356,7 @@ gui_buffer_renumber (int number1, int number2, int start_number)
             ptr_buffer2 = ptr_buffer;
             ptr_buffer = ptr_buffer->next_buffer;
         }
+        gui_buffer_index_number_invalidate ();
         if (ptr_buffer_moved)
         {
             (void) hook_signal_send ("buffer_moved",
@@ -3193,6 +3495,8 @@ gui_buffer_move_to_number (struct t_gui_buffer *buffer, int number)
         last_gui_buffer = ptr_last_buffer;
     }
 
+    gui_buffer_index_number_invalidate ();
+
     (void) hook_signal_send ("buffer_moved",
                              WEECHAT_HOOK_SIGNAL_POINTER, buffer);
 }
@@ -3284,6 +3588,8 @@ gui_buffer_swap (int number1, int number2)
             break;
     }
 
+    gui_buffer_index_number_invalidate ();
+
     /* send signals */
     (void) hook_signal_send ("buffer_moved",
                              WEECHAT_HOOK_SIGNAL_POINTER, ptr_first_buffer[0]);
@@ -3382,6 +3688,8 @@ gui_buffer_merge (struct t_gui_buffer *buffer,
             break;
     }
 
+    gui_buffer_index_number_invalidate ();
+
     /* mix lines */
     gui_line_mix_buffers (buffer);
 
@@ -3516,6 +3824,8 @@ gui_buffer_unmerge (struct t_gui_buffer *buffer, int number)
         gui_buffer_shift_numbers (buffer->next_buffer);
     }
 
+    gui_buffer_index_number_invalidate ();
+
     gui_buffer_compute_num_displayed ();
 
     if (ptr_new_active_buffer)
@@ -3677,6 +3987,10 @@ gui_buffer_sort_by_layout_number ()
         gui_buffer_insert (ptr_buffer);
         ptr_buffer = ptr_next_buffer;
     }
+
+    /* index may have been built while some buffers were not in list */
+    gui_buffers_index_full_name_dirty = 1;
+    gui_buffer_index_number_invalidate ();
 }
 
 /*
@@ -4106,9 +4420,14 @@ gui_buffer_hdata_buffer_cb (const void *pointer, void *data,
         HDATA_VAR(struct t_gui_buffer, nicklist_groups_count, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, nicklist_nicks_count, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, nicklist_visible_count, INTEGER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, nicklist_bulk, INTEGER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, nicklist_bulk_changes, INTEGER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, nicklist_nicks_index, HASHTABLE, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, nicklist_nicks_index_collisions, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, nickcmp_callback, POINTER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, nickcmp_callback_pointer, POINTER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, nickcmp_callback_data, POINTER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, nickcmp_index, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, input, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, input_callback, POINTER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, input_callback_pointer, POINTER, 0, NULL, NULL);
@@ -4303,6 +4622,8 @@ gui_buffer_add_to_infolist (struct t_infolist *infolist,
         return 0;
     if (!infolist_new_var_integer (ptr_item, "nicklist_visible_count", buffer->nicklist_visible_count))
         return 0;
+    if (!infolist_new_var_integer (ptr_item, "nicklist_bulk", buffer->nicklist_bulk))
+        return 0;
     if (!infolist_new_var_string (ptr_item, "title", buffer->title))
         return 0;
     if (!infolist_new_var_integer (ptr_item, "input", buffer->input))
@@ -4460,6 +4781,11 @@ gui_buffer_print_log ()
     log_printf ("gui_buffers . . . . . . . . . : 0x%lx", gui_buffers);
     log_printf ("last_gui_buffer . . . . . . . : 0x%lx", last_gui_buffer);
     log_printf ("gui_buffers_count . . . . . . : %d",    gui_buffers_count);
+    log_printf ("gui_buffers_index_full_name . : 0x%lx", gui_buffers_index_full_name);
+    log_printf ("gui_buffers_index_full_name_dirty: %d", gui_buffers_index_full_name_dirty);
+    log_printf ("gui_buffers_index_full_name_dups: %d",  gui_buffers_index_full_name_dups);
+    log_printf ("gui_buffers_index_number. . . : 0x%lx", gui_buffers_index_number);
+    log_printf ("gui_buffers_index_number_dirty: %d",    gui_buffers_index_number_dirty);
     log_printf ("gui_buffers_visited . . . . . : 0x%lx", gui_buffers_visited);
     log_printf ("last_gui_buffer_visited . . . : 0x%lx", last_gui_buffer_visited);
     log_printf ("gui_buffers_visited_index . . : %d",    gui_buffers_visited_index);
@@ -4512,9 +4838,14 @@ gui_buffer_print_log ()
         log_printf ("  nicklist_groups_count . : %d",    ptr_buffer->nicklist_groups_count);
         log_printf ("  nicklist_nicks_count. . : %d",    ptr_buffer->nicklist_nicks_count);
         log_printf ("  nicklist_visible_count. : %d",    ptr_buffer->nicklist_visible_count);
+        log_printf ("  nicklist_bulk . . . . . : %d",    ptr_buffer->nicklist_bulk);
+        log_printf ("  nicklist_bulk_changes . : %d",    ptr_buffer->nicklist_bulk_changes);
+        log_printf ("  nicklist_nicks_index. . : 0x%lx", ptr_buffer->nicklist_nicks_index);
+        log_printf ("  nicklist_nicks_index_collisions: %d", ptr_buffer->nicklist_nicks_index_collisions);
         log_printf ("  nickcmp_callback. . . . : 0x%lx", ptr_buffer->nickcmp_callback);
         log_printf ("  nickcmp_callback_pointer: 0x%lx", ptr_buffer->nickcmp_callback_pointer);
         log_printf ("  nickcmp_callback_data . : 0x%lx", ptr_buffer->nickcmp_callback_data);
+        log_printf ("  nickcmp_index . . . . . : %d",    ptr_buffer->nickcmp_index);
         log_printf ("  input . . . . . . . . . : %d",    ptr_buffer->input);
         log_printf ("  input_callback. . . . . : 0x%lx", ptr_buffer->input_callback);
         log_printf ("  input_callback_pointer. : 0x%lx", ptr_buffer->input_callback_pointer);
@@ -4558,9 +4889,11 @@ gui_buffer_print_log ()
         log_printf ("  highlight_tags_restrict. . . : '%s'",  ptr_buffer->highlight_tags_restrict);
         log_printf ("  highlight_tags_restrict_count: %d",    ptr_buffer->highlight_tags_restrict_count);
         log_printf ("  highlight_tags_restrict_array: 0x%lx", ptr_buffer->highlight_tags_restrict_array);
+        log_printf ("  highlight_tags_restrict_compiled: 0x%lx", ptr_buffer->highlight_tags_restrict_compiled);
         log_printf ("  highlight_tags. . . . . : '%s'",  ptr_buffer->highlight_tags);
         log_printf ("  highlight_tags_count. . : %d",    ptr_buffer->highlight_tags_count);
         log_printf ("  highlight_tags_array. . : 0x%lx", ptr_buffer->highlight_tags_array);
+        log_printf ("  highlight_tags_compiled : 0x%lx", ptr_buffer->highlight_tags_compiled);
         log_printf ("  keys. . . . . . . . . . : 0x%lx", ptr_buffer->keys);
         log_printf ("  last_key. . . . . . . . : 0x%lx", ptr_buffer->last_key);
         log_printf ("  keys_count. . . . . . . : %d",    ptr_buffer->keys_count);
@@ -4610,10 +4943,11 @@ gui_buffer_print_log ()
             num--;
             tags = string_build_with_split_string ((const char **)ptr_line->data->tags_array,
                                                    ",");
-            log_printf ("       line N-%05d: y:%d, str_time:'%s', tags:'%s', "
+            log_printf ("       line N-%05d: y:%d, date:%lld, tags:'%s', "
                         "displayed:%d, highlight:%d, refresh_needed:%d, "
                         "prefix:'%s'",
-                        num, ptr_line->data->y, ptr_line->data->str_time,
+                        num, ptr_line->data->y,
+                        (long long)(ptr_line->data->date),
                         (tags) ? tags  : "",
                         (int)(ptr_line->data->displayed),
                         (int)(ptr_line->data->highlight),
@@ -135,6 +135,11 @@ struct t_gui_buffer
     int nicklist_groups_count;         /* number of groups                  */
     int nicklist_nicks_count;          /* number of nicks                   */
     int nicklist_visible_count;        /* number of nicks/groups to display */
+    int nicklist_bulk;                 /* 1 if nicks are added in bulk:     */
+                                       /* not sorted, no signal sent        */
+    int nicklist_bulk_changes;         /* changes in nicklist (bulk mode)   */
+    struct t_hashtable *nicklist_nicks_index; /* nicks by name (index)      */
+    int nicklist_nicks_index_collisions; /* nicks with same key in index    */
     int (*nickcmp_callback)(const void *pointer, /* called to compare nicks */
                             void *data,          /* (search in nicklist)    */
                             struct t_gui_buffer *buffer,
@@ -142,6 +147,8 @@ struct t_gui_buffer
                             const char *nick2);
     const void *nickcmp_callback_pointer; /* pointer for callback           */
     void *nickcmp_callback_data;       /* data for callback                 */
+    int nickcmp_index;                 /* 1 if callback is compatible with  */
+                                       /* nicks index (no scan on miss)     */
 
     /* input */
     int input;                         /* = 1 if input is enabled           */
@@ -193,9 +200,11 @@ struct t_gui_buffer
     char *highlight_tags_restrict;     /* restrict highlight to these tags  */
     int highlight_tags_restrict_count; /* number of restricted tags         */
     char ***highlight_tags_restrict_array; /* array with restricted tags    */
+    const char ***highlight_tags_restrict_compiled; /* compiled tags        */
     char *highlight_tags;              /* force highlight on these tags     */
     int highlight_tags_count;          /* number of highlight tags          */
     char ***highlight_tags_array;      /* array with highlight tags         */
+    const char ***highlight_tags_compiled; /* compiled highlight tags       */
 
     /* hotlist settings for buffer */
     struct t_hashtable *hotlist_max_level_nicks; /* max hotlist level for   */
@@ -226,6 +235,11 @@ struct t_gui_buffer_visited
 extern struct t_gui_buffer *gui_buffers;
 extern struct t_gui_buffer *last_gui_buffer;
 extern int gui_buffers_count;
+extern struct t_hashtable *gui_buffers_index_full_name;
+extern int gui_buffers_index_full_name_dirty;
+extern int gui_buffers_index_full_name_dups;
+extern struct t_hashtable *gui_buffers_index_number;
+extern int gui_buffers_index_number_dirty;
 extern struct t_gui_buffer_visited *gui_buffers_visited;
 extern struct t_gui_buffer_visited *last_gui_buffer_visited;
 extern int gui_buffers_visited_index;
@@ -242,6 +256,12 @@ extern char *gui_buffer_properties_set[];
 
 extern const char *gui_buffer_get_plugin_name (struct t_gui_buffer *buffer);
 extern const char *gui_buffer_get_short_name (struct t_gui_buffer *buffer);
+extern void gui_buffer_index_full_name_build ();
+extern void gui_buffer_index_full_name_add (struct t_gui_buffer *buffer);
+extern void gui_buffer_index_full_name_remove (struct t_gui_buffer *buffer);
+extern void gui_buffer_index_number_build ();
+extern void gui_buffer_index_number_invalidate ();
+extern void gui_buffer_index_free ();
 extern void gui_buffer_build_full_name (struct t_gui_buffer *buffer);
 extern void gui_buffer_notify_set_all ();
 extern void gui_buffer_input_buffer_init (struct t_gui_buffer *buffer);
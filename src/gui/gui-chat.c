@@ -55,6 +55,10 @@ int gui_chat_time_length = 0;    /* length of time for each line (in chars) */
 int gui_chat_mute = GUI_CHAT_MUTE_DISABLED;     /* mute mode                */
 struct t_gui_buffer *gui_chat_mute_buffer = NULL; /* mute buffer            */
 int gui_chat_display_tags = 0;                  /* display tags?            */
+int gui_chat_layout_generation = 0;             /* changed to invalidate    */
+                                                /* layouts of lines         */
+struct t_gui_chat_time_cache gui_chat_time_cache[GUI_CHAT_TIME_CACHE_SIZE];
+                                                /* time strings of lines    */
 char *gui_chat_lines_waiting_buffer = NULL;     /* lines waiting for core   */
                                                 /* buffer                   */
 
@@ -81,6 +85,9 @@ gui_chat_init ()
         gui_chat_prefix[i] = strdup (str_prefix);
     }
 
+    /* init cache of time strings */
+    memset (gui_chat_time_cache, 0, sizeof (gui_chat_time_cache));
+
     /* some hsignals */
     hook_hsignal (NULL, "chat_quote_time_prefix_message",
                   &gui_chat_hsignal_quote_line_cb, NULL, NULL);
@@ -492,6 +499,38 @@ gui_chat_get_time_string (time_t date)
     return strdup (text_time2);
 }
 
+/*
+ * Gets time string of a line, for display (with colors).
+ *
+ * Time strings are not stored in lines: they are formatted when lines are
+ * displayed, and kept in a small cache (one entry per second, so that
+ * consecutive lines with same date are formatted only once).
+ *
+ * Note: result must NOT be freed, and is valid only until next call to this
+ * function.
+ */
+
+const char *
+gui_chat_get_time_string_cached (time_t date)
+{
+    struct t_gui_chat_time_cache *ptr_cache;
+
+    if (date == 0)
+        return NULL;
+
+    ptr_cache = &gui_chat_time_cache[(unsigned long)date
+                                     % GUI_CHAT_TIME_CACHE_SIZE];
+    if (ptr_cache->date != date)
+    {
+        if (ptr_cache->str_time)
+            free (ptr_cache->str_time);
+        ptr_cache->str_time = gui_chat_get_time_string (date);
+        ptr_cache->date = date;
+    }
+
+    return ptr_cache->str_time;
+}
+
 /*
  * Calculates time length with a time format (format can include color codes
  * with format ${name}).
@@ -522,28 +561,25 @@ gui_chat_get_time_length ()
 }
 
 /*
- * Changes time format for all lines of all buffers.
+ * Changes time format for all lines of all buffers: the cache of time strings
+ * is cleared, so that lines are displayed with the new format.
  */
 
 void
 gui_chat_change_time_format ()
 {
-    struct t_gui_buffer *ptr_buffer;
-    struct t_gui_line *ptr_line;
+    int i;
+
+    gui_chat_layout_generation++;
 
-    for (ptr_buffer = gui_buffers; ptr_buffer;
-         ptr_buffer = ptr_buffer->next_buffer)
+    for (i = 0; i < GUI_CHAT_TIME_CACHE_SIZE; i++)
     {
-        for (ptr_line = ptr_buffer->lines->first_line; ptr_line;
-             ptr_line = ptr_line->next_line)
+        if (gui_chat_time_cache[i].str_time)
         {
-            if (ptr_line->data->date != 0)
-            {
-                if (ptr_line->data->str_time)
-                    free (ptr_line->data->str_time);
-                ptr_line->data->str_time = gui_chat_get_time_string (ptr_line->data->date);
-            }
+            free (gui_chat_time_cache[i].str_time);
+            gui_chat_time_cache[i].str_time = NULL;
         }
+        gui_chat_time_cache[i].date = 0;
     }
 }
 
@@ -1100,6 +1136,9 @@ gui_chat_end ()
         }
     }
 
+    /* free cache of time strings */
+    gui_chat_change_time_format ();
+
     /* free lines waiting for buffer (should always be NULL here) */
     if (gui_chat_lines_waiting_buffer)
     {
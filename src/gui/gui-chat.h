@@ -36,6 +36,9 @@ struct t_gui_line;
 #define GUI_CHAT_PREFIX_JOIN_DEFAULT    "-->"
 #define GUI_CHAT_PREFIX_QUIT_DEFAULT    "<--"
 
+/* number of time strings in cache (one per second, see gui_chat_time_cache) */
+#define GUI_CHAT_TIME_CACHE_SIZE 64
+
 enum t_gui_chat_prefix
 {
     GUI_CHAT_PREFIX_ERROR = 0,
@@ -54,12 +57,20 @@ enum t_gui_chat_mute
     GUI_CHAT_MUTE_ALL_BUFFERS,
 };
 
+struct t_gui_chat_time_cache
+{
+    time_t date;                       /* date (0 if entry is not used)     */
+    char *str_time;                    /* time string (NULL if no time)     */
+};
+
 extern char *gui_chat_prefix[GUI_CHAT_NUM_PREFIXES];
 extern char gui_chat_prefix_empty[];
 extern int gui_chat_time_length;
 extern int gui_chat_mute;
 extern struct t_gui_buffer *gui_chat_mute_buffer;
 extern int gui_chat_display_tags;
+extern int gui_chat_layout_generation;
+extern struct t_gui_chat_time_cache gui_chat_time_cache[GUI_CHAT_TIME_CACHE_SIZE];
 
 /* chat functions */
 
@@ -79,6 +90,7 @@ extern void gui_chat_get_word_info (struct t_gui_window *window,
                                     int *word_length_with_spaces,
                                     int *word_length);
 extern char *gui_chat_get_time_string (time_t date);
+extern const char *gui_chat_get_time_string_cached (time_t date);
 extern int gui_chat_get_time_length ();
 extern void gui_chat_change_time_format ();
 extern char *gui_chat_build_string_prefix_message (struct t_gui_line *line);
@@ -102,6 +114,8 @@ extern const char *gui_chat_string_next_char (struct t_gui_window *window,
                                               int apply_style,
                                               int apply_style_inactive,
                                               int nick_offline);
+extern void gui_chat_layout_remove_line (struct t_gui_window *window,
+                                         struct t_gui_line *line);
 extern void gui_chat_draw (struct t_gui_buffer *buffer, int clear_chat);
 extern void gui_chat_draw_line (struct t_gui_buffer *buffer,
                                 struct t_gui_line *line);
@@ -48,6 +48,54 @@ struct t_gui_filter *last_gui_filter = NULL;       /* last filter           */
 int gui_filters_enabled = 1;                       /* filters enabled?      */
 
 
+/*
+ * Checks if a line is hidden by a filter (the filter must be enabled).
+ *
+ * Returns:
+ *   1: line is hidden by filter
+ *   0: line is not hidden by filter
+ */
+
+int
+gui_filter_match_line (struct t_gui_filter *filter,
+                       struct t_gui_line_data *line_data)
+{
+    int rc;
+
+    /* check buffer */
+    if (!gui_buffer_match_list_split (line_data->buffer,
+                                      filter->num_buffers,
+                                      filter->buffers))
+    {
+        return 0;
+    }
+
+    /* check tags */
+    if ((strcmp (filter->tags, "*") != 0)
+        && !gui_line_match_tags (line_data,
+                                 filter->tags_count,
+                                 filter->tags_array,
+                                 filter->tags_compiled))
+    {
+        return 0;
+    }
+
+    /* check line with regex */
+    rc = 1;
+    if (!filter->regex_prefix && !filter->regex_message)
+        rc = 0;
+    if (gui_line_match_regex (line_data,
+                              filter->regex_prefix,
+                              filter->regex_message))
+    {
+        rc = 0;
+    }
+    if (filter->regex && (filter->regex[0] == '!'))
+        rc ^= 1;
+
+    return (rc == 0) ? 1 : 0;
+}
+
 /*
  * Checks if a line must be displayed or not (filtered).
  *
@@ -60,7 +108,6 @@ int
 gui_filter_check_line (struct t_gui_line_data *line_data)
 {
     struct t_gui_filter *ptr_filter;
-    int rc;
 
     /* line is always displayed if filters are disabled (globally or in buffer) */
     if (!gui_filters_enabled || !line_data->buffer->filter)
@@ -72,34 +119,10 @@ gui_filter_check_line (struct t_gui_line_data *line_data)
     for (ptr_filter = gui_filters; ptr_filter;
          ptr_filter = ptr_filter->next_filter)
     {
-        if (ptr_filter->enabled)
+        if (ptr_filter->enabled
+            && gui_filter_match_line (ptr_filter, line_data))
         {
-            /* check buffer */
-            if (gui_buffer_match_list_split (line_data->buffer,
-                                             ptr_filter->num_buffers,
-                                             ptr_filter->buffers))
-            {
-                if ((strcmp (ptr_filter->tags, "*") == 0)
-                    || (gui_line_match_tags (line_data,
-                                             ptr_filter->tags_count,
-                                             ptr_filter->tags_array)))
-                {
-                    /* check line with regex */
-                    rc = 1;
-                    if (!ptr_filter->regex_prefix && !ptr_filter->regex_message)
-                        rc = 0;
-                    if (gui_line_match_regex (line_data,
-                                              ptr_filter->regex_prefix,
-                                              ptr_filter->regex_message))
-                    {
-                        rc = 0;
-                    }
-                    if (ptr_filter->regex && (ptr_filter->regex[0] == '!'))
-                        rc ^= 1;
-                    if (rc == 0)
-                        return 0;
-                }
-            }
+            return 0;
         }
     }
 
@@ -107,6 +130,50 @@ gui_filter_check_line (struct t_gui_line_data *line_data)
     return 1;
 }
 
+/*
+ * Applies changes after lines of a buffer have been filtered: sends signal
+ * "buffer_lines_hidden" if number of hidden lines has changed and refreshes
+ * windows displaying the buffer if some lines have changed.
+ */
+
+void
+gui_filter_buffer_apply (struct t_gui_buffer *buffer, int lines_changed,
+                         int lines_hidden)
+{
+    struct t_gui_window *ptr_window;
+
+    if (buffer->lines->lines_hidden != lines_hidden)
+    {
+        buffer->lines->lines_hidden = lines_hidden;
+        (void) hook_signal_send ("buffer_lines_hidden",
+                                 WEECHAT_HOOK_SIGNAL_POINTER, buffer);
+    }
+
+    if (lines_changed)
+    {
+        /* force a full refresh of buffer */
+        gui_buffer_ask_chat_refresh (buffer, 2);
+
+        /*
+         * check that a scroll in a window displaying this buffer is not on a
+         * hidden line (if this happens, use the previous displayed line as
+         * scroll)
+         */
+        for (ptr_window = gui_windows; ptr_window;
+             ptr_window = ptr_window->next_window)
+        {
+            if ((ptr_window->buffer == buffer)
+                && ptr_window->scroll->start_line
+                && !ptr_window->scroll->start_line->data->displayed)
+            {
+                ptr_window->scroll->start_line =
+                    gui_line_get_prev_displayed (ptr_window->scroll->start_line);
+                ptr_window->scroll->start_line_pos = 0;
+            }
+        }
+    }
+}
+
 /*
  * Filters a buffer, using message filters.
  *
@@ -120,7 +187,6 @@ gui_filter_buffer (struct t_gui_buffer *buffer,
 {
     struct t_gui_line *ptr_line;
     struct t_gui_line_data *ptr_line_data;
-    struct t_gui_window *ptr_window;
     int lines_changed, line_displayed, lines_hidden;
 
     lines_changed = 0;
@@ -152,51 +218,101 @@ gui_filter_buffer (struct t_gui_buffer *buffer,
     else
         buffer->lines->prefix_max_length_refresh = 1;
 
-    if (buffer->lines->lines_hidden != lines_hidden)
-    {
-        buffer->lines->lines_hidden = lines_hidden;
-        (void) hook_signal_send ("buffer_lines_hidden",
-                                 WEECHAT_HOOK_SIGNAL_POINTER, buffer);
-    }
+    gui_filter_buffer_apply (buffer, lines_changed, lines_hidden);
+}
 
-    if (lines_changed)
+/*
+ * Filters a buffer after a change in one filter (filter added, enabled,
+ * disabled or removed), checking only lines which can be changed by this
+ * filter:
+ *   - if the filter is enabled: only displayed lines are checked, with this
+ *     filter only (hidden lines remain hidden)
+ *   - if the filter is disabled: only hidden lines are checked, with all
+ *     enabled filters (displayed lines remain displayed).
+ */
+
+void
+gui_filter_buffer_filter_changed (struct t_gui_buffer *buffer,
+                                  struct t_gui_filter *filter)
+{
+    struct t_gui_line *ptr_line;
+    struct t_gui_line_data *ptr_line_data;
+    int lines_changed, line_displayed, lines_hidden;
+
+    /* no hidden line: disabling a filter can not change anything */
+    if (!filter->enabled && (buffer->lines->lines_hidden == 0))
+        return;
+
+    lines_changed = 0;
+    lines_hidden = buffer->lines->lines_hidden;
+
+    for (ptr_line = buffer->lines->first_line; ptr_line;
+         ptr_line = ptr_line->next_line)
     {
-        /* force a full refresh of buffer */
-        gui_buffer_ask_chat_refresh (buffer, 2);
+        ptr_line_data = ptr_line->data;
 
-        /*
-         * check that a scroll in a window displaying this buffer is not on a
-         * hidden line (if this happens, use the previous displayed line as
-         * scroll)
-         */
-        for (ptr_window = gui_windows; ptr_window;
-             ptr_window = ptr_window->next_window)
+        if (filter->enabled)
         {
-            if ((ptr_window->buffer == buffer)
-                && ptr_window->scroll->start_line
-                && !ptr_window->scroll->start_line->data->displayed)
+            if (!ptr_line_data->displayed
+                || !gui_filters_enabled
+                || !ptr_line_data->buffer->filter
+                || gui_line_has_tag_no_filter (ptr_line_data))
             {
-                ptr_window->scroll->start_line =
-                    gui_line_get_prev_displayed (ptr_window->scroll->start_line);
-                ptr_window->scroll->start_line_pos = 0;
+                continue;
             }
+            line_displayed = (gui_filter_match_line (filter, ptr_line_data)) ?
+                0 : 1;
+        }
+        else
+        {
+            if (ptr_line_data->displayed)
+                continue;
+            line_displayed = gui_filter_check_line (ptr_line_data);
+        }
+
+        if (ptr_line_data->displayed != line_displayed)
+        {
+            lines_changed = 1;
+            lines_hidden += (line_displayed) ? -1 : 1;
+            ptr_line_data->displayed = line_displayed;
         }
     }
+
+    if (lines_changed)
+        buffer->lines->prefix_max_length_refresh = 1;
+
+    gui_filter_buffer_apply (buffer, lines_changed, lines_hidden);
 }
 
 /*
  * Filters all buffers, using message filters.
+ *
+ * If filter is NULL, all lines of all buffers are filtered again.
+ * If filter is not NULL, only this filter has changed (added, enabled,
+ * disabled or about to be removed): only buffers matching the filter (or
+ * merged with other buffers) are filtered, and only lines which can be
+ * changed by this filter are checked.
  */
 
 void
-gui_filter_all_buffers ()
+gui_filter_all_buffers (struct t_gui_filter *filter)
 {
     struct t_gui_buffer *ptr_buffer;
 
     for (ptr_buffer = gui_buffers; ptr_buffer;
          ptr_buffer = ptr_buffer->next_buffer)
     {
-        gui_filter_buffer (ptr_buffer, NULL);
+        if (!filter)
+        {
+            gui_filter_buffer (ptr_buffer, NULL);
+        }
+        else if ((ptr_buffer->lines != ptr_buffer->own_lines)
+                 || gui_buffer_match_list_split (ptr_buffer,
+                                                 filter->num_buffers,
+                                                 filter->buffers))
+        {
+            gui_filter_buffer_filter_changed (ptr_buffer, filter);
+        }
     }
 }
 
@@ -210,7 +326,7 @@ gui_filter_global_enable ()
     if (!gui_filters_enabled)
     {
         gui_filters_enabled = 1;
-        gui_filter_all_buffers ();
+        gui_filter_all_buffers (NULL);
         (void) hook_signal_send ("filters_enabled",
                                  WEECHAT_HOOK_SIGNAL_STRING, NULL);
     }
@@ -226,7 +342,7 @@ gui_filter_global_disable ()
     if (gui_filters_enabled)
     {
         gui_filters_enabled = 0;
-        gui_filter_all_buffers ();
+        gui_filter_all_buffers (NULL);
         (void) hook_signal_send ("filters_disabled",
                                  WEECHAT_HOOK_SIGNAL_STRING, NULL);
     }
@@ -391,6 +507,7 @@ gui_filter_new (int enabled, const char *name, const char *buffer_name,
         new_filter->tags = (tags) ? strdup (tags) : NULL;
         new_filter->tags_count = 0;
         new_filter->tags_array = NULL;
+        new_filter->tags_compiled = NULL;
         if (new_filter->tags)
         {
             tags_array = string_split (new_filter->tags, ",", 0, 0,
@@ -407,6 +524,9 @@ gui_filter_new (int enabled, const char *name, const char *buffer_name,
                                                                   "+", 0, 0,
                                                                   NULL);
                     }
+                    new_filter->tags_compiled =
+                        gui_line_tags_compile (new_filter->tags_count,
+                                               new_filter->tags_array);
                 }
                 string_free_split (tags_array);
             }
@@ -479,6 +599,12 @@ gui_filter_free (struct t_gui_filter *filter)
         string_free_split (filter->buffers);
     if (filter->tags)
         free (filter->tags);
+    if (filter->tags_compiled)
+    {
+        gui_line_tags_compiled_free (filter->tags_count,
+                                     filter->tags_array,
+                                     filter->tags_compiled);
+    }
     if (filter->tags_array)
     {
         for (i = 0; i < filter->tags_count; i++)
@@ -38,6 +38,7 @@ struct t_gui_filter
     char *tags;                        /* tags                              */
     int tags_count;                    /* number of tags                    */
     char ***tags_array;                /* array of tags                     */
+    const char ***tags_compiled;       /* compiled tags (to match lines)    */
     char *regex;                       /* regex                             */
     regex_t *regex_prefix;             /* regex for line prefix             */
     regex_t *regex_message;            /* regex for line message            */
@@ -53,10 +54,14 @@ extern int gui_filters_enabled;
 
 /* filter functions */
 
+extern int gui_filter_match_line (struct t_gui_filter *filter,
+                                  struct t_gui_line_data *line_data);
 extern int gui_filter_check_line (struct t_gui_line_data *line_data);
 extern void gui_filter_buffer (struct t_gui_buffer *buffer,
                                struct t_gui_line_data *line_data);
-extern void gui_filter_all_buffers ();
+extern void gui_filter_buffer_filter_changed (struct t_gui_buffer *buffer,
+                                              struct t_gui_filter *filter);
+extern void gui_filter_all_buffers (struct t_gui_filter *filter);
 extern void gui_filter_global_enable ();
 extern void gui_filter_global_disable ();
 extern struct t_gui_filter *gui_filter_search_by_name (const char *name);
@@ -33,6 +33,7 @@
 #include "gui-bar.h"
 #include "gui-bar-window.h"
 #include "gui-buffer.h"
+#include "gui-chat.h"
 #include "gui-color.h"
 #include "gui-focus.h"
 #include "gui-line.h"
@@ -220,7 +221,9 @@ gui_focus_to_hashtable (struct t_gui_focus_info *focus_info, const char *key)
     str_prefix = NULL;
     if (focus_info->chat_line)
     {
-        str_time = gui_color_decode (((focus_info->chat_line)->data)->str_time, NULL);
+        str_time = gui_color_decode (
+            gui_chat_get_time_string_cached (((focus_info->chat_line)->data)->date),
+            NULL);
         str_prefix = gui_color_decode (((focus_info->chat_line)->data)->prefix, NULL);
         str_tags = string_build_with_split_string ((const char **)((focus_info->chat_line)->data)->tags_array, ",");
         str_message = gui_color_decode (((focus_info->chat_line)->data)->message, NULL);
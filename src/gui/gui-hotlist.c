@@ -45,6 +45,13 @@
 
 struct t_gui_hotlist *gui_hotlist = NULL;
 struct t_gui_hotlist *last_gui_hotlist = NULL;
+struct t_gui_hotlist *gui_hotlist_first_priority[GUI_HOTLIST_NUM_PRIORITIES] =
+{ NULL, NULL, NULL, NULL };            /* first hotlist by priority (when   */
+struct t_gui_hotlist *gui_hotlist_last_priority[GUI_HOTLIST_NUM_PRIORITIES] =
+{ NULL, NULL, NULL, NULL };            /* hotlist is sorted by group)       */
+struct t_hashtable *gui_hotlist_hashtable_buffers = NULL; /* buffer->hotlist*/
+int gui_hotlist_changed_pending = 0;   /* 1 if signal "hotlist_changed"     */
+                                       /* must be sent                      */
 struct t_gui_buffer *gui_hotlist_initial_buffer = NULL;
 struct t_hashtable *gui_hotlist_hashtable_add_conditions_pointers = NULL;
 struct t_hashtable *gui_hotlist_hashtable_add_conditions_vars = NULL;
@@ -55,16 +62,56 @@ int gui_add_hotlist = 1;                    /* 0 is for temporarily disable */
 
 
 /*
- * Sends signal "hotlist_changed".
+ * Asks to send signal "hotlist_changed": the signal is sent once by
+ * function gui_hotlist_changed_signal_flush (called in main loop), so that
+ * many changes in hotlist during the same main loop iteration trigger a
+ * single signal.
  */
 
 void
 gui_hotlist_changed_signal ()
 {
+    gui_hotlist_changed_pending = 1;
+}
+
+/*
+ * Sends signal "hotlist_changed" if hotlist has changed since last call.
+ */
+
+void
+gui_hotlist_changed_signal_flush ()
+{
+    if (!gui_hotlist_changed_pending)
+        return;
+
+    gui_hotlist_changed_pending = 0;
+
     (void) hook_signal_send ("hotlist_changed",
                              WEECHAT_HOOK_SIGNAL_STRING, NULL);
 }
 
+/*
+ * Checks if hotlist is sorted by priority first (groups of priorities).
+ *
+ * Returns:
+ *   1: hotlist is sorted by priority first
+ *   0: hotlist is sorted by buffer number only
+ */
+
+int
+gui_hotlist_sort_by_group ()
+{
+    switch (CONFIG_INTEGER(config_look_hotlist_sort))
+    {
+        case CONFIG_LOOK_HOTLIST_SORT_GROUP_TIME_ASC:
+        case CONFIG_LOOK_HOTLIST_SORT_GROUP_TIME_DESC:
+        case CONFIG_LOOK_HOTLIST_SORT_GROUP_NUMBER_ASC:
+        case CONFIG_LOOK_HOTLIST_SORT_GROUP_NUMBER_DESC:
+            return 1;
+    }
+    return 0;
+}
+
 /*
  * Searches for hotlist with buffer pointer.
  *
@@ -72,17 +119,12 @@ gui_hotlist_changed_signal ()
  */
 
 struct t_gui_hotlist *
-gui_hotlist_search (struct t_gui_hotlist *hotlist, struct t_gui_buffer *buffer)
+gui_hotlist_search (struct t_gui_buffer *buffer)
 {
-    struct t_gui_hotlist *ptr_hotlist;
+    if (!gui_hotlist_hashtable_buffers)
+        return NULL;
 
-    for (ptr_hotlist = hotlist; ptr_hotlist;
-         ptr_hotlist = ptr_hotlist->next_hotlist)
-    {
-        if (ptr_hotlist->buffer == buffer)
-            return ptr_hotlist;
-    }
-    return NULL;
+    return hashtable_get (gui_hotlist_hashtable_buffers, buffer);
 }
 
 /*
@@ -90,28 +132,45 @@ gui_hotlist_search (struct t_gui_hotlist *hotlist, struct t_gui_buffer *buffer)
  */
 
 void
-gui_hotlist_free (struct t_gui_hotlist **hotlist,
-                  struct t_gui_hotlist **last_hotlist,
-                  struct t_gui_hotlist *ptr_hotlist)
+gui_hotlist_free (struct t_gui_hotlist *ptr_hotlist)
 {
-    struct t_gui_hotlist *new_hotlist;
+    enum t_gui_hotlist_priority priority;
+
+    /* update first/last hotlist of priority */
+    priority = ptr_hotlist->priority;
+    if (gui_hotlist_first_priority[priority] == ptr_hotlist)
+    {
+        gui_hotlist_first_priority[priority] =
+            (ptr_hotlist->next_hotlist
+             && ((ptr_hotlist->next_hotlist)->priority == priority)) ?
+            ptr_hotlist->next_hotlist : NULL;
+    }
+    if (gui_hotlist_last_priority[priority] == ptr_hotlist)
+    {
+        gui_hotlist_last_priority[priority] =
+            (ptr_hotlist->prev_hotlist
+             && ((ptr_hotlist->prev_hotlist)->priority == priority)) ?
+            ptr_hotlist->prev_hotlist : NULL;
+    }
+
+    if (gui_hotlist_hashtable_buffers
+        && (hashtable_get (gui_hotlist_hashtable_buffers,
+                           ptr_hotlist->buffer) == ptr_hotlist))
+    {
+        hashtable_remove (gui_hotlist_hashtable_buffers, ptr_hotlist->buffer);
+    }
 
     /* remove hotlist from queue */
-    if (*last_hotlist == ptr_hotlist)
-        *last_hotlist = ptr_hotlist->prev_hotlist;
+    if (last_gui_hotlist == ptr_hotlist)
+        last_gui_hotlist = ptr_hotlist->prev_hotlist;
     if (ptr_hotlist->prev_hotlist)
-    {
         (ptr_hotlist->prev_hotlist)->next_hotlist = ptr_hotlist->next_hotlist;
-        new_hotlist = *hotlist;
-    }
     else
-        new_hotlist = ptr_hotlist->next_hotlist;
-
+        gui_hotlist = ptr_hotlist->next_hotlist;
     if (ptr_hotlist->next_hotlist)
         (ptr_hotlist->next_hotlist)->prev_hotlist = ptr_hotlist->prev_hotlist;
 
     free (ptr_hotlist);
-    *hotlist = new_hotlist;
 }
 
 /*
@@ -119,13 +178,12 @@ gui_hotlist_free (struct t_gui_hotlist **hotlist,
  */
 
 void
-gui_hotlist_free_all (struct t_gui_hotlist **hotlist,
-                      struct t_gui_hotlist **last_hotlist)
+gui_hotlist_free_all ()
 {
     /* remove all hotlists */
-    while (*hotlist)
+    while (gui_hotlist)
     {
-        gui_hotlist_free (hotlist, last_hotlist, *hotlist);
+        gui_hotlist_free (gui_hotlist);
     }
 }
 
@@ -161,61 +219,101 @@ gui_hotlist_check_buffer_notify (struct t_gui_buffer *buffer,
 }
 
 /*
- * Searches for position of hotlist (to keep hotlist sorted).
+ * Searches for position of hotlist in its group of priority (hotlist sorted
+ * by priority first).
+ *
+ * Hotlists with same priority are consecutive in list, so only the group
+ * of the priority is scanned; new hotlists (with current time) are added
+ * immediately at the beginning or the end of their group.
  */
 
 struct t_gui_hotlist *
-gui_hotlist_find_pos (struct t_gui_hotlist *hotlist,
-                      struct t_gui_hotlist *new_hotlist)
+gui_hotlist_find_pos_group (struct t_gui_hotlist *new_hotlist)
 {
-    struct t_gui_hotlist *ptr_hotlist;
+    struct t_gui_hotlist *ptr_first, *ptr_last, *ptr_hotlist;
+    int i;
+
+    ptr_first = gui_hotlist_first_priority[new_hotlist->priority];
+    ptr_last = gui_hotlist_last_priority[new_hotlist->priority];
+
+    if (!ptr_first)
+    {
+        /* no hotlist with this priority: add before lower priorities */
+        for (i = new_hotlist->priority - 1; i >= 0; i--)
+        {
+            if (gui_hotlist_first_priority[i])
+                return gui_hotlist_first_priority[i];
+        }
+        return NULL;
+    }
 
     switch (CONFIG_INTEGER(config_look_hotlist_sort))
     {
         case CONFIG_LOOK_HOTLIST_SORT_GROUP_TIME_ASC:
-            for (ptr_hotlist = hotlist; ptr_hotlist;
-                 ptr_hotlist = ptr_hotlist->next_hotlist)
+            for (ptr_hotlist = ptr_last; ptr_hotlist;
+                 ptr_hotlist = ptr_hotlist->prev_hotlist)
             {
-                if ((new_hotlist->priority > ptr_hotlist->priority)
-                    || ((new_hotlist->priority == ptr_hotlist->priority)
-                        && (util_timeval_diff (&(new_hotlist->creation_time),
-                                               &(ptr_hotlist->creation_time)) > 0)))
-                    return ptr_hotlist;
+                if (util_timeval_diff (&(new_hotlist->creation_time),
+                                       &(ptr_hotlist->creation_time)) <= 0)
+                    return ptr_hotlist->next_hotlist;
+                if (ptr_hotlist == ptr_first)
+                    break;
             }
-            break;
+            return ptr_first;
         case CONFIG_LOOK_HOTLIST_SORT_GROUP_TIME_DESC:
-            for (ptr_hotlist = hotlist; ptr_hotlist;
+            for (ptr_hotlist = ptr_first; ptr_hotlist;
                  ptr_hotlist = ptr_hotlist->next_hotlist)
             {
-                if ((new_hotlist->priority > ptr_hotlist->priority)
-                    || ((new_hotlist->priority == ptr_hotlist->priority)
-                        && (util_timeval_diff (&(new_hotlist->creation_time),
-                                               &(ptr_hotlist->creation_time)) < 0)))
+                if (util_timeval_diff (&(new_hotlist->creation_time),
+                                       &(ptr_hotlist->creation_time)) < 0)
                     return ptr_hotlist;
+                if (ptr_hotlist == ptr_last)
+                    break;
             }
-            break;
+            return ptr_last->next_hotlist;
         case CONFIG_LOOK_HOTLIST_SORT_GROUP_NUMBER_ASC:
-            for (ptr_hotlist = hotlist; ptr_hotlist;
+            for (ptr_hotlist = ptr_first; ptr_hotlist;
                  ptr_hotlist = ptr_hotlist->next_hotlist)
             {
-                if ((new_hotlist->priority > ptr_hotlist->priority)
-                    || ((new_hotlist->priority == ptr_hotlist->priority)
-                        && (new_hotlist->buffer->number < ptr_hotlist->buffer->number)))
+                if (new_hotlist->buffer->number < ptr_hotlist->buffer->number)
                     return ptr_hotlist;
+                if (ptr_hotlist == ptr_last)
+                    break;
             }
-            break;
+            return ptr_last->next_hotlist;
         case CONFIG_LOOK_HOTLIST_SORT_GROUP_NUMBER_DESC:
-            for (ptr_hotlist = hotlist; ptr_hotlist;
+            for (ptr_hotlist = ptr_first; ptr_hotlist;
                  ptr_hotlist = ptr_hotlist->next_hotlist)
             {
-                if ((new_hotlist->priority > ptr_hotlist->priority)
-                    || ((new_hotlist->priority == ptr_hotlist->priority)
-                        && (new_hotlist->buffer->number > ptr_hotlist->buffer->number)))
+                if (new_hotlist->buffer->number > ptr_hotlist->buffer->number)
                     return ptr_hotlist;
+                if (ptr_hotlist == ptr_last)
+                    break;
             }
-            break;
+            return ptr_last->next_hotlist;
+    }
+    return NULL;
+}
+
+/*
+ * Searches for position of hotlist (to keep hotlist sorted).
+ *
+ * Returns pointer to hotlist before which the new hotlist must be inserted,
+ * NULL if the new hotlist must be added at the end.
+ */
+
+struct t_gui_hotlist *
+gui_hotlist_find_pos (struct t_gui_hotlist *new_hotlist)
+{
+    struct t_gui_hotlist *ptr_hotlist;
+
+    if (gui_hotlist_sort_by_group ())
+        return gui_hotlist_find_pos_group (new_hotlist);
+
+    switch (CONFIG_INTEGER(config_look_hotlist_sort))
+    {
         case CONFIG_LOOK_HOTLIST_SORT_NUMBER_ASC:
-            for (ptr_hotlist = hotlist; ptr_hotlist;
+            for (ptr_hotlist = gui_hotlist; ptr_hotlist;
                  ptr_hotlist = ptr_hotlist->next_hotlist)
             {
                 if (new_hotlist->buffer->number < ptr_hotlist->buffer->number)
@@ -223,7 +321,7 @@ gui_hotlist_find_pos (struct t_gui_hotlist *hotlist,
             }
             break;
         case CONFIG_LOOK_HOTLIST_SORT_NUMBER_DESC:
-            for (ptr_hotlist = hotlist; ptr_hotlist;
+            for (ptr_hotlist = gui_hotlist; ptr_hotlist;
                  ptr_hotlist = ptr_hotlist->next_hotlist)
             {
                 if (new_hotlist->buffer->number > ptr_hotlist->buffer->number)
@@ -239,15 +337,14 @@ gui_hotlist_find_pos (struct t_gui_hotlist *hotlist,
  */
 
 void
-gui_hotlist_add_hotlist (struct t_gui_hotlist **hotlist,
-                         struct t_gui_hotlist **last_hotlist,
-                         struct t_gui_hotlist *new_hotlist)
+gui_hotlist_add_hotlist (struct t_gui_hotlist *new_hotlist)
 {
     struct t_gui_hotlist *pos_hotlist;
+    enum t_gui_hotlist_priority priority;
 
-    if (*hotlist)
+    if (gui_hotlist)
     {
-        pos_hotlist = gui_hotlist_find_pos (*hotlist, new_hotlist);
+        pos_hotlist = gui_hotlist_find_pos (new_hotlist);
 
         if (pos_hotlist)
         {
@@ -257,24 +354,55 @@ gui_hotlist_add_hotlist (struct t_gui_hotlist **hotlist,
             if (pos_hotlist->prev_hotlist)
                 (pos_hotlist->prev_hotlist)->next_hotlist = new_hotlist;
             else
-                *hotlist = new_hotlist;
+                gui_hotlist = new_hotlist;
             pos_hotlist->prev_hotlist = new_hotlist;
         }
         else
         {
             /* add hotlist to the end */
-            new_hotlist->prev_hotlist = *last_hotlist;
+            new_hotlist->prev_hotlist = last_gui_hotlist;
             new_hotlist->next_hotlist = NULL;
-            (*last_hotlist)->next_hotlist = new_hotlist;
-            *last_hotlist = new_hotlist;
+            last_gui_hotlist->next_hotlist = new_hotlist;
+            last_gui_hotlist = new_hotlist;
         }
     }
     else
     {
         new_hotlist->prev_hotlist = NULL;
         new_hotlist->next_hotlist = NULL;
-        *hotlist = new_hotlist;
-        *last_hotlist = new_hotlist;
+        gui_hotlist = new_hotlist;
+        last_gui_hotlist = new_hotlist;
+    }
+
+    /* update first/last hotlist of priority (if sorted by priority first) */
+    if (gui_hotlist_sort_by_group ())
+    {
+        priority = new_hotlist->priority;
+        if (!gui_hotlist_first_priority[priority]
+            || (new_hotlist->next_hotlist == gui_hotlist_first_priority[priority]))
+        {
+            gui_hotlist_first_priority[priority] = new_hotlist;
+        }
+        if (!gui_hotlist_last_priority[priority]
+            || (new_hotlist->prev_hotlist == gui_hotlist_last_priority[priority]))
+        {
+            gui_hotlist_last_priority[priority] = new_hotlist;
+        }
+    }
+
+    /* add hotlist in index of buffers */
+    if (!gui_hotlist_hashtable_buffers)
+    {
+        gui_hotlist_hashtable_buffers = hashtable_new (
+            32,
+            WEECHAT_HASHTABLE_POINTER,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL, NULL);
+    }
+    if (gui_hotlist_hashtable_buffers)
+    {
+        hashtable_set (gui_hotlist_hashtable_buffers,
+                       new_hotlist->buffer, new_hotlist);
     }
 }
 
@@ -370,7 +498,7 @@ gui_hotlist_add (struct t_gui_buffer *buffer,
         count[i] = 0;
     }
 
-    ptr_hotlist = gui_hotlist_search (gui_hotlist, buffer);
+    ptr_hotlist = gui_hotlist_search (buffer);
     if (ptr_hotlist)
     {
         /* return if priority is greater or equal than the one to add */
@@ -386,7 +514,7 @@ gui_hotlist_add (struct t_gui_buffer *buffer,
          * and go on
          */
         memcpy (count, ptr_hotlist->count, sizeof (ptr_hotlist->count));
-        gui_hotlist_free (&gui_hotlist, &last_gui_hotlist, ptr_hotlist);
+        gui_hotlist_free (ptr_hotlist);
     }
 
     new_hotlist = malloc (sizeof (*new_hotlist));
@@ -407,39 +535,13 @@ gui_hotlist_add (struct t_gui_buffer *buffer,
     new_hotlist->next_hotlist = NULL;
     new_hotlist->prev_hotlist = NULL;
 
-    gui_hotlist_add_hotlist (&gui_hotlist, &last_gui_hotlist, new_hotlist);
+    gui_hotlist_add_hotlist (new_hotlist);
 
     gui_hotlist_changed_signal ();
 
     return new_hotlist;
 }
 
-/*
- * Duplicates a hotlist element.
- *
- * Returns pointer to new hotlist, NULL if error.
- */
-
-struct t_gui_hotlist *
-gui_hotlist_dup (struct t_gui_hotlist *hotlist)
-{
-    struct t_gui_hotlist *new_hotlist;
-
-    new_hotlist = malloc (sizeof (*new_hotlist));
-    if (new_hotlist)
-    {
-        new_hotlist->priority = hotlist->priority;
-        memcpy (&(new_hotlist->creation_time), &(hotlist->creation_time),
-                sizeof (new_hotlist->creation_time));
-        new_hotlist->buffer = hotlist->buffer;
-        memcpy (new_hotlist->count, hotlist->count, sizeof (hotlist->count));
-        new_hotlist->prev_hotlist = NULL;
-        new_hotlist->next_hotlist = NULL;
-        return new_hotlist;
-    }
-    return NULL;
-}
-
 /*
  * Resorts hotlist with new sort type.
  */
@@ -447,23 +549,24 @@ gui_hotlist_dup (struct t_gui_hotlist *hotlist)
 void
 gui_hotlist_resort ()
 {
-    struct t_gui_hotlist *new_hotlist, *last_new_hotlist;
-    struct t_gui_hotlist *ptr_hotlist, *element;
+    struct t_gui_hotlist *ptr_hotlist, *next_hotlist;
+    int i;
 
-    /* copy and resort hotlist in new linked list */
-    new_hotlist = NULL;
-    last_new_hotlist = NULL;
-    for (ptr_hotlist = gui_hotlist; ptr_hotlist;
-         ptr_hotlist = ptr_hotlist->next_hotlist)
+    /* detach hotlists and add them again in list, with new sort */
+    ptr_hotlist = gui_hotlist;
+    gui_hotlist = NULL;
+    last_gui_hotlist = NULL;
+    for (i = 0; i < GUI_HOTLIST_NUM_PRIORITIES; i++)
     {
-        element = gui_hotlist_dup (ptr_hotlist);
-        gui_hotlist_add_hotlist (&new_hotlist, &last_new_hotlist, element);
+        gui_hotlist_first_priority[i] = NULL;
+        gui_hotlist_last_priority[i] = NULL;
+    }
+    while (ptr_hotlist)
+    {
+        next_hotlist = ptr_hotlist->next_hotlist;
+        gui_hotlist_add_hotlist (ptr_hotlist);
+        ptr_hotlist = next_hotlist;
     }
-
-    gui_hotlist_free_all (&gui_hotlist, &last_gui_hotlist);
-
-    gui_hotlist = new_hotlist;
-    last_gui_hotlist = last_new_hotlist;
 
     gui_hotlist_changed_signal ();
 }
@@ -475,7 +578,7 @@ gui_hotlist_resort ()
 void
 gui_hotlist_clear ()
 {
-    gui_hotlist_free_all (&gui_hotlist, &last_gui_hotlist);
+    gui_hotlist_free_all ();
     gui_hotlist_changed_signal ();
 }
 
@@ -497,6 +600,18 @@ gui_hotlist_remove_buffer (struct t_gui_buffer *buffer,
 
     hotlist_remove = CONFIG_INTEGER(config_look_hotlist_remove);
 
+    if (hotlist_remove == CONFIG_LOOK_HOTLIST_REMOVE_BUFFER)
+    {
+        /* only the hotlist of buffer can be removed: use index */
+        ptr_hotlist = gui_hotlist_search (buffer);
+        if (ptr_hotlist)
+        {
+            gui_hotlist_free (ptr_hotlist);
+            gui_hotlist_changed_signal ();
+        }
+        return;
+    }
+
     ptr_hotlist = gui_hotlist;
     while (ptr_hotlist)
     {
@@ -505,22 +620,15 @@ gui_hotlist_remove_buffer (struct t_gui_buffer *buffer,
         buffer_to_remove = (force_remove_buffer) ?
             (ptr_hotlist->buffer == buffer) : 0;
 
-        switch (hotlist_remove)
-        {
-            case CONFIG_LOOK_HOTLIST_REMOVE_BUFFER:
-                buffer_to_remove |= (ptr_hotlist->buffer == buffer);
-                break;
-            case CONFIG_LOOK_HOTLIST_REMOVE_MERGED:
-                buffer_to_remove |=
-                    ((ptr_hotlist->buffer->number == buffer->number)
-                     && (!ptr_hotlist->buffer->zoomed
-                         || (ptr_hotlist->buffer->active == 2)));
-                break;
-        }
+        /* hotlist_remove is "merged" here ("buffer" is handled above) */
+        buffer_to_remove |=
+            ((ptr_hotlist->buffer->number == buffer->number)
+             && (!ptr_hotlist->buffer->zoomed
+                 || (ptr_hotlist->buffer->active == 2)));
 
         if (buffer_to_remove)
         {
-            gui_hotlist_free (&gui_hotlist, &last_gui_hotlist, ptr_hotlist);
+            gui_hotlist_free (ptr_hotlist);
             hotlist_changed = 1;
         }
 
@@ -646,6 +754,19 @@ gui_hotlist_print_log ()
     struct t_gui_hotlist *ptr_hotlist;
     int i;
 
+    log_printf ("");
+    log_printf ("gui_hotlist. . . . . . . . . : 0x%lx", gui_hotlist);
+    log_printf ("last_gui_hotlist . . . . . . : 0x%lx", last_gui_hotlist);
+    for (i = 0; i < GUI_HOTLIST_NUM_PRIORITIES; i++)
+    {
+        log_printf ("gui_hotlist_first_priority[%d]: 0x%lx",
+                    i, gui_hotlist_first_priority[i]);
+        log_printf ("gui_hotlist_last_priority[%d]. : 0x%lx",
+                    i, gui_hotlist_last_priority[i]);
+    }
+    log_printf ("gui_hotlist_hashtable_buffers: 0x%lx", gui_hotlist_hashtable_buffers);
+    log_printf ("gui_hotlist_changed_pending. : %d",    gui_hotlist_changed_pending);
+
     for (ptr_hotlist = gui_hotlist; ptr_hotlist;
          ptr_hotlist = ptr_hotlist->next_hotlist)
     {
@@ -686,4 +807,9 @@ gui_hotlist_end ()
         hashtable_free (gui_hotlist_hashtable_add_conditions_options);
         gui_hotlist_hashtable_add_conditions_options = NULL;
     }
+    if (gui_hotlist_hashtable_buffers)
+    {
+        hashtable_free (gui_hotlist_hashtable_buffers);
+        gui_hotlist_hashtable_buffers = NULL;
+    }
 }
@@ -49,11 +49,18 @@ struct t_gui_hotlist
 
 extern struct t_gui_hotlist *gui_hotlist;
 extern struct t_gui_hotlist *last_gui_hotlist;
+extern struct t_gui_hotlist *gui_hotlist_first_priority[];
+extern struct t_gui_hotlist *gui_hotlist_last_priority[];
+extern struct t_hashtable *gui_hotlist_hashtable_buffers;
+extern int gui_hotlist_changed_pending;
 extern struct t_gui_buffer *gui_hotlist_initial_buffer;
 extern int gui_add_hotlist;
 
 /* hotlist functions */
 
+extern void gui_hotlist_changed_signal ();
+extern void gui_hotlist_changed_signal_flush ();
+extern struct t_gui_hotlist *gui_hotlist_search (struct t_gui_buffer *buffer);
 extern struct t_gui_hotlist *gui_hotlist_add (struct t_gui_buffer *buffer,
                                               enum t_gui_hotlist_priority priority,
                                               struct timeval *creation_time);
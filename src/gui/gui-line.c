@@ -35,6 +35,7 @@
 #include "../core/wee-hook.h"
 #include "../core/wee-infolist.h"
 #include "../core/wee-log.h"
+#include "../core/wee-slab.h"
 #include "../core/wee-string.h"
 #include "../plugins/plugin.h"
 #include "gui-line.h"
@@ -71,6 +72,7 @@ gui_lines_alloc ()
         new_lines->buffer_max_length_refresh = 0;
         new_lines->prefix_max_length = CONFIG_INTEGER(config_look_prefix_align_min);
         new_lines->prefix_max_length_refresh = 0;
+        new_lines->slab = NULL;
     }
 
     return new_lines;
@@ -83,9 +85,42 @@ gui_lines_alloc ()
 void
 gui_lines_free (struct t_gui_lines *lines)
 {
+    if (lines->slab)
+        slab_free (lines->slab);
     free (lines);
 }
 
+/*
+ * Allocates a new own line for a buffer: the line and its data are allocated
+ * in one item of the slab of own lines (content is not initialized, except
+ * the pointer to data).
+ *
+ * Returns pointer to new line, NULL if error.
+ */
+
+struct t_gui_line *
+gui_line_alloc_own (struct t_gui_buffer *buffer)
+{
+    struct t_gui_line_slab_item *new_item;
+
+    if (!buffer->own_lines->slab)
+    {
+        buffer->own_lines->slab = slab_new (sizeof (*new_item),
+                                            GUI_LINE_SLAB_CHUNK_MIN,
+                                            GUI_LINE_SLAB_CHUNK_MAX);
+        if (!buffer->own_lines->slab)
+            return NULL;
+    }
+
+    new_item = slab_alloc (buffer->own_lines->slab);
+    if (!new_item)
+        return NULL;
+
+    new_item->line.data = &new_item->data;
+
+    return &new_item->line;
+}
+
 /*
  * Allocates array with tags in a line_data.
  */
@@ -585,9 +620,108 @@ gui_line_has_tag_no_filter (struct t_gui_line_data *line_data)
     return 0;
 }
 
+/*
+ * Compiles tags (as split by filters, hooks print and highlight options) to
+ * match them faster against tags of lines.
+ *
+ * For each tag of "tags_array" (without the '!' for a negated tag), the
+ * compiled tag is the shared string with the tag in lower case, so that the
+ * tag is matched by comparing pointers with the lower case shared string of
+ * the line tag (see function string_shared_get_lower).
+ * Tags with a wildcard or non-ASCII chars are not compiled (NULL): they are
+ * matched with function string_match.
+ *
+ * Returns an array with same dimensions as "tags_array", NULL if error.
+ *
+ * Note: result must be freed after use with function
+ * gui_line_tags_compiled_free.
+ */
+
+const char ***
+gui_line_tags_compile (int tags_count, char ***tags_array)
+{
+    const char ***tags_compiled, *ptr_tag, *ptr_char;
+    char *tag_lower;
+    int i, j, count;
+
+    if (!tags_array || (tags_count <= 0))
+        return NULL;
+
+    tags_compiled = malloc (tags_count * sizeof (*tags_compiled));
+    if (!tags_compiled)
+        return NULL;
+
+    for (i = 0; i < tags_count; i++)
+    {
+        count = 0;
+        while (tags_array[i] && tags_array[i][count])
+        {
+            count++;
+        }
+        tags_compiled[i] = malloc ((count + 1) * sizeof (*tags_compiled[i]));
+        if (!tags_compiled[i])
+        {
+            gui_line_tags_compiled_free (i, tags_array, tags_compiled);
+            return NULL;
+        }
+        for (j = 0; j < count; j++)
+        {
+            tags_compiled[i][j] = NULL;
+            ptr_tag = tags_array[i][j];
+            if ((ptr_tag[0] == '!') && ptr_tag[1])
+                ptr_tag++;
+            for (ptr_char = ptr_tag;
+                 ptr_char[0] && !(ptr_char[0] & 0x80) && (ptr_char[0] != '*');
+                 ptr_char++)
+            {
+            }
+            if (ptr_char[0])
+                continue;
+            tag_lower = strdup (ptr_tag);
+            if (tag_lower)
+            {
+                string_tolower (tag_lower);
+                tags_compiled[i][j] = string_shared_get (tag_lower);
+                free (tag_lower);
+            }
+        }
+        tags_compiled[i][count] = NULL;
+    }
+
+    return tags_compiled;
+}
+
+/*
+ * Frees tags compiled by function gui_line_tags_compile.
+ */
+
+void
+gui_line_tags_compiled_free (int tags_count, char ***tags_array,
+                             const char ***tags_compiled)
+{
+    int i, j;
+
+    if (!tags_compiled)
+        return;
+
+    for (i = 0; i < tags_count; i++)
+    {
+        for (j = 0; tags_array[i] && tags_array[i][j]; j++)
+        {
+            if (tags_compiled[i][j])
+                string_shared_free (tags_compiled[i][j]);
+        }
+        free (tags_compiled[i]);
+    }
+    free (tags_compiled);
+}
+
 /*
  * Checks if line matches tags.
  *
+ * Argument "tags_compiled" is the result of function gui_line_tags_compile
+ * for "tags_array", or NULL (then all tags are matched with string_match).
+ *
  * Returns:
  *   1: line matches tags
  *   0: line does not match tags
@@ -595,7 +729,8 @@ gui_line_has_tag_no_filter (struct t_gui_line_data *line_data)
 
 int
 gui_line_match_tags (struct t_gui_line_data *line_data,
-                     int tags_count, char ***tags_array)
+                     int tags_count, char ***tags_array,
+                     const char ***tags_compiled)
 {
     int i, j, k, match, tag_found, tag_negated;
 
@@ -617,14 +752,28 @@ gui_line_match_tags (struct t_gui_line_data *line_data,
             if ((tags_array[i][j][0] == '!') && tags_array[i][j][1])
                 tag_negated = 1;
 
-            for (k = 0; k < line_data->tags_count; k++)
+            if (tags_compiled && tags_compiled[i][j])
+            {
+                for (k = 0; k < line_data->tags_count; k++)
+                {
+                    if (string_shared_get_lower (line_data->tags_array[k]) == tags_compiled[i][j])
+                    {
+                        tag_found = 1;
+                        break;
+                    }
+                }
+            }
+            else
             {
-                if (string_match (line_data->tags_array[k],
-                                  (tag_negated) ? tags_array[i][j] + 1 : tags_array[i][j],
-                                  0))
+                for (k = 0; k < line_data->tags_count; k++)
                 {
-                    tag_found = 1;
-                    break;
+                    if (string_match (line_data->tags_array[k],
+                                      (tag_negated) ? tags_array[i][j] + 1 : tags_array[i][j],
+                                      0))
+                    {
+                        tag_found = 1;
+                        break;
+                    }
                 }
             }
             if ((!tag_found && !tag_negated) || (tag_found && tag_negated))
@@ -738,7 +887,8 @@ gui_line_has_highlight (struct t_gui_line *line)
     if (config_highlight_tags
         && gui_line_match_tags (line->data,
                                 config_num_highlight_tags,
-                                config_highlight_tags))
+                                config_highlight_tags,
+                                config_highlight_tags_compiled))
     {
         return 1;
     }
@@ -750,7 +900,8 @@ gui_line_has_highlight (struct t_gui_line *line)
     if (line->data->buffer->highlight_tags
         && gui_line_match_tags (line->data,
                                 line->data->buffer->highlight_tags_count,
-                                line->data->buffer->highlight_tags_array))
+                                line->data->buffer->highlight_tags_array,
+                                line->data->buffer->highlight_tags_compiled))
     {
         return 1;
     }
@@ -763,7 +914,8 @@ gui_line_has_highlight (struct t_gui_line *line)
     {
         if (!gui_line_match_tags (line->data,
                                   line->data->buffer->highlight_tags_restrict_count,
-                                  line->data->buffer->highlight_tags_restrict_array))
+                                  line->data->buffer->highlight_tags_restrict_array,
+                                  line->data->buffer->highlight_tags_restrict_compiled))
             return 0;
     }
 
@@ -996,6 +1148,8 @@ gui_line_remove_from_list (struct t_gui_buffer *buffer,
         }
         /* remove line from coords */
         gui_window_coords_remove_line (ptr_win, line);
+        /* remove layout of line from cache */
+        gui_chat_layout_remove_line (ptr_win, line);
     }
 
     gui_line_get_prefix_for_display (line, NULL, &prefix_length, NULL,
@@ -1020,14 +1174,11 @@ gui_line_remove_from_list (struct t_gui_buffer *buffer,
     /* free data */
     if (free_data)
     {
-        if (line->data->str_time)
-            free (line->data->str_time);
         gui_line_tags_free (line->data);
         if (line->data->prefix)
             string_shared_free (line->data->prefix);
         if (line->data->message)
             free (line->data->message);
-        free (line->data);
     }
 
     /* remove line from list */
@@ -1042,7 +1193,11 @@ gui_line_remove_from_list (struct t_gui_buffer *buffer,
 
     lines->lines_count--;
 
-    free (line);
+    /* own line and its data are in the slab, a mixed line is allocated alone */
+    if (free_data)
+        slab_release (lines->slab, line);
+    else
+        free (line);
 }
 
 /*
@@ -1190,7 +1345,6 @@ gui_line_add (struct t_gui_buffer *buffer, time_t date,
               const char *prefix, const char *message)
 {
     struct t_gui_line *new_line;
-    struct t_gui_line_data *new_line_data;
     struct t_gui_window *ptr_win;
     char *message_for_signal;
     const char *nick;
@@ -1216,30 +1370,19 @@ gui_line_add (struct t_gui_buffer *buffer, time_t date,
         lines_removed++;
     }
 
-    /* create new line */
-    new_line = malloc (sizeof (*new_line));
+    /* create new line (with its data) */
+    new_line = gui_line_alloc_own (buffer);
     if (!new_line)
     {
         log_printf (_("Not enough memory for new line"));
         return NULL;
     }
 
-    /* create data for line */
-    new_line_data = malloc (sizeof (*new_line_data));
-    if (!new_line_data)
-    {
-        free (new_line);
-        log_printf (_("Not enough memory for new line"));
-        return NULL;
-    }
-    new_line->data = new_line_data;
-
     /* fill data in new line */
     new_line->data->buffer = buffer;
     new_line->data->y = -1;
     new_line->data->date = date;
     new_line->data->date_printed = date_printed;
-    new_line->data->str_time = gui_chat_get_time_string (date);
     gui_line_tags_alloc (new_line->data, tags);
     new_line->data->refresh_needed = 0;
     new_line->data->prefix = (prefix) ?
@@ -1350,7 +1493,6 @@ void
 gui_line_add_y (struct t_gui_buffer *buffer, int y, const char *message)
 {
     struct t_gui_line *ptr_line, *new_line;
-    struct t_gui_line_data *new_line_data;
     struct t_gui_window *ptr_win;
 
     /* search if line exists for "y" */
@@ -1363,22 +1505,13 @@ gui_line_add_y (struct t_gui_buffer *buffer, int y, const char *message)
 
     if (!ptr_line || (ptr_line->data->y > y))
     {
-        new_line = malloc (sizeof (*new_line));
+        new_line = gui_line_alloc_own (buffer);
         if (!new_line)
         {
             log_printf (_("Not enough memory for new line"));
             return;
         }
 
-        new_line_data = malloc (sizeof (*new_line_data));
-        if (!new_line_data)
-        {
-            free (new_line);
-            log_printf (_("Not enough memory for new line"));
-            return;
-        }
-        new_line->data = new_line_data;
-
         buffer->own_lines->lines_count++;
 
         /* fill data in new line */
@@ -1386,7 +1519,6 @@ gui_line_add_y (struct t_gui_buffer *buffer, int y, const char *message)
         new_line->data->y = y;
         new_line->data->date = 0;
         new_line->data->date_printed = 0;
-        new_line->data->str_time = NULL;
         new_line->data->tags_count = 0;
         new_line->data->tags_array = NULL;
         new_line->data->refresh_needed = 1;
@@ -1425,10 +1557,11 @@ gui_line_add_y (struct t_gui_buffer *buffer, int y, const char *message)
     /* set message for line */
     if (ptr_line->data->message)
     {
-        /* remove line from coords if the content is changing */
+        /* remove line from coords and layouts if the content is changing */
         for (ptr_win = gui_windows; ptr_win; ptr_win = ptr_win->next_window)
         {
             gui_window_coords_remove_line (ptr_win, ptr_line);
+            gui_chat_layout_remove_line (ptr_win, ptr_line);
         }
 
         /* free message in line */
@@ -1642,9 +1775,6 @@ gui_line_hdata_line_data_update_cb (void *data,
         if (value)
         {
             hdata_set (hdata, pointer, "date", value);
-            if (line_data->str_time)
-                free (line_data->str_time);
-            line_data->str_time = gui_chat_get_time_string (line_data->date);
             rc++;
             update_coords = 1;
         }
@@ -1695,6 +1825,7 @@ gui_line_hdata_line_data_update_cb (void *data,
             {
                 gui_window_coords_remove_line_data (ptr_win, line_data);
             }
+            gui_chat_layout_generation++;
         }
         gui_filter_buffer (line_data->buffer, line_data);
         gui_buffer_ask_chat_refresh (line_data->buffer, 1);
@@ -1725,7 +1856,6 @@ gui_line_hdata_line_data_cb (const void *pointer, void *data,
         HDATA_VAR(struct t_gui_line_data, y, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_line_data, date, TIME, 1, NULL, NULL);
         HDATA_VAR(struct t_gui_line_data, date_printed, TIME, 1, NULL, NULL);
-        HDATA_VAR(struct t_gui_line_data, str_time, STRING, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_line_data, tags_count, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_line_data, tags_array, SHARED_STRING, 1, "tags_count", NULL);
         HDATA_VAR(struct t_gui_line_data, displayed, CHAR, 0, NULL, NULL);
@@ -1768,7 +1898,8 @@ gui_line_add_to_infolist (struct t_infolist *infolist,
         return 0;
     if (!infolist_new_var_time (ptr_item, "date_printed", line->data->date_printed))
         return 0;
-    if (!infolist_new_var_string (ptr_item, "str_time", line->data->str_time))
+    if (!infolist_new_var_string (ptr_item, "str_time",
+                                  gui_chat_get_time_string_cached (line->data->date)))
         return 0;
 
     /* write tags */
@@ -1834,5 +1965,6 @@ gui_lines_print_log (struct t_gui_lines *lines)
         log_printf ("    buffer_max_length_refresh: %d",    lines->buffer_max_length_refresh);
         log_printf ("    prefix_max_length. . . . : %d",    lines->prefix_max_length);
         log_printf ("    prefix_max_length_refresh: %d",    lines->prefix_max_length_refresh);
+        log_printf ("    slab . . . . . . . . . . : 0x%lx", lines->slab);
     }
 }
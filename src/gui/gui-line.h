@@ -23,6 +23,12 @@
 #include <regex.h>
 
 struct t_infolist;
+struct t_slab;
+
+/* number of lines allocated in each chunk of slab (for own lines) */
+
+#define GUI_LINE_SLAB_CHUNK_MIN 16
+#define GUI_LINE_SLAB_CHUNK_MAX 1024
 
 /* line structures */
 
@@ -32,7 +38,6 @@ struct t_gui_line_data
     int y;                             /* line position (for free buffer)   */
     time_t date;                       /* date/time of line (may be past)   */
     time_t date_printed;               /* date/time when weechat print it   */
-    char *str_time;                    /* time string (for display)         */
     int tags_count;                    /* number of tags for line           */
     char **tags_array;                 /* tags for line                     */
     char displayed;                    /* 1 if line is displayed            */
@@ -50,6 +55,12 @@ struct t_gui_line
     struct t_gui_line *next_line;      /* link to next line                 */
 };
 
+struct t_gui_line_slab_item
+{
+    struct t_gui_line line;            /* own line of a buffer...           */
+    struct t_gui_line_data data;       /* ...with its data (same item)      */
+};
+
 struct t_gui_lines
 {
     struct t_gui_line *first_line;     /* pointer to first line             */
@@ -63,12 +74,15 @@ struct t_gui_lines
     int buffer_max_length_refresh;     /* refresh asked for buffer max len. */
     int prefix_max_length;             /* max length for prefix align       */
     int prefix_max_length_refresh;     /* refresh asked for prefix max len. */
+    struct t_slab *slab;               /* own lines with data (NULL for     */
+                                       /* mixed lines)                      */
 };
 
 /* line functions */
 
 extern struct t_gui_lines *gui_lines_alloc ();
 extern void gui_lines_free (struct t_gui_lines *lines);
+extern struct t_gui_line *gui_line_alloc_own (struct t_gui_buffer *buffer);
 extern void gui_line_get_prefix_for_display (struct t_gui_line *line,
                                              char **prefix, int *length,
                                              char **color, int *prefix_is_nick);
@@ -86,8 +100,13 @@ extern int gui_line_match_regex (struct t_gui_line_data *line_data,
                                  regex_t *regex_prefix,
                                  regex_t *regex_message);
 extern int gui_line_has_tag_no_filter (struct t_gui_line_data *line_data);
+extern const char ***gui_line_tags_compile (int tags_count,
+                                            char ***tags_array);
+extern void gui_line_tags_compiled_free (int tags_count, char ***tags_array,
+                                         const char ***tags_compiled);
 extern int gui_line_match_tags (struct t_gui_line_data *line_data,
-                                int tags_count, char ***tags_array);
+                                int tags_count, char ***tags_array,
+                                const char ***tags_compiled);
 extern const char *gui_line_search_tag_starting_with (struct t_gui_line *line,
                                                       const char *tag);
 extern const char *gui_line_get_nick_tag (struct t_gui_line *line);
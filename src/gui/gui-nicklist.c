@@ -34,6 +34,7 @@
 #include <ctype.h>
 
 #include "../core/weechat.h"
+#include "../core/wee-arraylist.h"
 #include "../core/wee-config.h"
 #include "../core/wee-hashtable.h"
 #include "../core/wee-hdata.h"
@@ -53,6 +54,9 @@ struct t_hashtable *gui_nicklist_hsignal = NULL;
 
 /*
  * Sends a signal when something has changed in nicklist.
+ *
+ * If the buffer is in bulk mode, the signal is not sent (a single signal
+ * "nicklist_changed" is sent at the end of bulk mode).
  */
 
 void
@@ -62,6 +66,12 @@ gui_nicklist_send_signal (const char *signal, struct t_gui_buffer *buffer,
     char *str_args;
     int length;
 
+    if (buffer && buffer->nicklist_bulk)
+    {
+        buffer->nicklist_bulk_changes++;
+        return;
+    }
+
     if (buffer)
     {
         length = 128 + ((arguments) ? strlen (arguments) : 0) + 1 + 1;
@@ -86,6 +96,10 @@ gui_nicklist_send_signal (const char *signal, struct t_gui_buffer *buffer,
 
 /*
  * Sends a hsignal when something will change or has changed in nicklist.
+ *
+ * If group and nick are both NULL, only the buffer is sent in hashtable.
+ *
+ * If the buffer is in bulk mode, the hsignal is not sent.
  */
 
 void
@@ -93,6 +107,12 @@ gui_nicklist_send_hsignal (const char *signal, struct t_gui_buffer *buffer,
                            struct t_gui_nick_group *group,
                            struct t_gui_nick *nick)
 {
+    if (buffer && buffer->nicklist_bulk)
+    {
+        buffer->nicklist_bulk_changes++;
+        return;
+    }
+
     if (!gui_nicklist_hsignal)
     {
         gui_nicklist_hsignal = hashtable_new (32,
@@ -107,8 +127,11 @@ gui_nicklist_send_hsignal (const char *signal, struct t_gui_buffer *buffer,
     hashtable_remove_all (gui_nicklist_hsignal);
 
     hashtable_set (gui_nicklist_hsignal, "buffer", buffer);
-    hashtable_set (gui_nicklist_hsignal, "parent_group",
-                   (group) ? group->parent : nick->group);
+    if (group || nick)
+    {
+        hashtable_set (gui_nicklist_hsignal, "parent_group",
+                       (group) ? group->parent : nick->group);
+    }
     if (group)
         hashtable_set (gui_nicklist_hsignal, "group", group);
     if (nick)
@@ -117,6 +140,309 @@ gui_nicklist_send_hsignal (const char *signal, struct t_gui_buffer *buffer,
     (void) hook_hsignal_send (signal, gui_nicklist_hsignal);
 }
 
+/*
+ * Returns key of a nick in the nicks index of buffer.
+ *
+ * Without nick comparison callback in buffer, the key is the nick name.
+ * With a callback, some chars are converted to lower case (see
+ * GUI_NICKLIST_INDEX_CASE_RANGE); if the buffer property "nickcmp_index" is
+ * not set, nicks equal for the callback may have different keys, so a nick
+ * not found in index is then searched in all nicks.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+gui_nicklist_index_key (struct t_gui_buffer *buffer, const char *name)
+{
+    char *key, *ptr_key;
+
+    key = strdup (name);
+    if (!key)
+        return NULL;
+
+    if (buffer->nickcmp_callback)
+    {
+        for (ptr_key = key; ptr_key[0]; ptr_key++)
+        {
+            if ((ptr_key[0] >= 'A')
+                && (ptr_key[0] < 'A' + GUI_NICKLIST_INDEX_CASE_RANGE))
+            {
+                ptr_key[0] += ('a' - 'A');
+            }
+        }
+    }
+
+    return key;
+}
+
+/*
+ * Compares two nicks of a buffer (with the nick comparison callback of
+ * buffer, if set).
+ *
+ * Returns:
+ *   < 0: name of nick < name
+ *     0: name of nick == name
+ *   > 0: name of nick > name
+ */
+
+int
+gui_nicklist_nickcmp (struct t_gui_buffer *buffer, struct t_gui_nick *nick,
+                      const char *name)
+{
+    if (buffer->nickcmp_callback)
+    {
+        return (buffer->nickcmp_callback) (buffer->nickcmp_callback_pointer,
+                                           buffer->nickcmp_callback_data,
+                                           buffer,
+                                           nick->name,
+                                           name);
+    }
+
+    return strcmp (nick->name, name);
+}
+
+/*
+ * Adds a nick in the nicks index of buffer.
+ *
+ * If another nick has already the same key, the nick is not added in the
+ * hashtable and the number of collisions is incremented (the search of a nick
+ * with this key will then be done in all nicks).
+ */
+
+void
+gui_nicklist_index_add_nick (struct t_gui_buffer *buffer,
+                             struct t_gui_nick *nick)
+{
+    char *key;
+
+    if (!buffer->nicklist_nicks_index)
+    {
+        buffer->nicklist_nicks_index = hashtable_new (
+            32,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL, NULL);
+        if (!buffer->nicklist_nicks_index)
+            return;
+    }
+
+    key = gui_nicklist_index_key (buffer, nick->name);
+    if (!key)
+        return;
+
+    if (hashtable_has_key (buffer->nicklist_nicks_index, key))
+        buffer->nicklist_nicks_index_collisions++;
+    else
+        hashtable_set (buffer->nicklist_nicks_index, key, nick);
+
+    free (key);
+}
+
+/*
+ * Searches for a nick in a group and its children which has a given key in
+ * nicks index (nick "except_nick" is ignored).
+ *
+ * Returns pointer to nick found, NULL if not found.
+ */
+
+struct t_gui_nick *
+gui_nicklist_index_search_key (struct t_gui_buffer *buffer,
+                               struct t_gui_nick_group *group,
+                               const char *key,
+                               struct t_gui_nick *except_nick)
+{
+    struct t_gui_nick_group *ptr_group;
+    struct t_gui_nick *ptr_nick;
+    char *nick_key;
+    int same_key;
+
+    for (ptr_nick = group->nicks; ptr_nick; ptr_nick = ptr_nick->next_nick)
+    {
+        if (ptr_nick == except_nick)
+            continue;
+        nick_key = gui_nicklist_index_key (buffer, ptr_nick->name);
+        if (nick_key)
+        {
+            same_key = (strcmp (nick_key, key) == 0);
+            free (nick_key);
+            if (same_key)
+                return ptr_nick;
+        }
+    }
+
+    for (ptr_group = group->children; ptr_group;
+         ptr_group = ptr_group->next_group)
+    {
+        ptr_nick = gui_nicklist_index_search_key (buffer, ptr_group, key,
+                                                  except_nick);
+        if (ptr_nick)
+            return ptr_nick;
+    }
+
+    return NULL;
+}
+
+/*
+ * Removes a nick from the nicks index of buffer.
+ */
+
+void
+gui_nicklist_index_remove_nick (struct t_gui_buffer *buffer,
+                                struct t_gui_nick *nick)
+{
+    struct t_gui_nick *ptr_nick;
+    char *key;
+
+    if (!buffer->nicklist_nicks_index)
+        return;
+
+    key = gui_nicklist_index_key (buffer, nick->name);
+    if (!key)
+        return;
+
+    if (hashtable_get (buffer->nicklist_nicks_index, key) == nick)
+    {
+        hashtable_remove (buffer->nicklist_nicks_index, key);
+        if ((buffer->nicklist_nicks_index_collisions > 0)
+            && buffer->nicklist_root)
+        {
+            /* another nick with same key takes its place in hashtable */
+            ptr_nick = gui_nicklist_index_search_key (buffer,
+                                                      buffer->nicklist_root,
+                                                      key, nick);
+            if (ptr_nick)
+            {
+                hashtable_set (buffer->nicklist_nicks_index, key, ptr_nick);
+                buffer->nicklist_nicks_index_collisions--;
+            }
+        }
+    }
+    else if (buffer->nicklist_nicks_index_collisions > 0)
+    {
+        buffer->nicklist_nicks_index_collisions--;
+    }
+
+    free (key);
+}
+
+/*
+ * Adds all nicks of a group and its children in the nicks index of buffer.
+ */
+
+void
+gui_nicklist_index_add_group (struct t_gui_buffer *buffer,
+                              struct t_gui_nick_group *group)
+{
+    struct t_gui_nick_group *ptr_group;
+    struct t_gui_nick *ptr_nick;
+
+    for (ptr_nick = group->nicks; ptr_nick; ptr_nick = ptr_nick->next_nick)
+    {
+        gui_nicklist_index_add_nick (buffer, ptr_nick);
+    }
+
+    for (ptr_group = group->children; ptr_group;
+         ptr_group = ptr_group->next_group)
+    {
+        gui_nicklist_index_add_group (buffer, ptr_group);
+    }
+}
+
+/*
+ * Builds the nicks index of buffer (this must be done when the keys change,
+ * ie when the nick comparison callback is changed in buffer).
+ */
+
+void
+gui_nicklist_index_build (struct t_gui_buffer *buffer)
+{
+    if (!buffer)
+        return;
+
+    if (buffer->nicklist_nicks_index)
+        hashtable_remove_all (buffer->nicklist_nicks_index);
+    buffer->nicklist_nicks_index_collisions = 0;
+
+    if (buffer->nicklist_root)
+        gui_nicklist_index_add_group (buffer, buffer->nicklist_root);
+}
+
+/*
+ * Compares two nicks in the sorted index of a group.
+ */
+
+int
+gui_nicklist_group_index_cmp_cb (void *data, struct t_arraylist *arraylist,
+                                 void *pointer1, void *pointer2)
+{
+    /* make C compiler happy */
+    (void) data;
+    (void) arraylist;
+
+    return string_strcasecmp (((struct t_gui_nick *)pointer1)->name,
+                              ((struct t_gui_nick *)pointer2)->name);
+}
+
+/*
+ * Builds the sorted index of a group with the nicks of the group (which must
+ * be already sorted).
+ *
+ * If an error occurs, the index is freed (nicks are then searched in the
+ * linked list).
+ */
+
+void
+gui_nicklist_group_index_build (struct t_gui_nick_group *group)
+{
+    struct t_gui_nick *ptr_nick;
+
+    if (!group->nicks_index)
+        return;
+
+    arraylist_clear (group->nicks_index);
+    for (ptr_nick = group->nicks; ptr_nick; ptr_nick = ptr_nick->next_nick)
+    {
+        if (arraylist_add (group->nicks_index, ptr_nick) < 0)
+        {
+            arraylist_free (group->nicks_index);
+            group->nicks_index = NULL;
+            return;
+        }
+    }
+}
+
+/*
+ * Removes a nick from the sorted index of a group.
+ */
+
+void
+gui_nicklist_group_index_remove_nick (struct t_gui_nick_group *group,
+                                      struct t_gui_nick *nick)
+{
+    int index;
+
+    if (!group->nicks_index)
+        return;
+
+    /* first nick with same name (case insensitive), then search the nick */
+    (void) arraylist_search (group->nicks_index, nick, &index, NULL);
+    if (index < 0)
+        return;
+    while ((index < arraylist_size (group->nicks_index))
+           && (gui_nicklist_group_index_cmp_cb (
+                   NULL, group->nicks_index,
+                   arraylist_get (group->nicks_index, index), nick) == 0))
+    {
+        if (arraylist_get (group->nicks_index, index) == nick)
+        {
+            arraylist_remove (group->nicks_index, index);
+            return;
+        }
+        index++;
+    }
+}
+
 /*
  * Searches for position of a group (to keep nicklist sorted).
  */
@@ -277,6 +603,10 @@ gui_nicklist_add_group (struct t_gui_buffer *buffer,
     new_group->last_child = NULL;
     new_group->nicks = NULL;
     new_group->last_nick = NULL;
+    new_group->nicks_index = arraylist_new (0, 1, 1,
+                                            &gui_nicklist_group_index_cmp_cb,
+                                            NULL, NULL, NULL);
+    new_group->nicks_visible_count = 0;
     new_group->prev_group = NULL;
     new_group->next_group = NULL;
 
@@ -303,7 +633,8 @@ gui_nicklist_add_group (struct t_gui_buffer *buffer,
 }
 
 /*
- * Searches for position of a nick (to keep nicklist sorted).
+ * Searches for position of a nick (to keep nicklist sorted), without sorted
+ * index in group.
  */
 
 struct t_gui_nick *
@@ -327,6 +658,9 @@ gui_nicklist_find_pos_nick (struct t_gui_nick_group *group,
 
 /*
  * Inserts nick into sorted list.
+ *
+ * The position is found with a binary search in the sorted index of group
+ * (if the group has no index, the list is searched).
  */
 
 void
@@ -334,10 +668,24 @@ gui_nicklist_insert_nick_sorted (struct t_gui_nick_group *group,
                                  struct t_gui_nick *nick)
 {
     struct t_gui_nick *pos_nick;
+    int index;
+
+    index = -1;
+    if (group->nicks_index)
+    {
+        index = arraylist_add (group->nicks_index, nick);
+        if (index < 0)
+        {
+            arraylist_free (group->nicks_index);
+            group->nicks_index = NULL;
+        }
+    }
 
     if (group->nicks)
     {
-        pos_nick = gui_nicklist_find_pos_nick (group, nick);
+        pos_nick = (index >= 0) ?
+            arraylist_get (group->nicks_index, index + 1) :
+            gui_nicklist_find_pos_nick (group, nick);
 
         if (pos_nick)
         {
@@ -368,9 +716,194 @@ gui_nicklist_insert_nick_sorted (struct t_gui_nick_group *group,
     }
 }
 
+/*
+ * Adds a nick at the end of a group (the group is sorted at the end of bulk
+ * mode).
+ */
+
+void
+gui_nicklist_append_nick (struct t_gui_nick_group *group,
+                          struct t_gui_nick *nick)
+{
+    nick->prev_nick = group->last_nick;
+    nick->next_nick = NULL;
+    if (group->last_nick)
+        group->last_nick->next_nick = nick;
+    else
+        group->nicks = nick;
+    group->last_nick = nick;
+}
+
+/*
+ * Sorts a list of nicks by name (merge sort, nicks with same name keep their
+ * order).
+ *
+ * Only the links to next nick are updated.
+ *
+ * Returns pointer to first nick of sorted list.
+ */
+
+struct t_gui_nick *
+gui_nicklist_sort_nicks (struct t_gui_nick *nicks)
+{
+    struct t_gui_nick *ptr_slow, *ptr_fast, *nicks2, *sorted_nicks;
+    struct t_gui_nick **ptr_next;
+
+    if (!nicks || !nicks->next_nick)
+        return nicks;
+
+    /* split list in two halves */
+    ptr_slow = nicks;
+    ptr_fast = nicks->next_nick;
+    while (ptr_fast && ptr_fast->next_nick)
+    {
+        ptr_slow = ptr_slow->next_nick;
+        ptr_fast = ptr_fast->next_nick->next_nick;
+    }
+    nicks2 = ptr_slow->next_nick;
+    ptr_slow->next_nick = NULL;
+
+    nicks = gui_nicklist_sort_nicks (nicks);
+    nicks2 = gui_nicklist_sort_nicks (nicks2);
+
+    /* merge the two sorted lists */
+    sorted_nicks = NULL;
+    ptr_next = &sorted_nicks;
+    while (nicks && nicks2)
+    {
+        if (string_strcasecmp (nicks2->name, nicks->name) < 0)
+        {
+            *ptr_next = nicks2;
+            nicks2 = nicks2->next_nick;
+        }
+        else
+        {
+            *ptr_next = nicks;
+            nicks = nicks->next_nick;
+        }
+        ptr_next = &((*ptr_next)->next_nick);
+    }
+    *ptr_next = (nicks) ? nicks : nicks2;
+
+    return sorted_nicks;
+}
+
+/*
+ * Sorts nicks of a group and its children.
+ */
+
+void
+gui_nicklist_sort_group (struct t_gui_nick_group *group)
+{
+    struct t_gui_nick_group *ptr_group;
+    struct t_gui_nick *ptr_nick, *prev_nick;
+
+    group->nicks = gui_nicklist_sort_nicks (group->nicks);
+
+    /* update links to previous nick and last nick */
+    prev_nick = NULL;
+    for (ptr_nick = group->nicks; ptr_nick; ptr_nick = ptr_nick->next_nick)
+    {
+        ptr_nick->prev_nick = prev_nick;
+        prev_nick = ptr_nick;
+    }
+    group->last_nick = prev_nick;
+
+    gui_nicklist_group_index_build (group);
+
+    for (ptr_group = group->children; ptr_group;
+         ptr_group = ptr_group->next_group)
+    {
+        gui_nicklist_sort_group (ptr_group);
+    }
+}
+
+/*
+ * Starts bulk mode for nicklist of a buffer: nicks added are not sorted and
+ * nicklist signals are not sent until the end of bulk mode.
+ *
+ * This is used to add many nicks at once (for example on join of a large IRC
+ * channel), which would otherwise search, sort and send signals for each
+ * nick: in bulk mode, nicks added are not searched in nicklist, so the caller
+ * must not add a nick which is already in nicklist.
+ */
+
+void
+gui_nicklist_bulk_start (struct t_gui_buffer *buffer)
+{
+    if (!buffer || buffer->nicklist_bulk)
+        return;
+
+    buffer->nicklist_bulk = 1;
+    buffer->nicklist_bulk_changes = 0;
+}
+
+/*
+ * Ends bulk mode for nicklist of a buffer: sorts all groups and sends a
+ * single signal "nicklist_changed" (if the nicklist has changed).
+ */
+
+void
+gui_nicklist_bulk_end (struct t_gui_buffer *buffer)
+{
+    if (!buffer || !buffer->nicklist_bulk)
+        return;
+
+    buffer->nicklist_bulk = 0;
+
+    if (buffer->nicklist_root)
+        gui_nicklist_sort_group (buffer->nicklist_root);
+
+    if (buffer->nicklist_bulk_changes > 0)
+    {
+        buffer->nicklist_bulk_changes = 0;
+        gui_nicklist_send_signal ("nicklist_changed", buffer, NULL);
+        gui_nicklist_send_hsignal ("nicklist_changed", buffer, NULL, NULL);
+    }
+}
+
+/*
+ * Searches for a nick in nicklist, in all nicks of group and its children
+ * (this function must not be called directly).
+ *
+ * Returns pointer to nick found, NULL if not found.
+ */
+
+struct t_gui_nick *
+gui_nicklist_search_nick_internal (struct t_gui_buffer *buffer,
+                                   struct t_gui_nick_group *from_group,
+                                   const char *name)
+{
+    struct t_gui_nick *ptr_nick;
+    struct t_gui_nick_group *ptr_group;
+
+    for (ptr_nick = from_group->nicks; ptr_nick;
+         ptr_nick = ptr_nick->next_nick)
+    {
+        if (gui_nicklist_nickcmp (buffer, ptr_nick, name) == 0)
+            return ptr_nick;
+    }
+
+    /* search nick in child groups */
+    for (ptr_group = from_group->children; ptr_group;
+         ptr_group = ptr_group->next_group)
+    {
+        ptr_nick = gui_nicklist_search_nick_internal (buffer, ptr_group, name);
+        if (ptr_nick)
+            return ptr_nick;
+    }
+
+    /* nick not found */
+    return NULL;
+}
+
 /*
  * Searches for a nick in nicklist.
  *
+ * The nick is searched in the nicks index of buffer, then in all nicks if
+ * some nicks have the same key in index, or if the nick comparison callback
+ * of buffer is not compatible with the index (property "nickcmp_index").
+ *
  * Returns pointer to nick found, NULL if not found.
  */
 
@@ -381,40 +914,44 @@ gui_nicklist_search_nick (struct t_gui_buffer *buffer,
 {
     struct t_gui_nick *ptr_nick;
     struct t_gui_nick_group *ptr_group;
+    char *key;
+
+    if (!buffer || !name)
+        return NULL;
+
+    if (!from_group)
+        from_group = buffer->nicklist_root;
 
-    if (!buffer && !from_group)
+    if (!from_group)
         return NULL;
 
-    if (!from_group && !buffer->nicklist_root)
+    if (!buffer->nicklist_nicks_index)
+        return gui_nicklist_search_nick_internal (buffer, from_group, name);
+
+    key = gui_nicklist_index_key (buffer, name);
+    if (!key)
         return NULL;
+    ptr_nick = hashtable_get (buffer->nicklist_nicks_index, key);
+    free (key);
 
-    for (ptr_nick = (from_group) ? from_group->nicks : buffer->nicklist_root->nicks;
-         ptr_nick; ptr_nick = ptr_nick->next_nick)
+    if (ptr_nick && (gui_nicklist_nickcmp (buffer, ptr_nick, name) == 0))
     {
-        if (buffer->nickcmp_callback)
-        {
-            if ((buffer->nickcmp_callback) (buffer->nickcmp_callback_pointer,
-                                            buffer->nickcmp_callback_data,
-                                            buffer,
-                                            ptr_nick->name,
-                                            name) == 0)
-                return ptr_nick;
-        }
-        else
+        /* check that nick is in group "from_group" (or its children) */
+        for (ptr_group = ptr_nick->group; ptr_group;
+             ptr_group = ptr_group->parent)
         {
-            if (strcmp (ptr_nick->name, name) == 0)
+            if (ptr_group == from_group)
                 return ptr_nick;
         }
     }
 
-    /* search nick in child groups */
-    for (ptr_group = (from_group) ? from_group->children : buffer->nicklist_root->children;
-         ptr_group; ptr_group = ptr_group->next_group)
-    {
-        ptr_nick = gui_nicklist_search_nick (buffer, ptr_group, name);
-        if (ptr_nick)
-            return ptr_nick;
-    }
+    /* nick not found in index, other nicks may have the same key */
+    if (ptr_nick && (buffer->nicklist_nicks_index_collisions > 0))
+        return gui_nicklist_search_nick_internal (buffer, from_group, name);
+
+    /* nick not found in index, the callback may fold other chars */
+    if (buffer->nickcmp_callback && !buffer->nickcmp_index)
+        return gui_nicklist_search_nick_internal (buffer, from_group, name);
 
     /* nick not found */
     return NULL;
@@ -435,7 +972,11 @@ gui_nicklist_add_nick (struct t_gui_buffer *buffer,
 {
     struct t_gui_nick *new_nick;
 
-    if (!buffer || !name || gui_nicklist_search_nick (buffer, NULL, name))
+    if (!buffer || !name)
+        return NULL;
+
+    /* in bulk mode, the caller must not add a nick already in nicklist */
+    if (!buffer->nicklist_bulk && gui_nicklist_search_nick (buffer, NULL, name))
         return NULL;
 
     new_nick = malloc (sizeof (*new_nick));
@@ -449,13 +990,21 @@ gui_nicklist_add_nick (struct t_gui_buffer *buffer,
     new_nick->prefix_color = (prefix_color) ? (char *)string_shared_get (prefix_color) : NULL;
     new_nick->visible = visible;
 
-    gui_nicklist_insert_nick_sorted (new_nick->group, new_nick);
+    if (buffer->nicklist_bulk)
+        gui_nicklist_append_nick (new_nick->group, new_nick);
+    else
+        gui_nicklist_insert_nick_sorted (new_nick->group, new_nick);
+
+    gui_nicklist_index_add_nick (buffer, new_nick);
 
     buffer->nicklist_count++;
     buffer->nicklist_nicks_count++;
 
     if (visible)
+    {
         buffer->nicklist_visible_count++;
+        new_nick->group->nicks_visible_count++;
+    }
 
     if (CONFIG_BOOLEAN(config_look_color_nick_offline))
         gui_buffer_ask_chat_refresh (buffer, 1);
@@ -484,6 +1033,10 @@ gui_nicklist_remove_nick (struct t_gui_buffer *buffer,
     gui_nicklist_send_signal ("nicklist_nick_removing", buffer, nick_removed);
     gui_nicklist_send_hsignal ("nicklist_nick_removing", buffer, NULL, nick);
 
+    /* remove nick from indexes */
+    gui_nicklist_index_remove_nick (buffer, nick);
+    gui_nicklist_group_index_remove_nick (nick->group, nick);
+
     /* remove nick from list */
     if (nick->prev_nick)
         (nick->prev_nick)->next_nick = nick->next_nick;
@@ -511,6 +1064,8 @@ gui_nicklist_remove_nick (struct t_gui_buffer *buffer,
     {
         if (buffer->nicklist_visible_count > 0)
             buffer->nicklist_visible_count--;
+        if ((nick->group)->nicks_visible_count > 0)
+            (nick->group)->nicks_visible_count--;
     }
 
     free (nick);
@@ -572,6 +1127,12 @@ gui_nicklist_remove_group (struct t_gui_buffer *buffer,
     else
     {
         buffer->nicklist_root = NULL;
+        if (buffer->nicklist_nicks_index)
+        {
+            hashtable_free (buffer->nicklist_nicks_index);
+            buffer->nicklist_nicks_index = NULL;
+        }
+        buffer->nicklist_nicks_index_collisions = 0;
     }
 
     /* free data */
@@ -579,6 +1140,8 @@ gui_nicklist_remove_group (struct t_gui_buffer *buffer,
         string_shared_free (group->name);
     if (group->color)
         string_shared_free (group->color);
+    if (group->nicks_index)
+        arraylist_free (group->nicks_index);
 
     if (group->visible)
     {
@@ -618,6 +1181,117 @@ gui_nicklist_remove_all (struct t_gui_buffer *buffer)
     }
 }
 
+/*
+ * Searches for a visible item (group or nick) by index in a group and its
+ * children (this function must not be called directly).
+ *
+ * Items are in the same order as returned by function
+ * gui_nicklist_get_next_item.
+ *
+ * Returns:
+ *   1: item found ("index" is the index of item in group)
+ *   0: item not found ("index" is decremented by the number of visible items
+ *      in group)
+ */
+
+int
+gui_nicklist_get_visible_item_internal (struct t_gui_buffer *buffer,
+                                        struct t_gui_nick_group *from_group,
+                                        int *index,
+                                        struct t_gui_nick_group **group,
+                                        struct t_gui_nick **nick)
+{
+    struct t_gui_nick_group *ptr_group;
+    struct t_gui_nick *ptr_nick;
+    int i;
+
+    if (buffer->nicklist_display_groups && from_group->visible)
+    {
+        if (*index == 0)
+        {
+            *group = from_group;
+            *nick = NULL;
+            return 1;
+        }
+        (*index)--;
+    }
+
+    /* nicks of a group are displayed only if the group has no children */
+    if (from_group->children)
+    {
+        for (ptr_group = from_group->children; ptr_group;
+             ptr_group = ptr_group->next_group)
+        {
+            if (gui_nicklist_get_visible_item_internal (buffer, ptr_group,
+                                                        index, group, nick))
+                return 1;
+        }
+        return 0;
+    }
+
+    if (*index >= from_group->nicks_visible_count)
+    {
+        *index -= from_group->nicks_visible_count;
+        return 0;
+    }
+
+    *group = from_group;
+
+    /*
+     * all nicks are visible: direct access in sorted index (not in bulk
+     * mode: the index is updated only at the end of bulk mode)
+     */
+    if (!buffer->nicklist_bulk
+        && from_group->nicks_index
+        && (arraylist_size (from_group->nicks_index) == from_group->nicks_visible_count))
+    {
+        *nick = arraylist_get (from_group->nicks_index, *index);
+        return (*nick) ? 1 : 0;
+    }
+
+    i = 0;
+    for (ptr_nick = from_group->nicks; ptr_nick;
+         ptr_nick = ptr_nick->next_nick)
+    {
+        if (ptr_nick->visible)
+        {
+            if (i == *index)
+            {
+                *nick = ptr_nick;
+                return 1;
+            }
+            i++;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Searches for a visible item (group or nick) by index (first visible item
+ * is 0): this is the line of item in bar item "buffer_nicklist".
+ *
+ * Returns:
+ *   1: item found (a group if *nick is NULL, otherwise a nick)
+ *   0: item not found
+ */
+
+int
+gui_nicklist_get_visible_item (struct t_gui_buffer *buffer, int index,
+                               struct t_gui_nick_group **group,
+                               struct t_gui_nick **nick)
+{
+    *group = NULL;
+    *nick = NULL;
+
+    if (!buffer || !buffer->nicklist_root || (index < 0))
+        return 0;
+
+    return gui_nicklist_get_visible_item_internal (buffer,
+                                                   buffer->nicklist_root,
+                                                   &index, group, nick);
+}
+
 /*
  * Gets next item (group or nick) of a group/nick.
  */
@@ -1019,7 +1693,18 @@ gui_nicklist_nick_set (struct t_gui_buffer *buffer,
         error = NULL;
         number = strtol (value, &error, 10);
         if (error && !error[0])
+        {
+            if (nick->visible && !number)
+            {
+                if ((nick->group)->nicks_visible_count > 0)
+                    (nick->group)->nicks_visible_count--;
+            }
+            else if (!nick->visible && number)
+            {
+                (nick->group)->nicks_visible_count++;
+            }
             nick->visible = (number) ? 1 : 0;
+        }
         nick_changed = 1;
     }
 
@@ -1058,6 +1743,8 @@ gui_nicklist_hdata_nick_group_cb (const void *pointer, void *data,
         HDATA_VAR(struct t_gui_nick_group, last_child, POINTER, 0, NULL, hdata_name);
         HDATA_VAR(struct t_gui_nick_group, nicks, POINTER, 0, NULL, "nick");
         HDATA_VAR(struct t_gui_nick_group, last_nick, POINTER, 0, NULL, "nick");
+        HDATA_VAR(struct t_gui_nick_group, nicks_index, POINTER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_nick_group, nicks_visible_count, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_nick_group, prev_group, POINTER, 0, NULL, hdata_name);
         HDATA_VAR(struct t_gui_nick_group, next_group, POINTER, 0, NULL, hdata_name);
     }
@@ -1276,6 +1963,14 @@ gui_nicklist_print_log (struct t_gui_nick_group *group, int indent)
               "%%-%dslast_nick . : 0x%%lx",
               (indent * 2) + 6);
     log_printf (format, " ", group->last_nick);
+    snprintf (format, sizeof (format),
+              "%%-%dsnicks_index : 0x%%lx",
+              (indent * 2) + 6);
+    log_printf (format, " ", group->nicks_index);
+    snprintf (format, sizeof (format),
+              "%%-%dsnicks_visible_count: %%d",
+              (indent * 2) + 6);
+    log_printf (format, " ", group->nicks_visible_count);
     snprintf (format, sizeof (format),
               "%%-%dsprev_group. : 0x%%lx",
               (indent * 2) + 6);
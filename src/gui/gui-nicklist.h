@@ -22,6 +22,14 @@
 
 struct t_gui_buffer;
 struct t_infolist;
+struct t_arraylist;
+
+/*
+ * chars converted to lower case in keys of nicks index, when buffer has a
+ * nick comparison callback: A-Z [ \ ] ^ ==> a-z { | } ~ (so that nicks equal
+ * with any IRC casemapping have the same key)
+ */
+#define GUI_NICKLIST_INDEX_CASE_RANGE 30
 
 struct t_gui_nick_group
 {
@@ -34,6 +42,8 @@ struct t_gui_nick_group
     struct t_gui_nick_group *last_child; /* last child                      */
     struct t_gui_nick *nicks;          /* nicks for group                   */
     struct t_gui_nick *last_nick;      /* last nick for group               */
+    struct t_arraylist *nicks_index;   /* nicks sorted by name (index)      */
+    int nicks_visible_count;           /* number of visible nicks in group  */
     struct t_gui_nick_group *prev_group; /* link to previous group          */
     struct t_gui_nick_group *next_group; /* link to next group              */
 };
@@ -60,6 +70,7 @@ extern struct t_gui_nick_group *gui_nicklist_add_group (struct t_gui_buffer *buf
                                                         const char *name,
                                                         const char *color,
                                                         int visible);
+extern void gui_nicklist_index_build (struct t_gui_buffer *buffer);
 extern struct t_gui_nick *gui_nicklist_search_nick (struct t_gui_buffer *buffer,
                                                     struct t_gui_nick_group *from_group,
                                                     const char *name);
@@ -70,11 +81,17 @@ extern struct t_gui_nick *gui_nicklist_add_nick (struct t_gui_buffer *buffer,
                                                  const char *prefix,
                                                  const char *prefix_color,
                                                  int visible);
+extern void gui_nicklist_bulk_start (struct t_gui_buffer *buffer);
+extern void gui_nicklist_bulk_end (struct t_gui_buffer *buffer);
 extern void gui_nicklist_remove_group (struct t_gui_buffer *buffer,
                                        struct t_gui_nick_group *group);
 extern void gui_nicklist_remove_nick (struct t_gui_buffer *buffer,
                                       struct t_gui_nick *nick);
 extern void gui_nicklist_remove_all (struct t_gui_buffer *buffer);
+extern int gui_nicklist_get_visible_item (struct t_gui_buffer *buffer,
+                                          int index,
+                                          struct t_gui_nick_group **group,
+                                          struct t_gui_nick **nick);
 extern void gui_nicklist_get_next_item (struct t_gui_buffer *buffer,
                                         struct t_gui_nick_group **group,
                                         struct t_gui_nick **nick);
@@ -189,7 +189,9 @@ gui_window_get_context_at_xy (struct t_gui_window *window,
         if ((win_x >= window->coords[win_y].time_x1)
             && (win_x <= window->coords[win_y].time_x2))
         {
-            *word = gui_color_decode ((*line)->data->str_time, NULL);
+            *word = gui_color_decode (
+                gui_chat_get_time_string_cached ((*line)->data->date),
+                NULL);
         }
         else if ((win_x >= window->coords[win_y].buffer_x1)
                  && (win_x <= window->coords[win_y].buffer_x2))
@@ -267,11 +269,16 @@ gui_window_get_context_at_xy (struct t_gui_window *window,
 
 /*
  * Sets flag "gui_window_refresh_needed".
+ *
+ * A full refresh can be caused by a change of options, so the layouts of
+ * lines in cache are invalidated.
  */
 
 void
 gui_window_ask_refresh (int refresh)
 {
+    gui_chat_layout_generation++;
+
     if (refresh > gui_window_refresh_needed)
         gui_window_refresh_needed = refresh;
 }
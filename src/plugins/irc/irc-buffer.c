@@ -46,6 +46,7 @@ irc_buffer_get_server_and_channel (struct t_gui_buffer *buffer,
 {
     struct t_irc_server *ptr_server;
     struct t_irc_channel *ptr_channel;
+    const char *ptr_server_name, *ptr_channel_name;
 
     if (server)
         *server = NULL;
@@ -55,6 +56,30 @@ irc_buffer_get_server_and_channel (struct t_gui_buffer *buffer,
     if (!buffer)
         return;
 
+    /* quick search using local variables "server" and "channel" of buffer */
+    ptr_server_name = weechat_buffer_get_string (buffer, "localvar_server");
+    ptr_server = irc_server_search (ptr_server_name);
+    if (ptr_server)
+    {
+        if (ptr_server->buffer == buffer)
+        {
+            if (server)
+                *server = ptr_server;
+            return;
+        }
+        ptr_channel_name = weechat_buffer_get_string (buffer,
+                                                      "localvar_channel");
+        ptr_channel = irc_channel_search (ptr_server, ptr_channel_name);
+        if (ptr_channel && (ptr_channel->buffer == buffer))
+        {
+            if (server)
+                *server = ptr_server;
+            if (channel)
+                *channel = ptr_channel;
+            return;
+        }
+    }
+
     /* look for a server or channel using this buffer */
     for (ptr_server = irc_servers; ptr_server;
          ptr_server = ptr_server->next_server)
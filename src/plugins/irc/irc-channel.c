@@ -163,6 +163,9 @@ irc_channel_search (struct t_irc_server *server, const char *channel_name)
     if (!server || !channel_name)
         return NULL;
 
+    if (server->channels_hashtable)
+        return weechat_hashtable_get (server->channels_hashtable, channel_name);
+
     for (ptr_channel = server->channels; ptr_channel;
          ptr_channel = ptr_channel->next_channel)
     {
@@ -172,9 +175,48 @@ irc_channel_search (struct t_irc_server *server, const char *channel_name)
     return NULL;
 }
 
+/*
+ * Checks if a buffer is the buffer of a channel (using local variables of
+ * buffer).
+ *
+ * Returns:
+ *   1: buffer is the buffer of channel
+ *   0: buffer is not the buffer of channel
+ */
+
+int
+irc_channel_buffer_match (struct t_irc_server *server,
+                          struct t_gui_buffer *buffer, int channel_type,
+                          const char *channel_name)
+{
+    const char *ptr_type, *ptr_server_name, *ptr_channel_name;
+
+    if (weechat_buffer_get_pointer (buffer, "plugin") != weechat_irc_plugin)
+        return 0;
+
+    ptr_type = weechat_buffer_get_string (buffer, "localvar_type");
+    ptr_server_name = weechat_buffer_get_string (buffer, "localvar_server");
+    ptr_channel_name = weechat_buffer_get_string (buffer, "localvar_channel");
+
+    return (ptr_type && ptr_type[0]
+            && ptr_server_name && ptr_server_name[0]
+            && ptr_channel_name && ptr_channel_name[0]
+            && (((channel_type == IRC_CHANNEL_TYPE_CHANNEL)
+                 && (strcmp (ptr_type, "channel") == 0))
+                || ((channel_type == IRC_CHANNEL_TYPE_PRIVATE)
+                    && (strcmp (ptr_type, "private") == 0)))
+            && (strcmp (ptr_server_name, server->name) == 0)
+            && (irc_server_strcasecmp (server, ptr_channel_name,
+                                       channel_name) == 0)) ? 1 : 0;
+}
+
 /*
  * Searches for a channel buffer by channel name.
  *
+ * The buffer with the expected name ("server.channel") is checked first, then
+ * all buffers are checked (the buffer name may have a different case, or
+ * may have been changed by user).
+ *
  * Returns pointer to buffer found, NULL if not found.
  */
 
@@ -184,34 +226,26 @@ irc_channel_search_buffer (struct t_irc_server *server, int channel_type,
 {
     struct t_hdata *hdata_buffer;
     struct t_gui_buffer *ptr_buffer;
-    const char *ptr_type, *ptr_server_name, *ptr_channel_name;
+
+    ptr_buffer = weechat_buffer_search (
+        IRC_PLUGIN_NAME,
+        irc_buffer_build_name (server->name, channel_name));
+    if (ptr_buffer
+        && irc_channel_buffer_match (server, ptr_buffer, channel_type,
+                                     channel_name))
+    {
+        return ptr_buffer;
+    }
 
     hdata_buffer = weechat_hdata_get ("buffer");
     ptr_buffer = weechat_hdata_get_list (hdata_buffer, "gui_buffers");
 
     while (ptr_buffer)
     {
-        if (weechat_buffer_get_pointer (ptr_buffer,
-                                        "plugin") == weechat_irc_plugin)
+        if (irc_channel_buffer_match (server, ptr_buffer, channel_type,
+                                      channel_name))
         {
-            ptr_type = weechat_buffer_get_string (ptr_buffer, "localvar_type");
-            ptr_server_name = weechat_buffer_get_string (ptr_buffer,
-                                                         "localvar_server");
-            ptr_channel_name = weechat_buffer_get_string (ptr_buffer,
-                                                          "localvar_channel");
-            if (ptr_type && ptr_type[0]
-                && ptr_server_name && ptr_server_name[0]
-                && ptr_channel_name && ptr_channel_name[0]
-                && (((channel_type == IRC_CHANNEL_TYPE_CHANNEL)
-                     && (strcmp (ptr_type, "channel") == 0))
-                    || ((channel_type == IRC_CHANNEL_TYPE_PRIVATE)
-                        && (strcmp (ptr_type, "private") == 0)))
-                && (strcmp (ptr_server_name, server->name) == 0)
-                && ((irc_server_strcasecmp (server, ptr_channel_name,
-                                            channel_name) == 0)))
-            {
-                return ptr_buffer;
-            }
+            return ptr_buffer;
         }
 
         /* move to next buffer */
@@ -353,6 +387,7 @@ irc_channel_create_buffer (struct t_irc_server *server,
                                         &irc_buffer_nickcmp_cb);
             weechat_buffer_set_pointer (ptr_buffer, "nickcmp_callback_pointer",
                                         server);
+            weechat_buffer_set (ptr_buffer, "nickcmp_index", "1");
         }
 
         /* set highlights settings on channel buffer */
@@ -475,6 +510,8 @@ irc_channel_new (struct t_irc_server *server, int channel_type,
     new_channel->nicks_count = 0;
     new_channel->nicks = NULL;
     new_channel->last_nick = NULL;
+    new_channel->nicks_hashtable = NULL;
+    new_channel->nicklist_bulk = 0;
     new_channel->nicks_speaking[0] = NULL;
     new_channel->nicks_speaking[1] = NULL;
     new_channel->nicks_speaking_time = NULL;
@@ -484,6 +521,11 @@ irc_channel_new (struct t_irc_server *server, int channel_type,
     new_channel->buffer_as_string = NULL;
 
     /* add new channel to channels list */
+    if (!server->channels && !server->channels_hashtable)
+    {
+        server->channels_hashtable = irc_server_hashtable_casemapping_new (
+            server->casemapping, 32);
+    }
     new_channel->prev_channel = server->last_channel;
     new_channel->next_channel = NULL;
     if (server->channels)
@@ -491,6 +533,11 @@ irc_channel_new (struct t_irc_server *server, int channel_type,
     else
         server->channels = new_channel;
     server->last_channel = new_channel;
+    if (server->channels_hashtable)
+    {
+        weechat_hashtable_set (server->channels_hashtable,
+                               new_channel->name, new_channel);
+    }
 
     (void) weechat_hook_signal_send (
         (channel_type == IRC_CHANNEL_TYPE_CHANNEL) ?
@@ -530,6 +577,81 @@ irc_channel_add_nicklist_groups (struct t_irc_server *server,
                                 "weechat.color.nicklist_group", 1);
 }
 
+/*
+ * Builds again the hashtable with nicks of channel (called when the
+ * casemapping of server changes).
+ */
+
+void
+irc_channel_rebuild_nicks_hashtable (struct t_irc_server *server,
+                                     struct t_irc_channel *channel)
+{
+    struct t_irc_nick *ptr_nick;
+
+    if (!channel->nicks_hashtable)
+        return;
+
+    weechat_hashtable_free (channel->nicks_hashtable);
+    channel->nicks_hashtable = irc_server_hashtable_casemapping_new (
+        server->casemapping, 32);
+    if (!channel->nicks_hashtable)
+        return;
+
+    for (ptr_nick = channel->nicks; ptr_nick;
+         ptr_nick = ptr_nick->next_nick)
+    {
+        weechat_hashtable_set (channel->nicks_hashtable,
+                               ptr_nick->name, ptr_nick);
+    }
+}
+
+/*
+ * Starts bulk mode for nicklist of channel (when receiving NAMES replies on
+ * join, or WHO replies for the WHO sent by WeeChat on the channel): nicks are
+ * sorted and a single nicklist signal is sent at the end of bulk mode.
+ */
+
+void
+irc_channel_nicklist_bulk_start (struct t_irc_channel *channel)
+{
+    if (!channel || channel->nicklist_bulk || !channel->buffer)
+        return;
+
+    weechat_buffer_set (channel->buffer, "nicklist_bulk", "1");
+    channel->nicklist_bulk = 1;
+}
+
+/*
+ * Ends bulk mode for nicklist of channel.
+ */
+
+void
+irc_channel_nicklist_bulk_end (struct t_irc_channel *channel)
+{
+    if (!channel || !channel->nicklist_bulk)
+        return;
+
+    if (channel->buffer)
+        weechat_buffer_set (channel->buffer, "nicklist_bulk", "0");
+    channel->nicklist_bulk = 0;
+}
+
+/*
+ * Ends bulk mode for nicklist of all channels of a server.
+ */
+
+void
+irc_channel_nicklist_bulk_end_all (struct t_irc_server *server)
+{
+    struct t_irc_channel *ptr_channel;
+
+    for (ptr_channel = server->channels; ptr_channel;
+         ptr_channel = ptr_channel->next_channel)
+    {
+        irc_channel_nicklist_bulk_end (ptr_channel);
+    }
+}
+
 /*
  * Sets the buffer title with the channel topic.
  */
@@ -1382,8 +1504,17 @@ irc_channel_free (struct t_irc_server *server, struct t_irc_channel *channel)
     if (channel->next_channel)
         (channel->next_channel)->prev_channel = channel->prev_channel;
 
+    if (server->channels_hashtable && channel->name
+        && (weechat_hashtable_get (server->channels_hashtable,
+                                   channel->name) == channel))
+    {
+        weechat_hashtable_remove (server->channels_hashtable, channel->name);
+    }
+
     /* free linked lists */
     irc_nick_free_all (server, channel);
+    if (channel->nicks_hashtable)
+        weechat_hashtable_free (channel->nicks_hashtable);
 
     /* free channel data */
     if (channel->name)
@@ -1649,6 +1780,8 @@ irc_channel_print_log (struct t_irc_channel *channel)
     weechat_log_printf ("       nicks_count. . . . . . . : %d",    channel->nicks_count);
     weechat_log_printf ("       nicks. . . . . . . . . . : 0x%lx", channel->nicks);
     weechat_log_printf ("       last_nick. . . . . . . . : 0x%lx", channel->last_nick);
+    weechat_log_printf ("       nicks_hashtable. . . . . : 0x%lx", channel->nicks_hashtable);
+    weechat_log_printf ("       nicklist_bulk. . . . . . : %d",    channel->nicklist_bulk);
     weechat_log_printf ("       nicks_speaking[0]. . . . : 0x%lx", channel->nicks_speaking[0]);
     weechat_log_printf ("       nicks_speaking[1]. . . . : 0x%lx", channel->nicks_speaking[1]);
     weechat_log_printf ("       nicks_speaking_time. . . : 0x%lx", channel->nicks_speaking_time);
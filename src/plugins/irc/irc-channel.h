@@ -63,6 +63,10 @@ struct t_irc_channel
     int nicks_count;                   /* # nicks on channel (0 if pv)      */
     struct t_irc_nick *nicks;          /* nicks on the channel              */
     struct t_irc_nick *last_nick;      /* last nick on the channel          */
+    struct t_hashtable *nicks_hashtable; /* nicks indexed by name (keys   */
+                                       /* compared with server casemapping) */
+    int nicklist_bulk;                 /* 1 if nicklist is in bulk mode     */
+                                       /* (receiving NAMES/WHO replies)     */
     struct t_weelist *nicks_speaking[2]; /* for smart completion: first     */
                                        /* list is nick speaking, second is  */
                                        /* speaking to me (highlight)        */
@@ -95,6 +99,11 @@ extern struct t_irc_channel *irc_channel_new (struct t_irc_server *server,
                                               int auto_switch);
 extern void irc_channel_add_nicklist_groups (struct t_irc_server *server,
                                              struct t_irc_channel *channel);
+extern void irc_channel_rebuild_nicks_hashtable (struct t_irc_server *server,
+                                                 struct t_irc_channel *channel);
+extern void irc_channel_nicklist_bulk_start (struct t_irc_channel *channel);
+extern void irc_channel_nicklist_bulk_end (struct t_irc_channel *channel);
+extern void irc_channel_nicklist_bulk_end_all (struct t_irc_server *server);
 extern void irc_channel_set_buffer_title (struct t_irc_channel *channel);
 extern void irc_channel_set_topic (struct t_irc_channel *channel,
                                    const char *topic);
@@ -25,77 +25,58 @@
 
 #include "../weechat-plugin.h"
 #include "irc.h"
+#include "irc-message.h"
 #include "irc-server.h"
 #include "irc-channel.h"
 
 
 /*
- * Parses an IRC message and returns:
- *   - tags (string)
- *   - message without tags (string)
- *   - nick (string)
- *   - host (string)
- *   - command (string)
- *   - channel (string)
- *   - arguments (string)
- *   - text (string)
- *   - pos_command (integer: command index in message)
- *   - pos_arguments (integer: arguments index in message)
- *   - pos_channel (integer: channel index in message)
- *   - pos_text (integer: text index in message)
+ * Parses an IRC message and returns position and length of each part of the
+ * message (nothing is allocated, positions are indexes in message):
+ *   - tags
+ *   - message without tags
+ *   - nick
+ *   - host
+ *   - command
+ *   - channel
+ *   - arguments (until the end of message)
+ *   - text (until the end of message)
+ *
+ * A position is -1 if the part is not found in message.
  *
  * Example:
  *   @time=2015-06-27T16:40:35.000Z :nick!user@host PRIVMSG #weechat :hello!
  *
  * Result:
- *               tags: "time=2015-06-27T16:40:35.000Z"
- *   msg_without_tags: ":nick!user@host PRIVMSG #weechat :hello!"
- *               nick: "nick"
- *               host: "nick!user@host"
- *            command: "PRIVMSG"
- *            channel: "#weechat"
- *          arguments: "#weechat :hello!"
- *               text: "hello!"
- *        pos_command: 47
- *      pos_arguments: 55
- *        pos_channel: 55
- *           pos_text: 65
+ *                       pos_tags: 1 (length: 29)
+ *   pos_message_without_tags: 31
+ *                       pos_nick: 32 (length: 4)
+ *                       pos_host: 32 (length: 14)
+ *                    pos_command: 47 (length: 7)
+ *                    pos_channel: 55 (length: 8)
+ *                  pos_arguments: 55
+ *                       pos_text: 65
  */
 
 void
-irc_message_parse (struct t_irc_server *server, const char *message,
-                   char **tags, char **message_without_tags, char **nick,
-                   char **host, char **command, char **channel,
-                   char **arguments, char **text,
-                   int *pos_command, int *pos_arguments, int *pos_channel,
-                   int *pos_text)
+irc_message_parse_view (struct t_irc_server *server, const char *message,
+                        struct t_irc_message_view *view)
 {
     const char *ptr_message, *pos, *pos2, *pos3, *pos4, *ptr_channel_found;
 
-    if (tags)
-        *tags = NULL;
-    if (message_without_tags)
-        *message_without_tags = NULL;
-    if (nick)
-        *nick = NULL;
-    if (host)
-        *host = NULL;
-    if (command)
-        *command = NULL;
-    if (channel)
-        *channel = NULL;
-    if (arguments)
-        *arguments = NULL;
-    if (text)
-        *text = NULL;
-    if (pos_command)
-        *pos_command = -1;
-    if (pos_arguments)
-        *pos_arguments = -1;
-    if (pos_channel)
-        *pos_channel = -1;
-    if (pos_text)
-        *pos_text = -1;
+    view->pos_tags = -1;
+    view->length_tags = 0;
+    view->pos_message_without_tags = -1;
+    view->pos_nick = -1;
+    view->length_nick = 0;
+    view->pos_host = -1;
+    view->length_host = 0;
+    view->pos_command = -1;
+    view->length_command = 0;
+    view->pos_channel = -1;
+    view->length_channel = 0;
+    view->pos_arguments = -1;
+    view->pos_text = -1;
     ptr_channel_found = NULL;
 
     if (!message)
@@ -119,11 +100,8 @@ irc_message_parse (struct t_irc_server *server, const char *message,
         pos = strchr (ptr_message, ' ');
         if (pos)
         {
-            if (tags)
-            {
-                *tags = weechat_strndup (ptr_message + 1,
-                                         pos - (ptr_message + 1));
-            }
+            view->pos_tags = 1;
+            view->length_tags = pos - (ptr_message + 1);
             ptr_message = pos + 1;
             while (ptr_message[0] == ' ')
             {
@@ -132,8 +110,7 @@ irc_message_parse (struct t_irc_server *server, const char *message,
         }
     }
 
-    if (message_without_tags)
-        *message_without_tags = strdup (ptr_message);
+    view->pos_message_without_tags = ptr_message - message;
 
     /* now we have: ptr_message --> ":nick!user@host PRIVMSG #weechat :hello!" */
     if (ptr_message[0] == ':')
@@ -147,18 +124,18 @@ irc_message_parse (struct t_irc_server *server, const char *message,
             pos2 = pos3;
         if (pos2 && (!pos || pos > pos2))
         {
-            if (nick)
-                *nick = weechat_strndup (ptr_message + 1, pos2 - (ptr_message + 1));
+            view->pos_nick = ptr_message + 1 - message;
+            view->length_nick = pos2 - (ptr_message + 1);
         }
         else if (pos)
         {
-            if (nick)
-                *nick = weechat_strndup (ptr_message + 1, pos - (ptr_message + 1));
+            view->pos_nick = ptr_message + 1 - message;
+            view->length_nick = pos - (ptr_message + 1);
         }
+        view->pos_host = ptr_message + 1 - message;
         if (pos)
         {
-            if (host)
-                *host = weechat_strndup (ptr_message + 1, pos - (ptr_message + 1));
+            view->length_host = pos - (ptr_message + 1);
             ptr_message = pos + 1;
             while (ptr_message[0] == ' ')
             {
@@ -167,8 +144,7 @@ irc_message_parse (struct t_irc_server *server, const char *message,
         }
         else
         {
-            if (host)
-                *host = strdup (ptr_message + 1);
+            view->length_host = strlen (ptr_message + 1);
             ptr_message += strlen (ptr_message);
         }
     }
@@ -179,20 +155,15 @@ irc_message_parse (struct t_irc_server *server, const char *message,
         pos = strchr (ptr_message, ' ');
         if (pos)
         {
-            if (command)
-                *command = weechat_strndup (ptr_message, pos - ptr_message);
-            if (pos_command)
-                *pos_command = ptr_message - message;
+            view->pos_command = ptr_message - message;
+            view->length_command = pos - ptr_message;
             pos++;
             while (pos[0] == ' ')
             {
                 pos++;
             }
             /* now we have: pos --> "#weechat :hello!" */
-            if (arguments)
-                *arguments = strdup (pos);
-            if (pos_arguments)
-                *pos_arguments = pos - message;
+            view->pos_arguments = pos - message;
             if ((pos[0] == ':')
                 && ((strncmp (ptr_message, "JOIN ", 5) == 0)
                     || (strncmp (ptr_message, "PART ", 5) == 0)))
@@ -201,10 +172,7 @@ irc_message_parse (struct t_irc_server *server, const char *message,
             }
             if (pos[0] == ':')
             {
-                if (text)
-                    *text = strdup (pos + 1);
-                if (pos_text)
-                    *pos_text = pos - message + 1;
+                view->pos_text = pos - message + 1;
             }
             else
             {
@@ -212,15 +180,9 @@ irc_message_parse (struct t_irc_server *server, const char *message,
                 {
                     ptr_channel_found = pos;
                     pos2 = strchr (pos, ' ');
-                    if (channel)
-                    {
-                        if (pos2)
-                            *channel = weechat_strndup (pos, pos2 - pos);
-                        else
-                            *channel = strdup (pos);
-                    }
-                    if (pos_channel)
-                        *pos_channel = pos - message;
+                    view->pos_channel = pos - message;
+                    view->length_channel = (pos2) ?
+                        pos2 - pos : (int)strlen (pos);
                     if (pos2)
                     {
                         while (pos2[0] == ' ')
@@ -229,21 +191,17 @@ irc_message_parse (struct t_irc_server *server, const char *message,
                         }
                         if (pos2[0] == ':')
                             pos2++;
-                        if (text)
-                            *text = strdup (pos2);
-                        if (pos_text)
-                            *pos_text = pos2 - message;
+                        view->pos_text = pos2 - message;
                     }
                 }
                 else
                 {
                     pos2 = strchr (pos, ' ');
-                    if (nick && !*nick)
+                    if (view->pos_nick < 0)
                     {
-                        if (pos2)
-                            *nick = weechat_strndup (pos, pos2 - pos);
-                        else
-                            *nick = strdup (pos);
+                        view->pos_nick = pos - message;
+                        view->length_nick = (pos2) ?
+                            pos2 - pos : (int)strlen (pos);
                     }
                     if (pos2)
                     {
@@ -257,15 +215,9 @@ irc_message_parse (struct t_irc_server *server, const char *message,
                         {
                             ptr_channel_found = pos2;
                             pos4 = strchr (pos2, ' ');
-                            if (channel)
-                            {
-                                if (pos4)
-                                    *channel = weechat_strndup (pos2, pos4 - pos2);
-                                else
-                                    *channel = strdup (pos2);
-                            }
-                            if (pos_channel)
-                                *pos_channel = pos2 - message;
+                            view->pos_channel = pos2 - message;
+                            view->length_channel = (pos4) ?
+                                pos4 - pos2 : (int)strlen (pos2);
                             if (pos4)
                             {
                                 while (pos4[0] == ' ')
@@ -274,10 +226,7 @@ irc_message_parse (struct t_irc_server *server, const char *message,
                                 }
                                 if (pos4[0] == ':')
                                     pos4++;
-                                if (text)
-                                    *text = strdup (pos4);
-                                if (pos_text)
-                                    *pos_text = pos4 - message;
+                                view->pos_text = pos4 - message;
                             }
                         }
                         else
@@ -286,17 +235,12 @@ irc_message_parse (struct t_irc_server *server, const char *message,
                             {
                                 if (pos[0] == ':')
                                     pos++;
-                                if (text)
-                                    *text = strdup (pos);
-                                if (pos_text)
-                                    *pos_text = pos - message;
+                                view->pos_text = pos - message;
                             }
                             else
                             {
-                                if (channel)
-                                    *channel = weechat_strndup (pos, pos3 - pos);
-                                if (pos_channel)
-                                    *pos_channel = pos - message;
+                                view->pos_channel = pos - message;
+                                view->length_channel = pos3 - pos;
                                 pos4 = strchr (pos3, ' ');
                                 if (pos4)
                                 {
@@ -306,10 +250,7 @@ irc_message_parse (struct t_irc_server *server, const char *message,
                                     }
                                     if (pos4[0] == ':')
                                         pos4++;
-                                    if (text)
-                                        *text = strdup (pos4);
-                                    if (pos_text)
-                                        *pos_text = pos4 - message;
+                                    view->pos_text = pos4 - message;
                                 }
                             }
                         }
@@ -319,14 +260,143 @@ irc_message_parse (struct t_irc_server *server, const char *message,
         }
         else
         {
-            if (command)
-                *command = strdup (ptr_message);
-            if (pos_command)
-                *pos_command = ptr_message - message;
+            view->pos_command = ptr_message - message;
+            view->length_command = strlen (ptr_message);
         }
     }
 }
 
+/*
+ * Gets a part of an IRC message (position and length returned by
+ * irc_message_parse_view) as a string.
+ *
+ * The part is copied in "buffer" if it fits in (size of buffer is
+ * "buffer_size"), otherwise it is allocated and "*allocated" is set to the
+ * new string (it must be freed after use).
+ *
+ * Returns pointer to string, NULL if the part is not in message.
+ */
+
+const char *
+irc_message_view_get (const char *message, int pos, int length,
+                      char *buffer, int buffer_size, char **allocated)
+{
+    *allocated = NULL;
+
+    if (!message || (pos < 0))
+        return NULL;
+
+    if (length < buffer_size)
+    {
+        memcpy (buffer, message + pos, length);
+        buffer[length] = '\0';
+        return buffer;
+    }
+
+    *allocated = weechat_strndup (message + pos, length);
+    return *allocated;
+}
+
+/*
+ * Parses an IRC message and returns:
+ *   - tags (string)
+ *   - message without tags (string)
+ *   - nick (string)
+ *   - host (string)
+ *   - command (string)
+ *   - channel (string)
+ *   - arguments (string)
+ *   - text (string)
+ *   - pos_command (integer: command index in message)
+ *   - pos_arguments (integer: arguments index in message)
+ *   - pos_channel (integer: channel index in message)
+ *   - pos_text (integer: text index in message)
+ *
+ * Strings are allocated (they must be freed after use); to parse without
+ * any allocation, the function irc_message_parse_view can be used.
+ *
+ * Example:
+ *   @time=2015-06-27T16:40:35.000Z :nick!user@host PRIVMSG #weechat :hello!
+ *
+ * Result:
+ *               tags: "time=2015-06-27T16:40:35.000Z"
+ *   msg_without_tags: ":nick!user@host PRIVMSG #weechat :hello!"
+ *               nick: "nick"
+ *               host: "nick!user@host"
+ *            command: "PRIVMSG"
+ *            channel: "#weechat"
+ *          arguments: "#weechat :hello!"
+ *               text: "hello!"
+ *        pos_command: 47
+ *      pos_arguments: 55
+ *        pos_channel: 55
+ *           pos_text: 65
+ */
+
+void
+irc_message_parse (struct t_irc_server *server, const char *message,
+                   char **tags, char **message_without_tags, char **nick,
+                   char **host, char **command, char **channel,
+                   char **arguments, char **text,
+                   int *pos_command, int *pos_arguments, int *pos_channel,
+                   int *pos_text)
+{
+    struct t_irc_message_view view;
+
+    irc_message_parse_view (server, message, &view);
+
+    if (tags)
+    {
+        *tags = (view.pos_tags >= 0) ?
+            weechat_strndup (message + view.pos_tags, view.length_tags) : NULL;
+    }
+    if (message_without_tags)
+    {
+        *message_without_tags = (view.pos_message_without_tags >= 0) ?
+            strdup (message + view.pos_message_without_tags) : NULL;
+    }
+    if (nick)
+    {
+        *nick = (view.pos_nick >= 0) ?
+            weechat_strndup (message + view.pos_nick, view.length_nick) : NULL;
+    }
+    if (host)
+    {
+        *host = (view.pos_host >= 0) ?
+            weechat_strndup (message + view.pos_host, view.length_host) : NULL;
+    }
+    if (command)
+    {
+        *command = (view.pos_command >= 0) ?
+            weechat_strndup (message + view.pos_command,
+                             view.length_command) : NULL;
+    }
+    if (channel)
+    {
+        *channel = (view.pos_channel >= 0) ?
+            weechat_strndup (message + view.pos_channel,
+                             view.length_channel) : NULL;
+    }
+    if (arguments)
+    {
+        *arguments = (view.pos_arguments >= 0) ?
+            strdup (message + view.pos_arguments) : NULL;
+    }
+    if (text)
+    {
+        *text = (view.pos_text >= 0) ?
+            strdup (message + view.pos_text) : NULL;
+    }
+    if (pos_command)
+        *pos_command = view.pos_command;
+    if (pos_arguments)
+        *pos_arguments = view.pos_arguments;
+    if (pos_channel)
+        *pos_channel = view.pos_channel;
+    if (pos_text)
+        *pos_text = view.pos_text;
+}
+
 /*
  * Parses an IRC message and returns hashtable with keys:
  *   - tags
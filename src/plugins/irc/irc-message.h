@@ -23,6 +23,31 @@
 struct t_irc_server;
 struct t_irc_channel;
 
+/* position (index in message) and length of each part of an IRC message */
+
+struct t_irc_message_view
+{
+    int pos_tags;                   /* tags (without '@')                    */
+    int length_tags;
+    int pos_message_without_tags;   /* message without tags (until the end)  */
+    int pos_nick;                   /* nick                                  */
+    int length_nick;
+    int pos_host;                   /* host (nick!user@host)                 */
+    int length_host;
+    int pos_command;                /* command                               */
+    int length_command;
+    int pos_channel;                /* channel                               */
+    int length_channel;
+    int pos_arguments;              /* arguments (until the end)             */
+    int pos_text;                   /* text (until the end)                  */
+};
+
+extern void irc_message_parse_view (struct t_irc_server *server,
+                                    const char *message,
+                                    struct t_irc_message_view *view);
+extern const char *irc_message_view_get (const char *message, int pos,
+                                         int length, char *buffer,
+                                         int buffer_size, char **allocated);
 extern void irc_message_parse (struct t_irc_server *server, const char *message,
                                char **tags, char **message_without_tags,
                                char **nick, char **host, char **command,
@@ -461,7 +461,14 @@ irc_nick_new (struct t_irc_server *server, struct t_irc_channel *channel,
         return NULL;
 
     if (!channel->nicks)
+    {
         irc_channel_add_nicklist_groups (server, channel);
+        if (!channel->nicks_hashtable)
+        {
+            channel->nicks_hashtable = irc_server_hashtable_casemapping_new (
+                server->casemapping, 32);
+        }
+    }
 
     /* nick already exists on this channel? */
     ptr_nick = irc_nick_search (server, channel, nickname);
@@ -537,6 +544,9 @@ irc_nick_new (struct t_irc_server *server, struct t_irc_channel *channel,
 
     channel->nicks_count++;
 
+    if (channel->nicks_hashtable)
+        weechat_hashtable_set (channel->nicks_hashtable, new_nick->name, new_nick);
+
     channel->nick_completion_reset = 1;
 
     /* add nick to buffer nicklist */
@@ -565,9 +575,17 @@ irc_nick_change (struct t_irc_server *server, struct t_irc_channel *channel,
         irc_channel_nick_speaking_rename (channel, nick->name, new_nick);
 
     /* change nickname */
+    if (channel->nicks_hashtable && nick->name
+        && (weechat_hashtable_get (channel->nicks_hashtable,
+                                   nick->name) == nick))
+    {
+        weechat_hashtable_remove (channel->nicks_hashtable, nick->name);
+    }
     if (nick->name)
         free (nick->name);
     nick->name = strdup (new_nick);
+    if (channel->nicks_hashtable && nick->name)
+        weechat_hashtable_set (channel->nicks_hashtable, nick->name, nick);
     if (nick->color)
         free (nick->color);
     if (nick_is_me)
@@ -640,6 +658,13 @@ irc_nick_free (struct t_irc_server *server, struct t_irc_channel *channel,
 
     channel->nicks_count--;
 
+    if (channel->nicks_hashtable && nick->name
+        && (weechat_hashtable_get (channel->nicks_hashtable,
+                                   nick->name) == nick))
+    {
+        weechat_hashtable_remove (channel->nicks_hashtable, nick->name);
+    }
+
     /* free data */
     if (nick->name)
         free (nick->name);
@@ -681,6 +706,9 @@ irc_nick_free_all (struct t_irc_server *server, struct t_irc_channel *channel)
 
     /* should be zero, but prevent any bug :D */
     channel->nicks_count = 0;
+
+    /* nicklist is empty, no more nicks expected from NAMES/WHO */
+    irc_channel_nicklist_bulk_end (channel);
 }
 
 /*
@@ -698,6 +726,9 @@ irc_nick_search (struct t_irc_server *server, struct t_irc_channel *channel,
     if (!channel || !nickname)
         return NULL;
 
+    if (channel->nicks_hashtable)
+        return weechat_hashtable_get (channel->nicks_hashtable, nickname);
+
     for (ptr_nick = channel->nicks; ptr_nick;
          ptr_nick = ptr_nick->next_nick)
     {
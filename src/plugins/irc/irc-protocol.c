@@ -57,6 +57,10 @@
 #include "irc-notify.h"
 
 
+struct t_hashtable *irc_protocol_messages_index = NULL; /* msg name -> msg  */
+int irc_protocol_numeric_index[IRC_PROTOCOL_NUMERIC_MAX]; /* number -> msg */
+
+
 /*
  * Checks if a command is numeric.
  *
@@ -1271,8 +1275,20 @@ IRC_PROTOCOL_CALLBACK(nick)
                 if ((irc_server_strcasecmp (server, ptr_channel->name, nick) == 0)
                     && !irc_channel_search (server, new_nick))
                 {
+                    if (server->channels_hashtable
+                        && (weechat_hashtable_get (server->channels_hashtable,
+                                                   ptr_channel->name) == ptr_channel))
+                    {
+                        weechat_hashtable_remove (server->channels_hashtable,
+                                                  ptr_channel->name);
+                    }
                     free (ptr_channel->name);
                     ptr_channel->name = strdup (new_nick);
+                    if (server->channels_hashtable && ptr_channel->name)
+                    {
+                        weechat_hashtable_set (server->channels_hashtable,
+                                               ptr_channel->name, ptr_channel);
+                    }
                     if (ptr_channel->pv_remote_nick_color)
                     {
                         free (ptr_channel->pv_remote_nick_color);
@@ -2589,7 +2605,7 @@ IRC_PROTOCOL_CALLBACK(005)
             pos2[0] = '\0';
         casemapping = irc_server_search_casemapping (pos);
         if (casemapping >= 0)
-            server->casemapping = casemapping;
+            irc_server_set_casemapping (server, casemapping);
         if (pos2)
             pos2[0] = ' ';
     }
@@ -3042,6 +3058,9 @@ IRC_PROTOCOL_CALLBACK(315)
 
     IRC_PROTOCOL_MIN_ARGS(5);
 
+    /* end of WHO: nicklist of channels can be sorted and refreshed */
+    irc_channel_nicklist_bulk_end_all (server);
+
     ptr_channel = irc_channel_search (server, argv[3]);
     if (ptr_channel && (ptr_channel->checking_whox > 0))
     {
@@ -4199,9 +4218,14 @@ IRC_PROTOCOL_CALLBACK(352)
             snprintf (ptr_nick->host, length, "%s@%s", argv[4], argv[5]);
     }
 
-    /* update away flag in nick */
+    /*
+     * update away flag in nick (during WHO sent for the channel, nicklist is
+     * refreshed on end of WHO)
+     */
     if (ptr_channel && ptr_nick && pos_attr)
     {
+        if (ptr_channel->checking_whox > 0)
+            irc_channel_nicklist_bulk_start (ptr_channel);
         irc_nick_set_away (server, ptr_channel, ptr_nick,
                            (pos_attr[0] == 'G') ? 1 : 0);
     }
@@ -4279,6 +4303,17 @@ IRC_PROTOCOL_CALLBACK(353)
     ptr_channel = irc_channel_search (server, pos_channel);
     str_nicks = NULL;
 
+    /*
+     * when joining the channel (end of names not yet received), nicks are
+     * added in bulk mode: nicklist is sorted and refreshed only on end of
+     * names (message 366)
+     */
+    if (ptr_channel && ptr_channel->nicks
+        && !weechat_hashtable_has_key (ptr_channel->join_msg_received, "366"))
+    {
+        irc_channel_nicklist_bulk_start (ptr_channel);
+    }
+
     /*
      * for a channel without buffer, prepare a string that will be built
      * with nicks and colors (argc - args is the number of nicks)
@@ -4434,9 +4469,14 @@ IRC_PROTOCOL_CALLBACK(354)
             snprintf (ptr_nick->host, length, "%s@%s", argv[4], argv[5]);
     }
 
-    /* update away flag in nick */
+    /*
+     * update away flag in nick (during WHO sent for the channel, nicklist is
+     * refreshed on end of WHO)
+     */
     if (ptr_channel && ptr_nick)
     {
+        if (ptr_channel->checking_whox > 0)
+            irc_channel_nicklist_bulk_start (ptr_channel);
         if (pos_attr
             && (server->cap_away_notify
                 || ((IRC_SERVER_OPTION_INTEGER(
@@ -4531,6 +4571,10 @@ IRC_PROTOCOL_CALLBACK(366)
     IRC_PROTOCOL_MIN_ARGS(5);
 
     ptr_channel = irc_channel_search (server, argv[3]);
+
+    /* end of names: sort and refresh nicklist */
+    irc_channel_nicklist_bulk_end (ptr_channel);
+
     if (ptr_channel && ptr_channel->nicks)
     {
         /* display users on channel */
@@ -5613,6 +5657,84 @@ irc_protocol_get_message_tag_time (struct t_hashtable *tags)
     return time_value;
 }
 
+/*
+ * Builds index of IRC messages: messages with 3 digits are indexed by their
+ * number in array "irc_protocol_numeric_index", other messages are added in
+ * hashtable "irc_protocol_messages_index" (case insensitive).
+ */
+
+void
+irc_protocol_build_index (struct t_irc_protocol_msg *messages)
+{
+    int i;
+
+    irc_protocol_messages_index = irc_server_hashtable_casemapping_new (
+        IRC_SERVER_CASEMAPPING_ASCII, 64);
+    if (!irc_protocol_messages_index)
+        return;
+
+    for (i = 0; i < IRC_PROTOCOL_NUMERIC_MAX; i++)
+    {
+        irc_protocol_numeric_index[i] = -1;
+    }
+
+    for (i = 0; messages[i].name; i++)
+    {
+        if ((strlen (messages[i].name) == 3)
+            && irc_protocol_is_numeric_command (messages[i].name))
+        {
+            irc_protocol_numeric_index[atoi (messages[i].name)] = i;
+        }
+        else
+        {
+            weechat_hashtable_set (irc_protocol_messages_index,
+                                   messages[i].name, &messages[i]);
+        }
+    }
+}
+
+/*
+ * Searches for an IRC message (by command) in array of messages.
+ *
+ * Returns index of message in array, -1 if not found.
+ */
+
+int
+irc_protocol_search_message (struct t_irc_protocol_msg *messages,
+                             const char *command)
+{
+    struct t_irc_protocol_msg *ptr_msg;
+    int i;
+
+    if (!irc_protocol_messages_index)
+        irc_protocol_build_index (messages);
+
+    if (irc_protocol_messages_index)
+    {
+        if (isdigit ((unsigned char)command[0])
+            && isdigit ((unsigned char)command[1])
+            && isdigit ((unsigned char)command[2])
+            && !command[3])
+        {
+            return irc_protocol_numeric_index[((command[0] - '0') * 100)
+                                              + ((command[1] - '0') * 10)
+                                              + (command[2] - '0')];
+        }
+        ptr_msg = weechat_hashtable_get (irc_protocol_messages_index,
+                                         command);
+        return (ptr_msg) ? ptr_msg - messages : -1;
+    }
+
+    /* no index (not enough memory?), search in the whole array */
+    for (i = 0; messages[i].name; i++)
+    {
+        if (weechat_strcasecmp (messages[i].name, command) == 0)
+            return i;
+    }
+
+    return -1;
+}
+
 /*
  * Executes action when an IRC message is received.
  *
@@ -5626,7 +5748,7 @@ irc_protocol_recv_command (struct t_irc_server *server,
                            const char *msg_command,
                            const char *msg_channel)
 {
-    int i, cmd_found, return_code, argc, decode_color, keep_trailing_spaces;
+    int cmd_found, return_code, argc, decode_color, keep_trailing_spaces;
     int message_ignored;
     char *dup_irc_message, *pos_space;
     struct t_irc_channel *ptr_channel;
@@ -5637,7 +5759,7 @@ irc_protocol_recv_command (struct t_irc_server *server,
     char *nick, *address, *address_color, *host, *host_no_color, *host_color;
     char **argv, **argv_eol;
     struct t_hashtable *hash_tags;
-    struct t_irc_protocol_msg irc_protocol_messages[] =
+    static struct t_irc_protocol_msg irc_protocol_messages[] =
         { { "account", /* account (cap account-notify) */ 1, 0, &irc_protocol_cb_account },
           { "authenticate", /* authenticate */ 1, 0, &irc_protocol_cb_authenticate },
           { "away", /* away (cap away-notify) */ 1, 0, &irc_protocol_cb_away },
@@ -5859,16 +5981,8 @@ irc_protocol_recv_command (struct t_irc_server *server,
     }
 
     /* look for IRC command */
-    cmd_found = -1;
-    for (i = 0; irc_protocol_messages[i].name; i++)
-    {
-        if (weechat_strcasecmp (irc_protocol_messages[i].name,
-                                msg_command) == 0)
-        {
-            cmd_found = i;
-            break;
-        }
-    }
+    cmd_found = irc_protocol_search_message (irc_protocol_messages,
+                                             msg_command);
 
     /* command not found */
     if (cmd_found < 0)
@@ -5974,3 +6088,17 @@ end:
     if (hash_tags)
         weechat_hashtable_free (hash_tags);
 }
+
+/*
+ * Frees index of IRC messages.
+ */
+
+void
+irc_protocol_end ()
+{
+    if (irc_protocol_messages_index)
+    {
+        weechat_hashtable_free (irc_protocol_messages_index);
+        irc_protocol_messages_index = NULL;
+    }
+}
@@ -73,6 +73,9 @@ typedef int (t_irc_recv_func)(struct t_irc_server *server,
                               int ignored,
                               int argc, char **argv, char **argv_eol);
 
+/* numeric messages (3 digits) are indexed by their number */
+#define IRC_PROTOCOL_NUMERIC_MAX 1000
+
 struct t_irc_protocol_msg
 {
     char *name;                     /* IRC message name                      */
@@ -88,5 +91,6 @@ extern void irc_protocol_recv_command (struct t_irc_server *server,
                                        const char *msg_tags,
                                        const char *msg_command,
                                        const char *msg_channel);
+extern void irc_protocol_end ();
 
 #endif /* WEECHAT_IRC_PROTOCOL_H */
@@ -67,9 +67,12 @@
 
 struct t_irc_server *irc_servers = NULL;
 struct t_irc_server *last_irc_server = NULL;
+struct t_hashtable *irc_servers_hashtable = NULL; /* servers by name        */
 
-struct t_irc_message *irc_recv_msgq = NULL;
-struct t_irc_message *irc_msgq_last_msg = NULL;
+struct t_irc_message *irc_recv_msgq = NULL; /* received msgs (ring)       */
+int irc_recv_msgq_size = 0;                 /* number of slots in ring     */
+int irc_recv_msgq_first = 0;                /* index of first message      */
+int irc_recv_msgq_count = 0;                /* number of queued messages   */
 
 char *irc_server_sasl_fail_string[IRC_SERVER_NUM_SASL_FAIL] =
 { "continue", "reconnect", "disconnect" };
@@ -182,6 +185,13 @@ irc_server_search (const char *server_name)
     if (!server_name)
         return NULL;
 
+    if (irc_servers_hashtable)
+    {
+        ptr_server = weechat_hashtable_get (irc_servers_hashtable, server_name);
+        return (ptr_server && (strcmp (ptr_server->name, server_name) == 0)) ?
+            ptr_server : NULL;
+    }
+
     for (ptr_server = irc_servers; ptr_server;
          ptr_server = ptr_server->next_server)
     {
@@ -207,6 +217,9 @@ irc_server_casesearch (const char *server_name)
     if (!server_name)
         return NULL;
 
+    if (irc_servers_hashtable)
+        return weechat_hashtable_get (irc_servers_hashtable, server_name);
+
     for (ptr_server = irc_servers; ptr_server;
          ptr_server = ptr_server->next_server)
     {
@@ -333,6 +346,179 @@ irc_server_strncasecmp (struct t_irc_server *server,
     return rc;
 }
 
+/*
+ * Hashes a string using a casemapping range (see function
+ * weechat_strcasecmp_range): chars in range are converted to lower case
+ * before computing the hash (DJB2), so that strings which are equal with
+ * the casemapping have the same hash.
+ */
+
+unsigned long long
+irc_server_hash_key_range (const char *string, int range)
+{
+    unsigned long long hash;
+    int c;
+
+    hash = 5381;
+    while (string[0])
+    {
+        c = (unsigned char)string[0];
+        if ((c >= 'A') && (c < 'A' + range))
+            c += ('a' - 'A');
+        hash = ((hash << 5) + hash) + c;
+        string++;
+    }
+
+    return hash;
+}
+
+/*
+ * Callbacks used to hash and compare keys in hashtables indexed by nick or
+ * channel name (one hash/compare couple for each casemapping).
+ */
+
+unsigned long long
+irc_server_hash_key_rfc1459_cb (struct t_hashtable *hashtable,
+                                const void *key)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    return irc_server_hash_key_range ((const char *)key, 30);
+}
+
+int
+irc_server_keycmp_rfc1459_cb (struct t_hashtable *hashtable,
+                              const void *key1, const void *key2)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    return weechat_strcasecmp_range ((const char *)key1,
+                                     (const char *)key2, 30);
+}
+
+unsigned long long
+irc_server_hash_key_strict_rfc1459_cb (struct t_hashtable *hashtable,
+                                       const void *key)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    return irc_server_hash_key_range ((const char *)key, 29);
+}
+
+int
+irc_server_keycmp_strict_rfc1459_cb (struct t_hashtable *hashtable,
+                                     const void *key1, const void *key2)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    return weechat_strcasecmp_range ((const char *)key1,
+                                     (const char *)key2, 29);
+}
+
+unsigned long long
+irc_server_hash_key_ascii_cb (struct t_hashtable *hashtable, const void *key)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    return irc_server_hash_key_range ((const char *)key, 26);
+}
+
+int
+irc_server_keycmp_ascii_cb (struct t_hashtable *hashtable,
+                            const void *key1, const void *key2)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+
+    return weechat_strcasecmp ((const char *)key1, (const char *)key2);
+}
+
+/*
+ * Creates a hashtable with keys compared using a casemapping (keys are
+ * strings, values are pointers).
+ *
+ * Returns pointer to new hashtable, NULL if error.
+ */
+
+struct t_hashtable *
+irc_server_hashtable_casemapping_new (int casemapping, int size)
+{
+    switch (casemapping)
+    {
+        case IRC_SERVER_CASEMAPPING_STRICT_RFC1459:
+            return weechat_hashtable_new (
+                size,
+                WEECHAT_HASHTABLE_STRING,
+                WEECHAT_HASHTABLE_POINTER,
+                &irc_server_hash_key_strict_rfc1459_cb,
+                &irc_server_keycmp_strict_rfc1459_cb);
+        case IRC_SERVER_CASEMAPPING_ASCII:
+            return weechat_hashtable_new (
+                size,
+                WEECHAT_HASHTABLE_STRING,
+                WEECHAT_HASHTABLE_POINTER,
+                &irc_server_hash_key_ascii_cb,
+                &irc_server_keycmp_ascii_cb);
+        default:
+            return weechat_hashtable_new (
+                size,
+                WEECHAT_HASHTABLE_STRING,
+                WEECHAT_HASHTABLE_POINTER,
+                &irc_server_hash_key_rfc1459_cb,
+                &irc_server_keycmp_rfc1459_cb);
+    }
+}
+
+/*
+ * Sets casemapping for server.
+ *
+ * Hashtables indexed by channel name in server and by nick in channels are
+ * built again, because the hash and comparison of keys depend on the
+ * casemapping.
+ */
+
+void
+irc_server_set_casemapping (struct t_irc_server *server, int casemapping)
+{
+    struct t_irc_channel *ptr_channel;
+
+    if (!server || (casemapping < 0)
+        || (casemapping >= IRC_SERVER_NUM_CASEMAPPING)
+        || (casemapping == server->casemapping))
+    {
+        return;
+    }
+
+    server->casemapping = casemapping;
+
+    if (server->channels_hashtable)
+    {
+        weechat_hashtable_free (server->channels_hashtable);
+        server->channels_hashtable = irc_server_hashtable_casemapping_new (
+            server->casemapping, 32);
+        if (server->channels_hashtable)
+        {
+            for (ptr_channel = server->channels; ptr_channel;
+                 ptr_channel = ptr_channel->next_channel)
+            {
+                weechat_hashtable_set (server->channels_hashtable,
+                                       ptr_channel->name, ptr_channel);
+            }
+        }
+    }
+
+    for (ptr_channel = server->channels; ptr_channel;
+         ptr_channel = ptr_channel->next_channel)
+    {
+        irc_channel_rebuild_nicks_hashtable (server, ptr_channel);
+    }
+}
+
 /*
  * Checks if SASL is enabled on server.
  *
@@ -986,6 +1172,16 @@ irc_server_alloc (const char *name)
 
     /* set name */
     new_server->name = strdup (name);
+    if (!irc_servers_hashtable)
+    {
+        irc_servers_hashtable = irc_server_hashtable_casemapping_new (
+            IRC_SERVER_CASEMAPPING_ASCII, 32);
+    }
+    if (irc_servers_hashtable && new_server->name)
+    {
+        weechat_hashtable_set (irc_servers_hashtable,
+                               new_server->name, new_server);
+    }
 
     /* internal vars */
     new_server->temp_server = 0;
@@ -1075,6 +1271,7 @@ irc_server_alloc (const char *name)
     new_server->buffer_as_string = NULL;
     new_server->channels = NULL;
     new_server->last_channel = NULL;
+    new_server->channels_hashtable = NULL;
 
     /* create options with null value */
     for (i = 0; i < IRC_SERVER_NUM_OPTIONS; i++)
@@ -1482,6 +1679,8 @@ irc_server_free_data (struct t_irc_server *server)
     irc_channel_free_all (server);
 
     /* free hashtables */
+    if (server->channels_hashtable)
+        weechat_hashtable_free (server->channels_hashtable);
     weechat_hashtable_free (server->join_manual);
     weechat_hashtable_free (server->join_channel_key);
     weechat_hashtable_free (server->join_noswitch);
@@ -1575,9 +1774,22 @@ irc_server_free (struct t_irc_server *server)
     if (server->next_server)
         (server->next_server)->prev_server = server->prev_server;
 
+    if (irc_servers_hashtable && server->name
+        && (weechat_hashtable_get (irc_servers_hashtable,
+                                   server->name) == server))
+    {
+        weechat_hashtable_remove (irc_servers_hashtable, server->name);
+    }
+
     irc_server_free_data (server);
     free (server);
     irc_servers = new_irc_servers;
+
+    if (!irc_servers && irc_servers_hashtable)
+    {
+        weechat_hashtable_free (irc_servers_hashtable);
+        irc_servers_hashtable = NULL;
+    }
 }
 
 /*
@@ -1592,6 +1804,8 @@ irc_server_free_all ()
     {
         irc_server_free (irc_servers);
     }
+
+    irc_server_msgq_free ();
 }
 
 /*
@@ -1715,9 +1929,13 @@ irc_server_rename (struct t_irc_server *server, const char *new_name)
     }
 
     /* rename server */
+    if (irc_servers_hashtable && server->name)
+        weechat_hashtable_remove (irc_servers_hashtable, server->name);
     if (server->name)
         free (server->name);
     server->name = strdup (new_name);
+    if (irc_servers_hashtable && server->name)
+        weechat_hashtable_set (irc_servers_hashtable, server->name, server);
 
     /* change name and local variables on buffers */
     for (ptr_channel = server->channels; ptr_channel;
@@ -2390,25 +2608,48 @@ irc_server_sendf (struct t_irc_server *server, int flags, const char *tags,
 
 /*
  * Adds a message to received messages queue (at the end).
+ *
+ * The message is not copied: it must remain valid until the queue is flushed
+ * (only a message joined with an unterminated message is allocated).
  */
 
 void
 irc_server_msgq_add_msg (struct t_irc_server *server, const char *msg)
 {
-    struct t_irc_message *message;
+    struct t_irc_message *new_msgq, *message;
+    int new_size, i;
 
     if (!server->unterminated_message && !msg[0])
         return;
 
-    message = malloc (sizeof (*message));
-    if (!message)
+    /* grow the ring if it is full (messages are moved to the beginning) */
+    if (irc_recv_msgq_count >= irc_recv_msgq_size)
     {
-        weechat_printf (server->buffer,
-                        _("%s%s: not enough memory for received message"),
-                        weechat_prefix ("error"), IRC_PLUGIN_NAME);
-        return;
+        new_size = (irc_recv_msgq_size > 0) ? irc_recv_msgq_size * 2 : 256;
+        new_msgq = malloc (new_size * sizeof (*new_msgq));
+        if (!new_msgq)
+        {
+            weechat_printf (server->buffer,
+                            _("%s%s: not enough memory for received message"),
+                            weechat_prefix ("error"), IRC_PLUGIN_NAME);
+            return;
+        }
+        for (i = 0; i < irc_recv_msgq_count; i++)
+        {
+            new_msgq[i] = irc_recv_msgq[(irc_recv_msgq_first + i)
+                                        % irc_recv_msgq_size];
+        }
+        if (irc_recv_msgq)
+            free (irc_recv_msgq);
+        irc_recv_msgq = new_msgq;
+        irc_recv_msgq_size = new_size;
+        irc_recv_msgq_first = 0;
     }
+
+    message = &irc_recv_msgq[(irc_recv_msgq_first + irc_recv_msgq_count)
+                             % irc_recv_msgq_size];
     message->server = server;
+    message->allocated = 0;
     if (server->unterminated_message)
     {
         message->data = malloc (strlen (server->unterminated_message) +
@@ -2423,25 +2664,41 @@ irc_server_msgq_add_msg (struct t_irc_server *server, const char *msg)
         {
             strcpy (message->data, server->unterminated_message);
             strcat (message->data, msg);
+            message->allocated = 1;
         }
         free (server->unterminated_message);
         server->unterminated_message = NULL;
     }
     else
-        message->data = strdup (msg);
+        message->data = (char *)msg;
 
-    message->next_message = NULL;
+    irc_recv_msgq_count++;
+}
 
-    if (irc_msgq_last_msg)
+/*
+ * Frees the received messages queue.
+ */
+
+void
+irc_server_msgq_free ()
+{
+    struct t_irc_message *message;
+
+    while (irc_recv_msgq_count > 0)
     {
-        irc_msgq_last_msg->next_message = message;
-        irc_msgq_last_msg = message;
+        message = &irc_recv_msgq[irc_recv_msgq_first];
+        if (message->allocated)
+            free (message->data);
+        irc_recv_msgq_first = (irc_recv_msgq_first + 1) % irc_recv_msgq_size;
+        irc_recv_msgq_count--;
     }
-    else
+    if (irc_recv_msgq)
     {
-        irc_recv_msgq = message;
-        irc_msgq_last_msg = message;
+        free (irc_recv_msgq);
+        irc_recv_msgq = NULL;
     }
+    irc_recv_msgq_size = 0;
+    irc_recv_msgq_first = 0;
 }
 
 /*
@@ -2487,41 +2744,62 @@ irc_server_msgq_add_unterminated (struct t_irc_server *server,
     }
 }
 
+/*
+ * Removes all CR chars in a string (in place).
+ */
+
+void
+irc_server_msgq_remove_cr (char *string)
+{
+    char *ptr_src, *ptr_dst;
+
+    ptr_dst = strchr (string, '\r');
+    if (!ptr_dst)
+        return;
+
+    for (ptr_src = ptr_dst; ptr_src[0]; ptr_src++)
+    {
+        if (ptr_src[0] != '\r')
+        {
+            ptr_dst[0] = ptr_src[0];
+            ptr_dst++;
+        }
+    }
+    ptr_dst[0] = '\0';
+}
+
 /*
  * Splits received buffer, creating queued messages.
+ *
+ * The buffer is split in place (CR chars are ignored, LF terminates a
+ * message): queued messages point to the buffer, so it must not be changed
+ * or freed before the queue is flushed.
  */
 
 void
-irc_server_msgq_add_buffer (struct t_irc_server *server, const char *buffer)
+irc_server_msgq_add_buffer (struct t_irc_server *server, char *buffer)
 {
-    char *pos_cr, *pos_lf;
+    char *ptr_buffer, *pos_lf;
+
+    ptr_buffer = buffer;
 
-    while (buffer[0])
+    while (ptr_buffer[0])
     {
-        pos_cr = strchr (buffer, '\r');
-        pos_lf = strchr (buffer, '\n');
+        pos_lf = strchr (ptr_buffer, '\n');
+        if (pos_lf)
+            pos_lf[0] = '\0';
 
-        if (!pos_cr && !pos_lf)
+        irc_server_msgq_remove_cr (ptr_buffer);
+
+        if (!pos_lf)
         {
-            /* no CR/LF found => add to unterminated and return */
-            irc_server_msgq_add_unterminated (server, buffer);
+            /* no LF found => add to unterminated and return */
+            irc_server_msgq_add_unterminated (server, ptr_buffer);
             return;
         }
 
-        if (pos_cr && ((!pos_lf) || (pos_lf > pos_cr)))
-        {
-            /* found '\r' first => ignore this char */
-            pos_cr[0] = '\0';
-            irc_server_msgq_add_unterminated (server, buffer);
-            buffer = pos_cr + 1;
-        }
-        else
-        {
-            /* found: '\n' first => terminate message */
-            pos_lf[0] = '\0';
-            irc_server_msgq_add_msg (server, buffer);
-            buffer = pos_lf + 1;
-        }
+        irc_server_msgq_add_msg (server, ptr_buffer);
+        ptr_buffer = pos_lf + 1;
     }
 }
 
@@ -2532,21 +2810,32 @@ irc_server_msgq_add_buffer (struct t_irc_server *server, const char *buffer)
 void
 irc_server_msgq_flush ()
 {
-    struct t_irc_message *next;
+    struct t_irc_message message;
+    struct t_irc_message_view view;
     char *ptr_data, *new_msg, *new_msg2, *ptr_msg, *ptr_msg2, *ptr_msg3, *pos;
-    char *tags, *nick, *host, *command, *channel, *arguments;
+    char *alloc_tags, *alloc_command, *alloc_channel, *command_redirect;
+    const char *tags, *command, *channel;
     char *msg_decoded, *msg_decoded_without_color;
     char str_modifier[128], modifier_data[256];
-    int pos_channel, pos_text, pos_decode;
+    char str_tags[1024], str_command[128], str_channel[256];
+    int pos_decode;
 
-    while (irc_recv_msgq)
+    while (irc_recv_msgq_count > 0)
     {
-        if (irc_recv_msgq->data)
+        /*
+         * remove message from queue before processing it: the queue can be
+         * changed by callbacks (for example with /server fakerecv)
+         */
+        message = irc_recv_msgq[irc_recv_msgq_first];
+        irc_recv_msgq_first = (irc_recv_msgq_first + 1) % irc_recv_msgq_size;
+        irc_recv_msgq_count--;
+
+        if (message.data)
         {
             /* read message only if connection was not lost */
-            if (irc_recv_msgq->server->sock != -1)
+            if (message.server->sock != -1)
             {
-                ptr_data = irc_recv_msgq->data;
+                ptr_data = message.data;
                 while (ptr_data[0] == ' ')
                 {
                     ptr_data++;
@@ -2554,22 +2843,27 @@ irc_server_msgq_flush ()
 
                 if (ptr_data[0])
                 {
-                    irc_raw_print (irc_recv_msgq->server, IRC_RAW_FLAG_RECV,
+                    irc_raw_print (message.server, IRC_RAW_FLAG_RECV,
                                    ptr_data);
 
-                    irc_message_parse (irc_recv_msgq->server,
-                                       ptr_data, NULL, NULL, NULL, NULL,
-                                       &command, NULL, NULL, NULL, NULL, NULL,
-                                       NULL, NULL);
-                    snprintf (str_modifier, sizeof (str_modifier),
-                              "irc_in_%s",
-                              (command) ? command : "unknown");
+                    irc_message_parse_view (message.server,
+                                            ptr_data, &view);
+                    if (view.pos_command >= 0)
+                    {
+                        snprintf (str_modifier, sizeof (str_modifier),
+                                  "irc_in_%.*s",
+                                  view.length_command,
+                                  ptr_data + view.pos_command);
+                    }
+                    else
+                    {
+                        snprintf (str_modifier, sizeof (str_modifier),
+                                  "irc_in_unknown");
+                    }
                     new_msg = weechat_hook_modifier_exec (
                         str_modifier,
-                        irc_recv_msgq->server->name,
+                        message.server->name,
                         ptr_data);
-                    if (command)
-                        free (command);
 
                     /* no changes in new message */
                     if (new_msg && (strcmp (ptr_data, new_msg) == 0))
@@ -2593,45 +2887,55 @@ irc_server_msgq_flush ()
                             if (new_msg)
                             {
                                 irc_raw_print (
-                                    irc_recv_msgq->server,
+                                    message.server,
                                     IRC_RAW_FLAG_RECV | IRC_RAW_FLAG_MODIFIED,
                                     ptr_msg);
                             }
 
-                            irc_message_parse (irc_recv_msgq->server, ptr_msg,
-                                               &tags, NULL, &nick, &host,
-                                               &command, &channel, &arguments,
-                                               NULL, NULL, NULL,
-                                               &pos_channel, &pos_text);
+                            /*
+                             * parse message without allocation: parts of
+                             * message are read with their position/length
+                             * in ptr_msg (which is kept until the end of
+                             * loop)
+                             */
+                            irc_message_parse_view (message.server,
+                                                    ptr_msg, &view);
 
                             msg_decoded = NULL;
                             if (weechat_config_boolean (irc_config_network_channel_encode))
-                                pos_decode = (pos_channel >= 0) ? pos_channel : pos_text;
+                                pos_decode = (view.pos_channel >= 0) ? view.pos_channel : view.pos_text;
                             else
-                                pos_decode = pos_text;
+                                pos_decode = view.pos_text;
                             if (pos_decode >= 0)
                             {
                                 /* convert charset for message */
-                                if (channel
-                                    && irc_channel_is_channel (irc_recv_msgq->server,
-                                                               channel))
+                                if ((view.pos_channel >= 0)
+                                    && irc_channel_is_channel (message.server,
+                                                               ptr_msg + view.pos_channel))
                                 {
                                     snprintf (modifier_data, sizeof (modifier_data),
-                                              "%s.%s.%s",
+                                              "%s.%s.%.*s",
                                               weechat_plugin->name,
-                                              irc_recv_msgq->server->name,
-                                              channel);
+                                              message.server->name,
+                                              view.length_channel,
+                                              ptr_msg + view.pos_channel);
                                 }
                                 else
                                 {
-                                    if (nick && (!host || (strcmp (nick, host) != 0)))
+                                    if ((view.pos_nick >= 0)
+                                        && ((view.pos_host < 0)
+                                            || (view.length_nick != view.length_host)
+                                            || (strncmp (ptr_msg + view.pos_nick,
+                                                         ptr_msg + view.pos_host,
+                                                         view.length_nick) != 0)))
                                     {
                                         snprintf (modifier_data,
                                                   sizeof (modifier_data),
-                                                  "%s.%s.%s",
+                                                  "%s.%s.%.*s",
                                                   weechat_plugin->name,
-                                                  irc_recv_msgq->server->name,
-                                                  nick);
+                                                  message.server->name,
+                                                  view.length_nick,
+                                                  ptr_msg + view.pos_nick);
                                     }
                                     else
                                     {
@@ -2639,7 +2943,7 @@ irc_server_msgq_flush ()
                                                   sizeof (modifier_data),
                                                   "%s.%s",
                                                   weechat_plugin->name,
-                                                  irc_recv_msgq->server->name);
+                                                  message.server->name);
                                     }
                                 }
                                 msg_decoded = irc_message_convert_charset (
@@ -2656,12 +2960,21 @@ irc_server_msgq_flush ()
                             /* call modifier after charset */
                             ptr_msg2 = (msg_decoded_without_color) ?
                                 msg_decoded_without_color : ((msg_decoded) ? msg_decoded : ptr_msg);
-                            snprintf (str_modifier, sizeof (str_modifier),
-                                      "irc_in2_%s",
-                                      (command) ? command : "unknown");
+                            if (view.pos_command >= 0)
+                            {
+                                snprintf (str_modifier, sizeof (str_modifier),
+                                          "irc_in2_%.*s",
+                                          view.length_command,
+                                          ptr_msg + view.pos_command);
+                            }
+                            else
+                            {
+                                snprintf (str_modifier, sizeof (str_modifier),
+                                          "irc_in2_unknown");
+                            }
                             new_msg2 = weechat_hook_modifier_exec (
                                 str_modifier,
-                                irc_recv_msgq->server->name,
+                                message.server->name,
                                 ptr_msg2);
                             if (new_msg2 && (strcmp (ptr_msg2, new_msg2) == 0))
                             {
@@ -2676,10 +2989,23 @@ irc_server_msgq_flush ()
                                 if (new_msg2)
                                     ptr_msg2 = new_msg2;
 
+                                /*
+                                 * command is allocated for redirection only
+                                 * if there are redirects on server
+                                 */
+                                command_redirect =
+                                    (message.server->redirects
+                                     && (view.pos_command >= 0)) ?
+                                    weechat_strndup (ptr_msg + view.pos_command,
+                                                     view.length_command) : NULL;
+
                                 /* parse and execute command */
-                                if (irc_redirect_message (irc_recv_msgq->server,
-                                                          ptr_msg2, command,
-                                                          arguments))
+                                if (command_redirect
+                                    && irc_redirect_message (
+                                        message.server,
+                                        ptr_msg2, command_redirect,
+                                        (view.pos_arguments >= 0) ?
+                                        ptr_msg + view.pos_arguments : NULL))
                                 {
                                     /* message redirected, we'll not display it! */
                                 }
@@ -2701,27 +3027,40 @@ irc_server_msgq_flush ()
                                         else
                                             ptr_msg3 = ptr_msg2;
                                     }
+                                    tags = irc_message_view_get (
+                                        ptr_msg, view.pos_tags,
+                                        view.length_tags,
+                                        str_tags, sizeof (str_tags),
+                                        &alloc_tags);
+                                    command = irc_message_view_get (
+                                        ptr_msg, view.pos_command,
+                                        view.length_command,
+                                        str_command, sizeof (str_command),
+                                        &alloc_command);
+                                    channel = irc_message_view_get (
+                                        ptr_msg, view.pos_channel,
+                                        view.length_channel,
+                                        str_channel, sizeof (str_channel),
+                                        &alloc_channel);
                                     irc_protocol_recv_command (
-                                        irc_recv_msgq->server,
+                                        message.server,
                                         ptr_msg3,
                                         tags,
                                         command,
                                         channel);
+                                    if (alloc_tags)
+                                        free (alloc_tags);
+                                    if (alloc_command)
+                                        free (alloc_command);
+                                    if (alloc_channel)
+                                        free (alloc_channel);
                                 }
+                                if (command_redirect)
+                                    free (command_redirect);
                             }
 
                             if (new_msg2)
                                 free (new_msg2);
-                            if (nick)
-                                free (nick);
-                            if (host)
-                                free (host);
-                            if (command)
-                                free (command);
-                            if (channel)
-                                free (channel);
-                            if (arguments)
-                                free (arguments);
                             if (msg_decoded)
                                 free (msg_decoded);
                             if (msg_decoded_without_color)
@@ -2738,7 +3077,7 @@ irc_server_msgq_flush ()
                     }
                     else
                     {
-                        irc_raw_print (irc_recv_msgq->server,
+                        irc_raw_print (message.server,
                                        IRC_RAW_FLAG_RECV | IRC_RAW_FLAG_MODIFIED,
                                        _("(message dropped)"));
                     }
@@ -2746,14 +3085,9 @@ irc_server_msgq_flush ()
                         free (new_msg);
                 }
             }
-            free (irc_recv_msgq->data);
+            if (message.allocated)
+                free (message.data);
         }
-
-        next = irc_recv_msgq->next_message;
-        free (irc_recv_msgq);
-        irc_recv_msgq = next;
-        if (!irc_recv_msgq)
-            irc_msgq_last_msg = NULL;
     }
 }
 
@@ -2765,7 +3099,8 @@ int
 irc_server_recv_cb (const void *pointer, void *data, int fd)
 {
     struct t_irc_server *server;
-    static char buffer[4096 + 2];
+    static char buffer[IRC_SERVER_RECV_BUFFER_SIZE + 1];
+    char *ptr_buffer;
     int num_read, msgq_flush, end_recv;
 
     /* make C compiler happy */
@@ -2779,22 +3114,31 @@ irc_server_recv_cb (const void *pointer, void *data, int fd)
     msgq_flush = 0;
     end_recv = 0;
 
+    /*
+     * data received is split in place: queued messages point to the buffer,
+     * so each read is done after the previous one (and not over it)
+     */
+    ptr_buffer = buffer;
+
     while (!end_recv)
     {
         end_recv = 1;
 
 #ifdef HAVE_GNUTLS
         if (server->ssl_connected)
-            num_read = gnutls_record_recv (server->gnutls_sess, buffer,
-                                           sizeof (buffer) - 2);
+            num_read = gnutls_record_recv (
+                server->gnutls_sess, ptr_buffer,
+                sizeof (buffer) - (ptr_buffer - buffer) - 1);
         else
 #endif /* HAVE_GNUTLS */
-            num_read = recv (server->sock, buffer, sizeof (buffer) - 2, 0);
+            num_read = recv (server->sock, ptr_buffer,
+                             sizeof (buffer) - (ptr_buffer - buffer) - 1, 0);
 
         if (num_read > 0)
         {
-            buffer[num_read] = '\0';
-            irc_server_msgq_add_buffer (server, buffer);
+            ptr_buffer[num_read] = '\0';
+            irc_server_msgq_add_buffer (server, ptr_buffer);
+            ptr_buffer += num_read + 1;
             msgq_flush = 1;  /* the flush will be done after the loop */
 #ifdef HAVE_GNUTLS
             if (server->ssl_connected
@@ -2802,9 +3146,19 @@ irc_server_recv_cb (const void *pointer, void *data, int fd)
             {
                 /*
                  * if there are unread data in the gnutls buffers,
-                 * go on with recv
+                 * go on with recv (if the buffer is almost full, the queue
+                 * is flushed first so that the buffer can be reused)
                  */
-                end_recv = 0;
+                if (sizeof (buffer) - (ptr_buffer - buffer)
+                    < IRC_SERVER_RECV_MIN_FREE)
+                {
+                    irc_server_msgq_flush ();
+                    msgq_flush = 0;
+                    if (!irc_server_valid (server))
+                        return WEECHAT_RC_OK;
+                    ptr_buffer = buffer;
+                }
+                end_recv = (server->ssl_connected) ? 0 : 1;
             }
 #endif /* HAVE_GNUTLS */
         }
@@ -5959,6 +6313,7 @@ irc_server_print_log ()
         weechat_log_printf ("  buffer_as_string . . : 0x%lx", ptr_server->buffer_as_string);
         weechat_log_printf ("  channels . . . . . . : 0x%lx", ptr_server->channels);
         weechat_log_printf ("  last_channel . . . . : 0x%lx", ptr_server->last_channel);
+        weechat_log_printf ("  channels_hashtable . : 0x%lx", ptr_server->channels_hashtable);
         weechat_log_printf ("  prev_server. . . . . : 0x%lx", ptr_server->prev_server);
         weechat_log_printf ("  next_server. . . . . : 0x%lx", ptr_server->next_server);
 
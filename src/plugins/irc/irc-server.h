@@ -111,6 +111,11 @@ enum t_irc_server_option
 #define IRC_SERVER_DEFAULT_PORT_SSL 6697
 #define IRC_SERVER_DEFAULT_NICKS    "weechat1,weechat2,weechat3,weechat4,weechat5"
 
+/* size of buffer used to receive data from server */
+#define IRC_SERVER_RECV_BUFFER_SIZE (64 * 1024)
+/* min free space in buffer to go on with next read (TLS) */
+#define IRC_SERVER_RECV_MIN_FREE    (16 * 1024 + 1)
+
 /* number of queues for sending messages */
 #define IRC_SERVER_NUM_OUTQUEUES_PRIO 2
 
@@ -231,6 +236,7 @@ struct t_irc_server
     char *buffer_as_string;               /* used to return buffer info      */
     struct t_irc_channel *channels;       /* opened channels on server       */
     struct t_irc_channel *last_channel;   /* last opened channel on server   */
+    struct t_hashtable *channels_hashtable; /* channels indexed by name      */
     struct t_irc_server *prev_server;     /* link to previous server         */
     struct t_irc_server *next_server;     /* link to next server             */
 };
@@ -241,7 +247,8 @@ struct t_irc_message
 {
     struct t_irc_server *server;        /* server pointer for received msg   */
     char *data;                         /* message content                   */
-    struct t_irc_message *next_message; /* link to next message              */
+    int allocated;                      /* 1 if data was allocated, 0 if it  */
+                                        /* points to the receive buffer      */
 };
 
 /* digest algorithms for fingerprint */
@@ -262,7 +269,8 @@ extern struct t_irc_server *irc_servers;
 extern const int gnutls_cert_type_prio[];
 extern const int gnutls_prot_prio[];
 #endif /* HAVE_GNUTLS */
-extern struct t_irc_message *irc_recv_msgq, *irc_msgq_last_msg;
+extern struct t_irc_message *irc_recv_msgq;
+extern int irc_recv_msgq_size, irc_recv_msgq_first, irc_recv_msgq_count;
 extern char *irc_server_sasl_fail_string[];
 extern char *irc_server_options[][2];
 
@@ -276,6 +284,10 @@ extern int irc_server_strcasecmp (struct t_irc_server *server,
 extern int irc_server_strncasecmp (struct t_irc_server *server,
                                    const char *string1, const char *string2,
                                    int max);
+extern struct t_hashtable *irc_server_hashtable_casemapping_new (int casemapping,
+                                                                int size);
+extern void irc_server_set_casemapping (struct t_irc_server *server,
+                                        int casemapping);
 extern int irc_server_sasl_enabled (struct t_irc_server *server);
 extern char *irc_server_get_name_without_port (const char *name);
 extern void irc_server_set_addresses (struct t_irc_server *server,
@@ -319,8 +331,9 @@ extern struct t_hashtable *irc_server_sendf (struct t_irc_server *server,
                                              const char *tags,
                                              const char *format, ...);
 extern void irc_server_msgq_add_buffer (struct t_irc_server *server,
-                                        const char *buffer);
+                                        char *buffer);
 extern void irc_server_msgq_flush ();
+extern void irc_server_msgq_free ();
 extern void irc_server_set_buffer_title (struct t_irc_server *server);
 extern struct t_gui_buffer *irc_server_create_buffer (struct t_irc_server *server);
 #ifdef HAVE_GNUTLS
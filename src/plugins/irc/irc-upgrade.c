@@ -267,6 +267,7 @@ irc_upgrade_set_buffer_callbacks ()
                                                    "localvar_server"));
                     weechat_buffer_set_pointer (ptr_buffer, "nickcmp_callback",
                                                 &irc_buffer_nickcmp_cb);
+                    weechat_buffer_set (ptr_buffer, "nickcmp_index", "1");
                     if (ptr_server)
                     {
                         weechat_buffer_set_pointer (ptr_buffer,
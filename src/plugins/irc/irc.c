@@ -302,6 +302,8 @@ weechat_plugin_end (struct t_weechat_plugin *plugin)
 
     irc_redirect_end ();
 
+    irc_protocol_end ();
+
     irc_color_end ();
 
     return WEECHAT_RC_OK;
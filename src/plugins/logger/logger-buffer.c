@@ -30,6 +30,7 @@
 #include "../weechat-plugin.h"
 #include "logger.h"
 #include "logger-buffer.h"
+#include "logger-index.h"
 
 
 struct t_logger_buffer *logger_buffers = NULL;
@@ -91,6 +92,9 @@ logger_buffer_add (struct t_gui_buffer *buffer, int log_level)
         new_logger_buffer->buffer = buffer;
         new_logger_buffer->log_filename = NULL;
         new_logger_buffer->log_file = NULL;
+        new_logger_buffer->log_file_buffer = NULL;
+        new_logger_buffer->log_file_size = 0;
+        new_logger_buffer->index_block = NULL;
         new_logger_buffer->log_enabled = 1;
         new_logger_buffer->log_level = log_level;
         new_logger_buffer->write_start_info_line = 1;
@@ -158,6 +162,62 @@ logger_buffer_search_log_filename (const char *log_filename)
     return NULL;
 }
 
+/*
+ * Sets a buffer for writes in log file (lines are written in file by
+ * blocks of LOGGER_BUFFER_FILE_BUFFER_SIZE bytes, or when file is flushed).
+ *
+ * This function must be called just after opening the log file.
+ */
+
+void
+logger_buffer_set_file_buffer (struct t_logger_buffer *logger_buffer)
+{
+    if (!logger_buffer || !logger_buffer->log_file
+        || logger_buffer->log_file_buffer)
+        return;
+
+    logger_buffer->log_file_buffer = malloc (LOGGER_BUFFER_FILE_BUFFER_SIZE);
+    if (!logger_buffer->log_file_buffer)
+        return;
+
+    if (setvbuf (logger_buffer->log_file, logger_buffer->log_file_buffer,
+                 _IOFBF, LOGGER_BUFFER_FILE_BUFFER_SIZE) != 0)
+    {
+        free (logger_buffer->log_file_buffer);
+        logger_buffer->log_file_buffer = NULL;
+    }
+}
+
+/*
+ * Closes log file of a logger buffer (data not yet written is flushed).
+ */
+
+void
+logger_buffer_close_file (struct t_logger_buffer *logger_buffer)
+{
+    if (!logger_buffer)
+        return;
+
+    if (logger_buffer->log_file)
+    {
+        fclose (logger_buffer->log_file);
+        logger_buffer->log_file = NULL;
+    }
+    if (logger_buffer->index_block)
+    {
+        logger_index_write_block (logger_buffer);
+        free (logger_buffer->index_block);
+        logger_buffer->index_block = NULL;
+    }
+    if (logger_buffer->log_file_buffer)
+    {
+        free (logger_buffer->log_file_buffer);
+        logger_buffer->log_file_buffer = NULL;
+    }
+    logger_buffer->log_file_size = 0;
+    logger_buffer->flush_needed = 0;
+}
+
 /*
  * Removes a logger buffer from list.
  */
@@ -187,8 +247,7 @@ logger_buffer_free (struct t_logger_buffer *logger_buffer)
     /* free data */
     if (logger_buffer->log_filename)
         free (logger_buffer->log_filename);
-    if (logger_buffer->log_file)
-        fclose (logger_buffer->log_file);
+    logger_buffer_close_file (logger_buffer);
 
     free (logger_buffer);
 
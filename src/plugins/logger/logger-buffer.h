@@ -20,13 +20,19 @@
 #ifndef WEECHAT_LOGGER_BUFFER_H
 #define WEECHAT_LOGGER_BUFFER_H 1
 
+#define LOGGER_BUFFER_FILE_BUFFER_SIZE (16 * 1024)
+
 struct t_infolist;
+struct t_logger_index_block;
 
 struct t_logger_buffer
 {
     struct t_gui_buffer *buffer;          /* pointer to buffer              */
     char *log_filename;                   /* log filename                   */
     FILE *log_file;                       /* log file                       */
+    char *log_file_buffer;                /* buffer for writes in log file  */
+    long long log_file_size;              /* size of log file (bytes)       */
+    struct t_logger_index_block *index_block; /* current block of index     */
     int log_enabled;                      /* log enabled ?                  */
     int log_level;                        /* log level (0..9)               */
     int write_start_info_line;            /* 1 if start info line must be   */
@@ -44,6 +50,8 @@ extern struct t_logger_buffer *logger_buffer_add (struct t_gui_buffer *,
                                                   int log_level);
 extern struct t_logger_buffer *logger_buffer_search_buffer (struct t_gui_buffer *buffer);
 extern struct t_logger_buffer *logger_buffer_search_log_filename (const char *log_filename);
+extern void logger_buffer_set_file_buffer (struct t_logger_buffer *logger_buffer);
+extern void logger_buffer_close_file (struct t_logger_buffer *logger_buffer);
 extern void logger_buffer_free (struct t_logger_buffer *logger_buffer);
 extern int logger_buffer_add_to_infolist (struct t_infolist *infolist,
                                           struct t_logger_buffer *logger_buffer);
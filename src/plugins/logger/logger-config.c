@@ -21,6 +21,7 @@
 
 #include <stdlib.h>
 #include <limits.h>
+#include <errno.h>
 
 #include "../weechat-plugin.h"
 #include "logger.h"
@@ -46,6 +47,8 @@ struct t_config_option *logger_config_color_backlog_line;
 
 struct t_config_option *logger_config_file_auto_log;
 struct t_config_option *logger_config_file_flush_delay;
+struct t_config_option *logger_config_file_fsync;
+struct t_config_option *logger_config_file_index;
 struct t_config_option *logger_config_file_info_lines;
 struct t_config_option *logger_config_file_mask;
 struct t_config_option *logger_config_file_name_lower_case;
@@ -53,8 +56,14 @@ struct t_config_option *logger_config_file_nick_prefix;
 struct t_config_option *logger_config_file_nick_suffix;
 struct t_config_option *logger_config_file_path;
 struct t_config_option *logger_config_file_replacement_char;
+struct t_config_option *logger_config_file_rotation_compression_level;
+struct t_config_option *logger_config_file_rotation_compression_type;
+struct t_config_option *logger_config_file_rotation_files_max;
+struct t_config_option *logger_config_file_rotation_size_max;
 struct t_config_option *logger_config_file_time_format;
 
+long long logger_config_rotation_size_max = 0; /* max size of log files   */
+
 
 /*
  * Callback for changes on option that require a restart of logging for all
@@ -118,6 +127,120 @@ logger_config_flush_delay_change (const void *pointer, void *data,
     }
 }
 
+/*
+ * Parses a size with an optional unit: "b" (bytes, default), "k" (kilobytes),
+ * "m" (megabytes), "g" (gigabytes) or "t" (terabytes), case is ignored.
+ *
+ * Returns the size in bytes, -1 if the size is invalid.
+ */
+
+long long
+logger_config_parse_size (const char *size)
+{
+    char *error;
+    long long number, multiplier;
+
+    if (!size || !size[0])
+        return -1;
+
+    error = NULL;
+    errno = 0;
+    number = strtoll (size, &error, 10);
+    if (!error || (error == size) || (errno == ERANGE) || (number < 0))
+        return -1;
+
+    switch (error[0])
+    {
+        case '\0':
+        case 'b':
+        case 'B':
+            multiplier = 1LL;
+            break;
+        case 'k':
+        case 'K':
+            multiplier = 1024LL;
+            break;
+        case 'm':
+        case 'M':
+            multiplier = 1024LL * 1024LL;
+            break;
+        case 'g':
+        case 'G':
+            multiplier = 1024LL * 1024LL * 1024LL;
+            break;
+        case 't':
+        case 'T':
+            multiplier = 1024LL * 1024LL * 1024LL * 1024LL;
+            break;
+        default:
+            return -1;
+    }
+    if (error[0] && error[1])
+        return -1;
+
+    /* size too big */
+    if (number > LLONG_MAX / multiplier)
+        return -1;
+
+    return number * multiplier;
+}
+
+/*
+ * Checks value of option "logger.file.rotation_size_max".
+ *
+ * Returns:
+ *   1: value is valid
+ *   0: value is invalid
+ */
+
+int
+logger_config_rotation_size_max_check (const void *pointer, void *data,
+                                       struct t_config_option *option,
+                                       const char *value)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) option;
+
+    return (logger_config_parse_size (value) >= 0) ? 1 : 0;
+}
+
+/*
+ * Callback for changes on option "logger.file.rotation_size_max".
+ */
+
+void
+logger_config_rotation_size_max_change (const void *pointer, void *data,
+                                        struct t_config_option *option)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) option;
+
+    logger_config_rotation_size_max = logger_config_parse_size (
+        weechat_config_string (logger_config_file_rotation_size_max));
+    if (logger_config_rotation_size_max < 0)
+        logger_config_rotation_size_max = 0;
+}
+
+/*
+ * Callback for changes on option "logger.file.time_format".
+ */
+
+void
+logger_config_time_format_change (const void *pointer, void *data,
+                                  struct t_config_option *option)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) option;
+
+    logger_time_string_reset ();
+}
+
 /*
  * Callback for changes on a level option.
  */
@@ -455,6 +578,26 @@ logger_config_init ()
         NULL, NULL, NULL,
         &logger_config_flush_delay_change, NULL, NULL,
         NULL, NULL, NULL);
+    logger_config_file_fsync = weechat_config_new_option (
+        logger_config_file, ptr_section,
+        "fsync", "boolean",
+        N_("use fsync to synchronize the log file with the storage device "
+           "after the flush (see man fsync); this is slower but should "
+           "prevent any data loss in case of power failure during the save "
+           "of log file"),
+        NULL, 0, 0, "off", NULL, 0,
+        NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+    logger_config_file_index = weechat_config_new_option (
+        logger_config_file, ptr_section,
+        "index", "boolean",
+        N_("build an index of words for each log file (file with same name "
+           "and extension \".idx\", renamed with the log file on rotation), "
+           "to speed up the search of words in log files with command "
+           "\"/logger search\"; the index size is about 1/8 of log file "
+           "size; note: rotated log files which are compressed are not "
+           "searched"),
+        NULL, 0, 0, "off", NULL, 0,
+        NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
     logger_config_file_info_lines = weechat_config_new_option (
         logger_config_file, ptr_section,
         "info_lines", "boolean",
@@ -516,13 +659,60 @@ logger_config_init ()
         NULL, NULL, NULL,
         &logger_config_change_file_option_restart_log, NULL, NULL,
         NULL, NULL, NULL);
+    logger_config_file_rotation_compression_level = weechat_config_new_option (
+        logger_config_file, ptr_section,
+        "rotation_compression_level", "integer",
+        N_("compression level for rotated log files (with extension \".1\", "
+           "\".2\", etc.), if option logger.file.rotation_compression_type "
+           "is enabled: 1 = low compression / fast ... 100 = best "
+           "compression / slow; the value is a percentage converted to "
+           "1-9 for gzip"),
+        NULL, 1, 100, "20", NULL, 0,
+        NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+    logger_config_file_rotation_compression_type = weechat_config_new_option (
+        logger_config_file, ptr_section,
+        "rotation_compression_type", "integer",
+        N_("compression type for rotated log files; if set to \"none\", "
+           "rotated log files are not compressed; the compression is done "
+           "in a child process, and compressed files have extension \".gz\" "
+           "(they are read by the backlog like other log files)"),
+        "none|gzip", 0, 0, "none", NULL, 0,
+        NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+    logger_config_file_rotation_files_max = weechat_config_new_option (
+        logger_config_file, ptr_section,
+        "rotation_files_max", "integer",
+        N_("maximum number of rotated log files kept (with extension \".1\", "
+           "\".2\", etc.): on rotation, the oldest rotated log files above "
+           "this number are deleted (with their index); 0 = unlimited "
+           "(rotated log files are never deleted, this is the default)"),
+        NULL, 0, INT_MAX, "0", NULL, 0,
+        NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+    logger_config_file_rotation_size_max = weechat_config_new_option (
+        logger_config_file, ptr_section,
+        "rotation_size_max", "string",
+        N_("when this size is reached, a rotation of log files is performed: "
+           "the existing rotated log files are renamed (.1 becomes .2, .2 "
+           "becomes .3, etc.) and the current file is renamed with extension "
+           ".1; an integer number with a suffix is allowed: b = bytes "
+           "(default if no unit given), k = kilobytes, m = megabytes, "
+           "g = gigabytes, t = terabytes; example: \"2g\" causes a rotation "
+           "when the file size reaches 2,147,483,648 bytes; if set to "
+           "\"0\", no rotation is performed (unlimited log size); "
+           "time-based rotation can be done with date specifiers in option "
+           "logger.file.mask"),
+        NULL, 0, 0, "0", NULL, 0,
+        &logger_config_rotation_size_max_check, NULL, NULL,
+        &logger_config_rotation_size_max_change, NULL, NULL,
+        NULL, NULL, NULL);
     logger_config_file_time_format = weechat_config_new_option (
         logger_config_file, ptr_section,
         "time_format", "string",
         N_("timestamp used in log files (see man strftime for date/time "
            "specifiers)"),
         NULL, 0, 0, "%Y-%m-%d %H:%M:%S", NULL, 0,
-        NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+        NULL, NULL, NULL,
+        &logger_config_time_format_change, NULL, NULL,
+        NULL, NULL, NULL);
 
     /* level */
     ptr_section = weechat_config_new_section (
@@ -575,6 +765,7 @@ logger_config_read ()
     logger_config_loading = 0;
 
     logger_config_flush_delay_change (NULL, NULL, NULL);
+    logger_config_rotation_size_max_change (NULL, NULL, NULL);
 
     return rc;
 }
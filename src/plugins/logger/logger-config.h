@@ -22,6 +22,13 @@
 
 #define LOGGER_CONFIG_NAME "logger"
 
+enum t_logger_config_compression_type
+{
+    LOGGER_CONFIG_COMPRESSION_TYPE_NONE = 0,
+    LOGGER_CONFIG_COMPRESSION_TYPE_GZIP,
+    /* number of compression types */
+    LOGGER_CONFIG_NUM_COMPRESSION_TYPES,
+};
 
 extern struct t_config_option *logger_config_look_backlog;
 
@@ -30,6 +37,8 @@ extern struct t_config_option *logger_config_color_backlog_line;
 
 extern struct t_config_option *logger_config_file_auto_log;
 extern struct t_config_option *logger_config_file_flush_delay;
+extern struct t_config_option *logger_config_file_fsync;
+extern struct t_config_option *logger_config_file_index;
 extern struct t_config_option *logger_config_file_info_lines;
 extern struct t_config_option *logger_config_file_mask;
 extern struct t_config_option *logger_config_file_name_lower_case;
@@ -37,8 +46,15 @@ extern struct t_config_option *logger_config_file_nick_prefix;
 extern struct t_config_option *logger_config_file_nick_suffix;
 extern struct t_config_option *logger_config_file_path;
 extern struct t_config_option *logger_config_file_replacement_char;
+extern struct t_config_option *logger_config_file_rotation_compression_level;
+extern struct t_config_option *logger_config_file_rotation_compression_type;
+extern struct t_config_option *logger_config_file_rotation_files_max;
+extern struct t_config_option *logger_config_file_rotation_size_max;
 extern struct t_config_option *logger_config_file_time_format;
 
+extern long long logger_config_rotation_size_max;
+
+extern long long logger_config_parse_size (const char *size);
 extern struct t_config_option *logger_config_get_level (const char *name);
 extern int logger_config_set_level (const char *name, const char *value);
 extern struct t_config_option *logger_config_get_mask (const char *name);
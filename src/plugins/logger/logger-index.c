@@ -0,0 +1,815 @@
+/*
+ * logger-index.c - index of words in log files, search in log files
+ *
+ * Copyright (C) 2003-2016 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The index of a log file is a file with same name and extension ".idx",
+ * which contains a header (struct t_logger_index_header, with the device and
+ * inode of log file) followed by blocks (struct t_logger_index_block).  Each block has a bloom filter with the
+ * words of lines written in a part of the log file (about
+ * LOGGER_INDEX_BLOCK_SIZE bytes), so that a search reads only the parts of
+ * log file which may contain all words searched.
+ *
+ * The parts of log file which are not in the index (lines written when the
+ * index was disabled, or last lines not yet in a block) are always read, and
+ * the whole log file is read if the index was built for another file.
+ *
+ * On rotation, the index is renamed with the log file ("file.1.idx", ...),
+ * and it is removed when the rotated log file is compressed.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <string.h>
+
+#include "../weechat-plugin.h"
+#include "logger.h"
+#include "logger-index.h"
+#include "logger-buffer.h"
+#include "logger-tail.h"
+
+
+#define LOGGER_INDEX_LOWER(c) ((((c) >= 'A') && ((c) <= 'Z')) ?         \
+                               (c) + ('a' - 'A') : (c))
+#define LOGGER_INDEX_IS_WORD_CHAR(c)                                    \
+    ((((c) >= 'a') && ((c) <= 'z'))                                     \
+     || (((c) >= 'A') && ((c) <= 'Z'))                                  \
+     || (((c) >= '0') && ((c) <= '9'))                                  \
+     || ((unsigned char)(c) >= 0x80))
+
+struct t_logger_index_query
+{
+    int num_words;                     /* number of words searched          */
+    const char **words;                /* words (pointers in query string)  */
+    int *lengths;                      /* length of words                   */
+    unsigned int *bits;                /* bits of words in bloom filters    */
+};
+
+
+/*
+ * Searches next word in a string (words are made of letters, digits and
+ * non-ASCII chars).
+ *
+ * Returns pointer to the beginning of word (and sets its length), NULL if
+ * there is no more word before "end".
+ */
+
+const char *
+logger_index_next_word (const char *string, const char *end, int *length)
+{
+    const char *ptr_start;
+
+    while ((string < end) && !LOGGER_INDEX_IS_WORD_CHAR(string[0]))
+    {
+        string++;
+    }
+    if (string >= end)
+        return NULL;
+
+    ptr_start = string;
+    while ((string < end) && LOGGER_INDEX_IS_WORD_CHAR(string[0]))
+    {
+        string++;
+    }
+    *length = string - ptr_start;
+
+    return ptr_start;
+}
+
+/*
+ * Returns pointer to the text of a log line which is indexed (text after the
+ * date/time and first tab).
+ */
+
+const char *
+logger_index_line_text (const char *line, const char *end)
+{
+    const char *pos_tab;
+
+    pos_tab = memchr (line, '\t', end - line);
+
+    return (pos_tab) ? pos_tab + 1 : line;
+}
+
+/*
+ * Computes bits of a word in bloom filter (case of ASCII letters is
+ * ignored).
+ */
+
+void
+logger_index_word_bits (const char *word, int length, unsigned int *bits)
+{
+    unsigned long long hash;
+    unsigned int hash1, hash2;
+    int i;
+
+    /* FNV-1a hash */
+    hash = 14695981039346656037ULL;
+    for (i = 0; i < length; i++)
+    {
+        hash ^= (unsigned char)LOGGER_INDEX_LOWER(word[i]);
+        hash *= 1099511628211ULL;
+    }
+
+    hash1 = (unsigned int)hash;
+    hash2 = (unsigned int)(hash >> 32) | 1;
+    for (i = 0; i < LOGGER_INDEX_BLOOM_HASHES; i++)
+    {
+        bits[i] = (hash1 + (i * hash2)) % (LOGGER_INDEX_BLOOM_SIZE * 8);
+    }
+}
+
+/*
+ * Adds words of a line to current block of index.
+ *
+ * Argument "offset" is the offset of line in log file, the line must have
+ * been written in log file (logger_buffer->log_file_size is the offset after
+ * the line).
+ *
+ * The block is written in index file when it covers at least
+ * LOGGER_INDEX_BLOCK_SIZE bytes of log file.
+ */
+
+void
+logger_index_add_line (struct t_logger_buffer *logger_buffer,
+                       const char *line, long long offset)
+{
+    const char *ptr_end, *ptr_word;
+    unsigned int bits[LOGGER_INDEX_BLOOM_HASHES];
+    int i, length;
+
+    if (!logger_buffer->index_block)
+    {
+        logger_buffer->index_block = calloc (
+            1, sizeof (*logger_buffer->index_block));
+        if (!logger_buffer->index_block)
+            return;
+        logger_buffer->index_block->start = offset;
+    }
+    else if (logger_buffer->index_block->end != offset)
+    {
+        /* lines have been written without index: start a new block */
+        logger_index_write_block (logger_buffer);
+        logger_buffer->index_block->start = offset;
+    }
+
+    ptr_end = line + strlen (line);
+    ptr_word = logger_index_line_text (line, ptr_end);
+    while ((ptr_word = logger_index_next_word (ptr_word, ptr_end, &length)))
+    {
+        logger_index_word_bits (ptr_word, length, bits);
+        for (i = 0; i < LOGGER_INDEX_BLOOM_HASHES; i++)
+        {
+            logger_buffer->index_block->bloom[bits[i] / 8] |= 1 << (bits[i] % 8);
+        }
+        ptr_word += length;
+    }
+
+    logger_buffer->index_block->end = logger_buffer->log_file_size;
+
+    if (logger_buffer->index_block->end - logger_buffer->index_block->start
+        >= LOGGER_INDEX_BLOCK_SIZE)
+    {
+        logger_index_write_block (logger_buffer);
+    }
+}
+
+/*
+ * Returns the filename of index for a log file.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+logger_index_filename (const char *log_filename)
+{
+    char *filename;
+    int length;
+
+    length = strlen (log_filename) + strlen (LOGGER_INDEX_EXTENSION) + 1;
+    filename = malloc (length);
+    if (filename)
+        snprintf (filename, length, "%s%s", log_filename, LOGGER_INDEX_EXTENSION);
+
+    return filename;
+}
+
+/*
+ * Initializes header of index for a log file (with its device and inode).
+ */
+
+void
+logger_index_header_init (struct t_logger_index_header *header,
+                          struct stat *st)
+{
+    memset (header, 0, sizeof (*header));
+    memcpy (header->magic, LOGGER_INDEX_MAGIC, LOGGER_INDEX_MAGIC_SIZE);
+    header->device = (unsigned long long)st->st_dev;
+    header->inode = (unsigned long long)st->st_ino;
+}
+
+/*
+ * Reads header of index and checks that it is an index of a log file.
+ *
+ * Returns:
+ *   1: index is valid for this log file
+ *   0: index is invalid or built for another file
+ */
+
+int
+logger_index_header_check (FILE *file_index, struct stat *st)
+{
+    struct t_logger_index_header header, header_log;
+
+    if (fread (&header, sizeof (header), 1, file_index) != 1)
+        return 0;
+
+    logger_index_header_init (&header_log, st);
+
+    return (memcmp (&header, &header_log, sizeof (header)) == 0) ? 1 : 0;
+}
+
+/*
+ * Writes current block of index (if not empty) in index file, and starts a
+ * new block after it.
+ */
+
+void
+logger_index_write_block (struct t_logger_buffer *logger_buffer)
+{
+    struct t_logger_index_block *ptr_block;
+    struct t_logger_index_header header;
+    struct stat st;
+    char *filename;
+    FILE *file;
+
+    ptr_block = logger_buffer->index_block;
+    if (!ptr_block || !logger_buffer->log_filename
+        || (ptr_block->end <= ptr_block->start))
+    {
+        return;
+    }
+
+    filename = logger_index_filename (logger_buffer->log_filename);
+    if (filename)
+    {
+        file = fopen (filename, "ab");
+        if (file)
+        {
+            if (ftell (file) == 0)
+            {
+                if (stat (logger_buffer->log_filename, &st) == 0)
+                {
+                    logger_index_header_init (&header, &st);
+                    fwrite (&header, sizeof (header), 1, file);
+                }
+            }
+            if (ftell (file) > 0)
+                fwrite (ptr_block, sizeof (*ptr_block), 1, file);
+            fclose (file);
+        }
+        free (filename);
+    }
+
+    ptr_block->start = ptr_block->end;
+    memset (ptr_block->bloom, 0, sizeof (ptr_block->bloom));
+}
+
+/*
+ * Removes index of a log file (called when the log file is rotated).
+ */
+
+void
+logger_index_remove (const char *log_filename)
+{
+    char *filename;
+
+    filename = logger_index_filename (log_filename);
+    if (filename)
+    {
+        unlink (filename);
+        free (filename);
+    }
+}
+
+/*
+ * Removes index of a log file if it was not built for this log file (log file
+ * is empty, or has been replaced by another file).
+ *
+ * This function is called when the log file is opened, before new blocks are
+ * added in index.
+ */
+
+void
+logger_index_check (const char *log_filename)
+{
+    char *filename;
+    FILE *file_index;
+    struct stat st;
+    int valid;
+
+    filename = logger_index_filename (log_filename);
+    if (!filename)
+        return;
+
+    file_index = fopen (filename, "rb");
+    if (file_index)
+    {
+        valid = ((stat (log_filename, &st) == 0) && (st.st_size > 0)
+                 && logger_index_header_check (file_index, &st));
+        fclose (file_index);
+        if (!valid)
+            unlink (filename);
+    }
+
+    free (filename);
+}
+
+/*
+ * Builds a query with words of a string.
+ *
+ * Returns pointer to query, NULL if error or no words found.
+ *
+ * Note: result must be freed after use with function
+ * logger_index_query_free().
+ */
+
+struct t_logger_index_query *
+logger_index_query_new (const char *string)
+{
+    struct t_logger_index_query *query;
+    const char *ptr_end, *ptr_word;
+    int length, num_words;
+
+    ptr_end = string + strlen (string);
+    num_words = 0;
+    ptr_word = string;
+    while ((ptr_word = logger_index_next_word (ptr_word, ptr_end, &length)))
+    {
+        num_words++;
+        ptr_word += length;
+    }
+    if (num_words == 0)
+        return NULL;
+
+    query = malloc (sizeof (*query));
+    if (!query)
+        return NULL;
+    query->num_words = 0;
+    query->words = malloc (num_words * sizeof (query->words[0]));
+    query->lengths = malloc (num_words * sizeof (query->lengths[0]));
+    query->bits = malloc (num_words * LOGGER_INDEX_BLOOM_HASHES *
+                          sizeof (query->bits[0]));
+    if (!query->words || !query->lengths || !query->bits)
+    {
+        if (query->words)
+            free (query->words);
+        if (query->lengths)
+            free (query->lengths);
+        if (query->bits)
+            free (query->bits);
+        free (query);
+        return NULL;
+    }
+
+    ptr_word = string;
+    while ((ptr_word = logger_index_next_word (ptr_word, ptr_end, &length)))
+    {
+        query->words[query->num_words] = ptr_word;
+        query->lengths[query->num_words] = length;
+        logger_index_word_bits (
+            ptr_word, length,
+            query->bits + (query->num_words * LOGGER_INDEX_BLOOM_HASHES));
+        query->num_words++;
+        ptr_word += length;
+    }
+
+    return query;
+}
+
+/*
+ * Frees a query.
+ */
+
+void
+logger_index_query_free (struct t_logger_index_query *query)
+{
+    free (query->words);
+    free (query->lengths);
+    free (query->bits);
+    free (query);
+}
+
+/*
+ * Checks if a bloom filter may contain all words of query.
+ *
+ * Returns:
+ *   1: bloom filter may contain all words
+ *   0: at least one word is not in bloom filter
+ */
+
+int
+logger_index_bloom_match (const unsigned char *bloom,
+                          struct t_logger_index_query *query)
+{
+    int i, num_bits;
+    unsigned int bit;
+
+    num_bits = query->num_words * LOGGER_INDEX_BLOOM_HASHES;
+    for (i = 0; i < num_bits; i++)
+    {
+        bit = query->bits[i];
+        if (!(bloom[bit / 8] & (1 << (bit % 8))))
+            return 0;
+    }
+
+    return 1;
+}
+
+/*
+ * Checks if a line contains all words of query (case of ASCII letters is
+ * ignored).
+ *
+ * Returns:
+ *   1: line contains all words
+ *   0: at least one word is not in line
+ */
+
+int
+logger_index_line_match (const char *line, const char *end,
+                         struct t_logger_index_query *query)
+{
+    const char *ptr_text, *ptr_word;
+    int i, j, length, found;
+
+    ptr_text = logger_index_line_text (line, end);
+
+    for (i = 0; i < query->num_words; i++)
+    {
+        found = 0;
+        ptr_word = ptr_text;
+        while ((ptr_word = logger_index_next_word (ptr_word, end, &length)))
+        {
+            if (length == query->lengths[i])
+            {
+                for (j = 0; j < length; j++)
+                {
+                    if (LOGGER_INDEX_LOWER(ptr_word[j])
+                        != LOGGER_INDEX_LOWER(query->words[i][j]))
+                        break;
+                }
+                if (j == length)
+                {
+                    found = 1;
+                    break;
+                }
+            }
+            ptr_word += length;
+        }
+        if (!found)
+            return 0;
+    }
+
+    return 1;
+}
+
+/*
+ * Searches lines matching query in a part of log file, and keeps the last
+ * "max_lines" lines found in array "matches" (used as a ring, "num_found" is
+ * the total number of lines found).
+ *
+ * The part of file is read by chunks with pread in "buffer" (reused between
+ * calls, and grown if a line is longer than buffer). A line longer than
+ * LOGGER_INDEX_READ_SIZE_MAX bytes is skipped.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (read error, file truncated or not enough memory)
+ */
+
+int
+logger_index_search_range (int fd, long long start, long long end,
+                           char **buffer, size_t *buffer_size,
+                           struct t_logger_index_query *query,
+                           char **matches, int max_lines, int *num_found)
+{
+    const char *ptr_line, *ptr_end, *pos_eol;
+    char *new_buffer;
+    long long pos;
+    size_t size;
+    int index, length, skip_line;
+
+    pos = start;
+    skip_line = 0;
+    while (pos < end)
+    {
+        size = ((unsigned long long)(end - pos) < *buffer_size) ?
+            (size_t)(end - pos) : *buffer_size;
+        if (!logger_tail_read (fd, *buffer, size, pos))
+            return 0;
+
+        ptr_line = *buffer;
+        ptr_end = *buffer + size;
+
+        if (skip_line)
+        {
+            /* skip the end of a line too long */
+            pos_eol = memchr (ptr_line, '\n', size);
+            if (!pos_eol)
+            {
+                pos += size;
+                continue;
+            }
+            ptr_line = pos_eol + 1;
+            skip_line = 0;
+        }
+
+        /* search only complete lines, except at the end of range */
+        if (pos + (long long)size < end)
+        {
+            while ((ptr_end > ptr_line) && (ptr_end[-1] != '\n'))
+            {
+                ptr_end--;
+            }
+            if (ptr_end == *buffer)
+            {
+                /* no end-of-line in buffer: grow it, or skip the line */
+                if (*buffer_size >= LOGGER_INDEX_READ_SIZE_MAX)
+                {
+                    pos += size;
+                    skip_line = 1;
+                    continue;
+                }
+                new_buffer = realloc (*buffer, *buffer_size * 2);
+                if (!new_buffer)
+                    return 0;
+                *buffer = new_buffer;
+                *buffer_size *= 2;
+                continue;
+            }
+        }
+
+        while (ptr_line < ptr_end)
+        {
+            pos_eol = memchr (ptr_line, '\n', ptr_end - ptr_line);
+            if (!pos_eol)
+                pos_eol = ptr_end;
+            if ((pos_eol > ptr_line)
+                && logger_index_line_match (ptr_line, pos_eol, query))
+            {
+                index = *num_found % max_lines;
+                length = pos_eol - ptr_line;
+                if (matches[index])
+                    free (matches[index]);
+                matches[index] = malloc (length + 1);
+                if (!matches[index])
+                    return 0;
+                memcpy (matches[index], ptr_line, length);
+                matches[index][length] = '\0';
+                (*num_found)++;
+            }
+            ptr_line = pos_eol + 1;
+        }
+
+        pos += ptr_end - *buffer;
+    }
+
+    return 1;
+}
+
+/*
+ * Searches lines with all words of a string in a log file, using the index
+ * of log file (if found): only the blocks of log file which may contain the
+ * words and the end of file not indexed are read.
+ *
+ * Returns the last lines found (at most "max_lines" lines), NULL if no line
+ * was found.
+ *
+ * Note: result must be freed after use with function logger_tail_free().
+ */
+
+struct t_logger_line *
+logger_index_search_file (const char *log_filename, const char *words,
+                          int max_lines)
+{
+    struct t_logger_index_query *query;
+    struct t_logger_index_block block;
+    struct t_logger_line *lines, *new_line;
+    struct stat st;
+    char *filename_index, *buffer, **matches;
+    size_t buffer_size;
+    int fd, num_found, i, index, rc;
+    long long pos;
+    FILE *file_index;
+
+    if (!log_filename || !words || (max_lines <= 0))
+        return NULL;
+
+    query = logger_index_query_new (words);
+    if (!query)
+        return NULL;
+
+    lines = NULL;
+    buffer = NULL;
+    matches = NULL;
+    file_index = NULL;
+    num_found = 0;
+
+    fd = open (log_filename, O_RDONLY);
+    if (fd == -1)
+        goto end;
+    if ((fstat (fd, &st) != 0) || (st.st_size <= 0))
+        goto end;
+
+    buffer_size = LOGGER_INDEX_READ_SIZE;
+    buffer = malloc (buffer_size);
+    matches = calloc (max_lines, sizeof (matches[0]));
+    if (!buffer || !matches)
+        goto end;
+
+    /* read parts of log file which may contain the words (using index) */
+    rc = 1;
+    pos = 0;
+    filename_index = logger_index_filename (log_filename);
+    if (filename_index)
+    {
+        file_index = fopen (filename_index, "rb");
+        free (filename_index);
+    }
+    if (file_index && logger_index_header_check (file_index, &st))
+    {
+        while (rc && (fread (&block, sizeof (block), 1, file_index) == 1))
+        {
+            if ((block.start < pos) || (block.end <= block.start))
+                continue;
+            if (block.end > st.st_size)
+            {
+                /* index does not match log file (changed?): stop here */
+                break;
+            }
+            /* read part of log file not indexed */
+            if (block.start > pos)
+            {
+                rc = logger_index_search_range (fd, pos, block.start,
+                                                &buffer, &buffer_size,
+                                                query, matches, max_lines,
+                                                &num_found);
+            }
+            if (rc && logger_index_bloom_match (block.bloom, query))
+            {
+                rc = logger_index_search_range (fd, block.start, block.end,
+                                                &buffer, &buffer_size,
+                                                query, matches, max_lines,
+                                                &num_found);
+            }
+            pos = block.end;
+        }
+    }
+
+    /*
+     * read end of log file (not indexed); in case of error (for example
+     * file truncated), the lines already found are returned
+     */
+    if (rc)
+    {
+        logger_index_search_range (fd, pos, st.st_size,
+                                   &buffer, &buffer_size,
+                                   query, matches, max_lines, &num_found);
+    }
+
+    /* build list with last lines found (newest line at the end) */
+    for (i = 0; i < num_found && i < max_lines; i++)
+    {
+        index = (num_found - 1 - i) % max_lines;
+        if (!matches[index])
+            break;
+        new_line = malloc (sizeof (*new_line));
+        if (!new_line)
+            break;
+        new_line->data = matches[index];
+        matches[index] = NULL;
+        new_line->next_line = lines;
+        lines = new_line;
+    }
+
+end:
+    if (file_index)
+        fclose (file_index);
+    if (matches)
+    {
+        for (i = 0; i < max_lines; i++)
+        {
+            if (matches[i])
+                free (matches[i]);
+        }
+        free (matches);
+    }
+    if (buffer)
+        free (buffer);
+    if (fd != -1)
+        close (fd);
+    logger_index_query_free (query);
+
+    return lines;
+}
+
+/*
+ * Searches lines with all words of a string in a log file, then in its
+ * rotated log files ("file.1", "file.2", ...), starting with the most recent
+ * one, until "max_lines" lines are found.
+ *
+ * The rotated log files which are compressed ("file.1.gz", ...) are not
+ * searched.
+ *
+ * Returns the last lines found (at most "max_lines" lines), NULL if no line
+ * was found.
+ *
+ * Note: result must be freed after use with function logger_tail_free().
+ */
+
+struct t_logger_line *
+logger_index_search (const char *log_filename, const char *words,
+                     int max_lines)
+{
+    struct t_logger_line *lines, *lines_rotated, *ptr_line;
+    struct stat st;
+    char *filename_rotated;
+    int length, index, num_lines;
+
+    if (!log_filename || !words || (max_lines <= 0))
+        return NULL;
+
+    lines = logger_index_search_file (log_filename, words, max_lines);
+
+    num_lines = 0;
+    for (ptr_line = lines; ptr_line; ptr_line = ptr_line->next_line)
+    {
+        num_lines++;
+    }
+
+    length = strlen (log_filename) + 32;
+    filename_rotated = malloc (length);
+    if (!filename_rotated)
+        return lines;
+
+    /* search in rotated log files, starting with the most recent one */
+    index = 1;
+    while (num_lines < max_lines)
+    {
+        snprintf (filename_rotated, length, "%s.%d", log_filename, index);
+        if (stat (filename_rotated, &st) == 0)
+        {
+            lines_rotated = logger_index_search_file (filename_rotated, words,
+                                                      max_lines - num_lines);
+            if (lines_rotated)
+            {
+                /* lines of rotated log file are before lines found */
+                for (ptr_line = lines_rotated; ptr_line->next_line;
+                     ptr_line = ptr_line->next_line)
+                {
+                    num_lines++;
+                }
+                num_lines++;
+                ptr_line->next_line = lines;
+                lines = lines_rotated;
+            }
+        }
+        else
+        {
+            snprintf (filename_rotated, length, "%s.%d.gz",
+                      log_filename, index);
+            if (stat (filename_rotated, &st) != 0)
+                break;
+        }
+        index++;
+    }
+
+    free (filename_rotated);
+
+    return lines;
+}
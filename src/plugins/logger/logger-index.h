@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2003-2016 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WEECHAT_LOGGER_INDEX_H
+#define WEECHAT_LOGGER_INDEX_H 1
+
+#define LOGGER_INDEX_EXTENSION ".idx"
+#define LOGGER_INDEX_MAGIC "WLIDX002"
+#define LOGGER_INDEX_MAGIC_SIZE 8
+
+#define LOGGER_INDEX_BLOCK_SIZE (32 * 1024)
+#define LOGGER_INDEX_READ_SIZE (64 * 1024)
+#define LOGGER_INDEX_READ_SIZE_MAX (64 * 1024 * 1024)
+#define LOGGER_INDEX_BLOOM_SIZE 4096
+#define LOGGER_INDEX_BLOOM_HASHES 4
+
+#define LOGGER_INDEX_SEARCH_MAX_DEFAULT 20
+
+struct t_logger_buffer;
+struct t_logger_line;
+
+/*
+ * header of index: identity of log file indexed (the index is ignored if the
+ * log file has been replaced by another file)
+ */
+
+struct t_logger_index_header
+{
+    char magic[LOGGER_INDEX_MAGIC_SIZE]; /* LOGGER_INDEX_MAGIC              */
+    unsigned long long device;         /* device of log file                */
+    unsigned long long inode;          /* inode of log file                 */
+};
+
+/*
+ * block of index: a bloom filter with all words of lines written in log
+ * file between offsets "start" and "end"
+ */
+
+struct t_logger_index_block
+{
+    long long start;                   /* offset of first line in log file  */
+    long long end;                     /* offset after last line            */
+    unsigned char bloom[LOGGER_INDEX_BLOOM_SIZE]; /* bloom filter (words)   */
+};
+
+extern void logger_index_add_line (struct t_logger_buffer *logger_buffer,
+                                   const char *line, long long offset);
+extern void logger_index_write_block (struct t_logger_buffer *logger_buffer);
+extern void logger_index_remove (const char *log_filename);
+extern void logger_index_check (const char *log_filename);
+extern struct t_logger_line *logger_index_search_file (const char *log_filename,
+                                                       const char *words,
+                                                       int max_lines);
+extern struct t_logger_line *logger_index_search (const char *log_filename,
+                                                  const char *words,
+                                                  int max_lines);
+
+#endif /* WEECHAT_LOGGER_INDEX_H */
@@ -21,12 +21,55 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <limits.h>
 
 #include "../weechat-plugin.h"
 #include "logger.h"
 #include "logger-buffer.h"
+#include "logger-index.h"
 
 
+/*
+ * Returns logger info_hashtable "logger_search".
+ */
+
+struct t_hashtable *
+logger_info_info_hashtable_logger_search_cb (const void *pointer, void *data,
+                                             const char *info_name,
+                                             struct t_hashtable *hashtable)
+{
+    const char *words, *ptr_max;
+    char *error;
+    long max_lines;
+
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) info_name;
+
+    if (!hashtable)
+        return NULL;
+
+    words = weechat_hashtable_get (hashtable, "words");
+    if (!words)
+        return NULL;
+
+    max_lines = LOGGER_INDEX_SEARCH_MAX_DEFAULT;
+    ptr_max = weechat_hashtable_get (hashtable, "max");
+    if (ptr_max)
+    {
+        error = NULL;
+        max_lines = strtol (ptr_max, &error, 10);
+        if (!error || error[0] || (max_lines <= 0)
+            || (max_lines > INT_MAX))
+        {
+            return NULL;
+        }
+    }
+
+    return logger_search (words, max_lines);
+}
+
 /*
  * Returns logger infolist "logger_buffer".
  */
@@ -83,12 +126,25 @@ logger_info_infolist_logger_buffer_cb (const void *pointer, void *data,
 }
 
 /*
- * Hooks infolist for logger plugin.
+ * Hooks info_hashtable and infolist for logger plugin.
  */
 
 void
 logger_info_init ()
 {
+    /* info_hashtable hooks */
+    weechat_hook_info_hashtable (
+        "logger_search",
+        N_("search lines with all words in log files of all buffers"),
+        N_("\"words\": words to search, \"max\": max number of lines "
+           "returned for each buffer (optional, default is 20)"),
+        /* TRANSLATORS: please do not translate key names (enclosed by quotes) */
+        N_("\"buffer1\" ... \"bufferN\": full name of buffer, "
+           "\"line1\" ... \"lineN\": line found in log file (with date), "
+           "\"count\": number of lines found"),
+        &logger_info_info_hashtable_logger_search_cb, NULL, NULL);
+
+    /* infolist hooks */
     weechat_hook_infolist (
         "logger_buffer", N_("list of logger buffers"),
         N_("logger pointer (optional)"),
@@ -25,18 +25,55 @@
 
 #include <unistd.h>
 #include <stdlib.h>
+#include <stdio.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <errno.h>
 #include <string.h>
+#include <zlib.h>
 
 #include "logger.h"
 #include "logger-tail.h"
 
 
-#define LOGGER_TAIL_BUFSIZE 4096
+#define LOGGER_TAIL_READ_SIZE (64 * 1024)
+#define LOGGER_TAIL_READ_SIZE_MAX (64 * 1024 * 1024)
 
 
+/*
+ * Reads "size" bytes of a file at a given offset (the file is not mapped in
+ * memory, so that a file truncated while it is read does not cause a crash).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error or end of file reached before "size" bytes were read
+ */
+
+int
+logger_tail_read (int fd, char *buffer, size_t size, off_t offset)
+{
+    ssize_t num_read;
+
+    while (size > 0)
+    {
+        num_read = pread (fd, buffer, size, offset);
+        if (num_read < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return 0;
+        }
+        if (num_read == 0)
+            return 0;
+        buffer += num_read;
+        size -= num_read;
+        offset += num_read;
+    }
+
+    return 1;
+}
+
 /*
  * Searches for last EOL in a string.
  */
@@ -56,160 +93,409 @@ logger_tail_last_eol (const char *string_start, const char *string_ptr)
 }
 
 /*
- * Returns last lines of a file.
+ * Searches lines backwards in data (from "data_end" to "data") and adds them
+ * at the beginning of list "lines" (at most "*n_lines" lines, decremented
+ * for each line added).
  *
- * Note: result must be freed after use with function logger_tail_free().
+ * If "partial_start" is 1, the data before the first end-of-line may be the
+ * end of a line which starts before "data": it is not used.
+ *
+ * Returns pointer to the end of data not used ("data" if all data was used),
+ * NULL if error (not enough memory: the list is freed and set to NULL).
  */
 
-struct t_logger_line *
-logger_tail_file (const char *filename, int n_lines)
+const char *
+logger_tail_search_lines (const char *data, const char *data_end,
+                          int partial_start, int *n_lines,
+                          struct t_logger_line **lines)
+{
+    const char *ptr_end, *pos_eol, *start_line;
+    struct t_logger_line *new_line;
+    size_t length;
+
+    ptr_end = data_end;
+    while ((*n_lines > 0) && (ptr_end > data))
+    {
+        pos_eol = logger_tail_last_eol (data, ptr_end - 1);
+        if (!pos_eol && partial_start)
+            break;
+        start_line = (pos_eol) ? pos_eol + 1 : data;
+        length = ptr_end - start_line;
+        if (length > 0)
+        {
+            new_line = malloc (sizeof (*new_line));
+            if (new_line)
+            {
+                new_line->data = malloc (length + 1);
+                if (!new_line->data)
+                {
+                    free (new_line);
+                    new_line = NULL;
+                }
+            }
+            if (!new_line)
+            {
+                logger_tail_free (*lines);
+                *lines = NULL;
+                return NULL;
+            }
+            memcpy (new_line->data, start_line, length);
+            new_line->data[length] = '\0';
+            new_line->next_line = *lines;
+            *lines = new_line;
+            (*n_lines)--;
+        }
+        ptr_end = (pos_eol) ? pos_eol : data;
+    }
+
+    return ptr_end;
+}
+
+/*
+ * Adds last lines of a file at the beginning of list "lines" (at most
+ * "*n_lines" lines, decremented for each line added).
+ *
+ * The end of file is read in a buffer (window of LOGGER_TAIL_READ_SIZE bytes,
+ * doubled each time more data is needed, the buffer is reused), and lines are
+ * searched backwards from the end of file, so that only the last lines are
+ * read, whatever the size of file.
+ *
+ * A line longer than LOGGER_TAIL_READ_SIZE_MAX bytes is skipped.
+ * If the file is truncated while it is read, the lines already found are
+ * kept.
+ *
+ * Returns:
+ *   1: OK (or file not found/empty)
+ *   0: error (the list is freed and set to NULL)
+ */
+
+int
+logger_tail_add_lines_file (const char *filename, int *n_lines,
+                            struct t_logger_line **lines)
 {
     int fd;
-    off_t file_length, file_pos;
-    size_t to_read;
-    ssize_t bytes_read;
-    char buf[LOGGER_TAIL_BUFSIZE + 1];
-    char *ptr_buf, *pos_eol, *part_of_line, *new_part_of_line;
-    struct t_logger_line *ptr_line, *new_line;
+    struct stat st;
+    off_t end_offset, read_offset, window;
+    size_t read_size, buffer_size;
+    char *buffer, *new_buffer;
+    const char *ptr_end, *pos_eol;
+    int skip_line;
 
     /* open file */
     fd = open (filename, O_RDONLY);
     if (fd == -1)
-        return NULL;
+        return 1;
 
-    /* seek to the end of file */
-    file_length = lseek (fd, (off_t)0, SEEK_END);
-    if (file_length <= 0)
+    if ((fstat (fd, &st) != 0) || (st.st_size <= 0))
     {
         close (fd);
-        return NULL;
+        return 1;
     }
-    to_read = file_length;
-    file_pos = file_length - LOGGER_TAIL_BUFSIZE;
-    if (file_pos < 0)
-        file_pos = 0;
-    else
-        to_read = LOGGER_TAIL_BUFSIZE;
-    lseek (fd, file_pos, SEEK_SET);
-
-    /* loop until we have "n_lines" lines in list */
-    part_of_line = NULL;
-    ptr_line = NULL;
-    while (n_lines > 0)
+
+    buffer = NULL;
+    buffer_size = 0;
+    end_offset = st.st_size;
+    window = LOGGER_TAIL_READ_SIZE;
+    skip_line = 0;
+
+    /* loop until we have enough lines in list */
+    while ((*n_lines > 0) && (end_offset > 0))
     {
-        lseek (fd, file_pos, SEEK_SET);
-        bytes_read = read (fd, buf, to_read);
-        if (bytes_read <= 0)
+        /* read end of file */
+        read_offset = (end_offset > window) ? end_offset - window : 0;
+        read_size = end_offset - read_offset;
+        if (read_size > buffer_size)
         {
-            if (part_of_line)
-                free (part_of_line);
-            logger_tail_free (ptr_line);
-            close (fd);
-            return NULL;
+            new_buffer = realloc (buffer, read_size);
+            if (!new_buffer)
+            {
+                logger_tail_free (*lines);
+                *lines = NULL;
+                free (buffer);
+                close (fd);
+                return 0;
+            }
+            buffer = new_buffer;
+            buffer_size = read_size;
         }
-        buf[bytes_read] = '\0';
-        ptr_buf = buf + bytes_read - 1;
-        while (ptr_buf && (ptr_buf >= buf))
+        if (!logger_tail_read (fd, buffer, read_size, read_offset))
         {
-            pos_eol = (char *)logger_tail_last_eol (buf, ptr_buf);
-            if ((pos_eol && (pos_eol[1] || part_of_line)) || (file_pos == 0))
+            /* file truncated (or read error): keep lines found so far */
+            break;
+        }
+
+        ptr_end = buffer + read_size;
+
+        if (skip_line)
+        {
+            /* skip the end of a line too long (until its start is found) */
+            pos_eol = logger_tail_last_eol (buffer, ptr_end - 1);
+            ptr_end = (pos_eol) ? pos_eol : buffer;
+            if (pos_eol)
+                skip_line = 0;
+        }
+
+        if (!skip_line)
+        {
+            ptr_end = logger_tail_search_lines (buffer, ptr_end,
+                                                (read_offset > 0) ? 1 : 0,
+                                                n_lines, lines);
+            if (!ptr_end)
             {
-                /* use data and part_of_line (if existing) to build a new line */
-                if (!pos_eol)
-                {
-                    ptr_buf = NULL;
-                    pos_eol = buf;
-                }
-                else
-                {
-                    ptr_buf = pos_eol - 1;
-                    pos_eol[0] = '\0';
-                    pos_eol++;
-                }
-                if (part_of_line || pos_eol[0])
-                {
-                    new_line = malloc (sizeof (*new_line));
-                    if (!new_line)
-                    {
-                        logger_tail_free (ptr_line);
-                        ptr_line = NULL;
-                        break;
-                    }
-                    if (part_of_line)
-                    {
-                        new_line->data = malloc ((strlen (pos_eol) +
-                                                  strlen (part_of_line) + 1));
-                        if (!new_line->data)
-                        {
-                            free (part_of_line);
-                            free (new_line);
-                            logger_tail_free (ptr_line);
-                            close (fd);
-                            return NULL;
-                        }
-                        strcpy (new_line->data, pos_eol);
-                        strcat (new_line->data, part_of_line);
-                        free (part_of_line);
-                        part_of_line = NULL;
-                    }
-                    else
-                    {
-                        new_line->data = strdup (pos_eol);
-                    }
-                    new_line->next_line = ptr_line;
-                    ptr_line = new_line;
-                    n_lines--;
-                    if (n_lines <= 0)
-                        break;
-                }
+                free (buffer);
+                close (fd);
+                return 0;
             }
-            else if (!pos_eol)
+            if ((ptr_end == buffer + read_size) && (read_offset > 0)
+                && (window >= LOGGER_TAIL_READ_SIZE_MAX))
             {
-                /*
-                 * beginning of read buffer reached without EOL, then we
-                 * add string to part_of_line, we'll use that later
-                 */
-                if (part_of_line)
+                /* no end-of-line found in max window: skip this line */
+                ptr_end = buffer;
+                skip_line = 1;
+            }
+        }
+
+        end_offset = read_offset + (ptr_end - buffer);
+
+        if (window < LOGGER_TAIL_READ_SIZE_MAX)
+            window *= 2;
+    }
+
+    free (buffer);
+    close (fd);
+
+    return 1;
+}
+
+/*
+ * Searches for first EOL in a string (at most "string_end - string" bytes).
+ */
+
+const char *
+logger_tail_first_eol (const char *string, const char *string_end)
+{
+    while (string < string_end)
+    {
+        if ((string[0] == '\n') || (string[0] == '\r'))
+            return string;
+        string++;
+    }
+
+    /* no end-of-line found in string */
+    return NULL;
+}
+
+/*
+ * Adds a line in a ring of "ring_size" lines (the oldest line is freed if the
+ * ring is full).
+ */
+
+void
+logger_tail_ring_add (char **ring, int ring_size, int *ring_count,
+                      int *ring_next, char *line)
+{
+    if (ring[*ring_next])
+        free (ring[*ring_next]);
+    ring[*ring_next] = line;
+    *ring_next = (*ring_next + 1) % ring_size;
+    if (*ring_count < ring_size)
+        (*ring_count)++;
+}
+
+/*
+ * Adds last lines of a gzip-compressed file at the beginning of list "lines"
+ * (at most "*n_lines" lines, decremented for each line added).
+ *
+ * The file is uncompressed by blocks of LOGGER_TAIL_READ_SIZE bytes, and only
+ * the last "*n_lines" lines are kept in memory (in a ring of lines). A line
+ * longer than LOGGER_TAIL_READ_SIZE_MAX bytes is skipped.
+ *
+ * Returns:
+ *   1: OK (or file not found/empty)
+ *   0: error (the list is freed and set to NULL)
+ */
+
+int
+logger_tail_add_lines_gzip_file (const char *filename, int *n_lines,
+                                 struct t_logger_line **lines)
+{
+    gzFile file;
+    char *buffer, **ring, *line, *new_line_data;
+    const char *ptr_data, *ptr_data_end, *pos_eol;
+    struct t_logger_line *new_line;
+    size_t length, line_length;
+    int num_read, ring_size, ring_count, ring_next, skip_line, i, index, rc;
+
+    file = gzopen (filename, "rb");
+    if (!file)
+        return 1;
+
+    ring_size = *n_lines;
+    buffer = malloc (LOGGER_TAIL_READ_SIZE);
+    ring = calloc (ring_size, sizeof (*ring));
+    line = NULL;
+    line_length = 0;
+    ring_count = 0;
+    ring_next = 0;
+    skip_line = 0;
+    rc = 0;
+
+    if (!buffer || !ring)
+        goto end;
+
+    while (1)
+    {
+        num_read = gzread (file, buffer, LOGGER_TAIL_READ_SIZE);
+        ptr_data = buffer;
+        ptr_data_end = buffer + ((num_read > 0) ? num_read : 0);
+        while (ptr_data < ptr_data_end)
+        {
+            pos_eol = logger_tail_first_eol (ptr_data, ptr_data_end);
+            length = ((pos_eol) ? pos_eol : ptr_data_end) - ptr_data;
+            if (!skip_line && (length > 0))
+            {
+                if (line_length + length > LOGGER_TAIL_READ_SIZE_MAX)
                 {
-                    new_part_of_line = malloc (strlen (buf) + strlen (part_of_line) + 1);
-                    if (!new_part_of_line)
-                    {
-                        free (part_of_line);
-                        logger_tail_free (ptr_line);
-                        close (fd);
-                        return NULL;
-                    }
-                    strcpy (new_part_of_line, buf);
-                    strcat (new_part_of_line, part_of_line);
-                    free (part_of_line);
-                    part_of_line = new_part_of_line;
+                    /* line too long: skip it */
+                    free (line);
+                    line = NULL;
+                    line_length = 0;
+                    skip_line = 1;
                 }
                 else
                 {
-                    part_of_line = malloc (strlen (buf) + 1);
-                    strcpy (part_of_line, buf);
+                    new_line_data = realloc (line, line_length + length + 1);
+                    if (!new_line_data)
+                        goto end;
+                    line = new_line_data;
+                    memcpy (line + line_length, ptr_data, length);
+                    line_length += length;
+                    line[line_length] = '\0';
                 }
-                ptr_buf = NULL;
             }
-            else
-                ptr_buf = pos_eol - 1;
+            if (!pos_eol)
+                break;
+            if (line)
+            {
+                logger_tail_ring_add (ring, ring_size, &ring_count, &ring_next,
+                                      line);
+                line = NULL;
+            }
+            line_length = 0;
+            skip_line = 0;
+            ptr_data = pos_eol + 1;
         }
-        if (file_pos == 0)
+        if (num_read <= 0)
+        {
+            /* end of file: the last line may have no end-of-line */
+            if (line)
+            {
+                logger_tail_ring_add (ring, ring_size, &ring_count, &ring_next,
+                                      line);
+                line = NULL;
+            }
             break;
-        to_read = file_pos;
-        file_pos -= LOGGER_TAIL_BUFSIZE;
-        if (file_pos < 0)
-            file_pos = 0;
-        else
-            to_read = LOGGER_TAIL_BUFSIZE;
+        }
+    }
+
+    /* add lines of ring at the beginning of list, from the most recent */
+    for (i = 0; i < ring_count; i++)
+    {
+        index = (ring_next - 1 - i + ring_size) % ring_size;
+        new_line = malloc (sizeof (*new_line));
+        if (!new_line)
+            goto end;
+        new_line->data = ring[index];
+        ring[index] = NULL;
+        new_line->next_line = *lines;
+        *lines = new_line;
+        (*n_lines)--;
     }
 
-    if (part_of_line)
-        free (part_of_line);
+    rc = 1;
 
-    close (fd);
+end:
+    gzclose (file);
+    if (ring)
+    {
+        for (i = 0; i < ring_size; i++)
+        {
+            if (ring[i])
+                free (ring[i]);
+        }
+        free (ring);
+    }
+    if (line)
+        free (line);
+    if (buffer)
+        free (buffer);
+    if (!rc)
+    {
+        logger_tail_free (*lines);
+        *lines = NULL;
+    }
+
+    return rc;
+}
+
+/*
+ * Returns last lines of a log file.
+ *
+ * If the file has less than "n_lines" lines, the rotated log files are read
+ * too ("file.1", "file.2", ..., or "file.1.gz", "file.2.gz", ... if they are
+ * compressed), until "n_lines" lines are found.
+ *
+ * Note: result must be freed after use with function logger_tail_free().
+ */
+
+struct t_logger_line *
+logger_tail_file (const char *filename, int n_lines)
+{
+    struct t_logger_line *lines;
+    struct stat st;
+    char *filename_rotated;
+    int length, index, rc;
+
+    if (n_lines <= 0)
+        return NULL;
+
+    lines = NULL;
+
+    if (!logger_tail_add_lines_file (filename, &n_lines, &lines))
+        return NULL;
+
+    if (n_lines <= 0)
+        return lines;
+
+    /* read rotated log files, starting with the most recent one */
+    length = strlen (filename) + 32;
+    filename_rotated = malloc (length);
+    if (!filename_rotated)
+        return lines;
+    index = 1;
+    while (n_lines > 0)
+    {
+        snprintf (filename_rotated, length, "%s.%d.gz", filename, index);
+        if (stat (filename_rotated, &st) == 0)
+        {
+            rc = logger_tail_add_lines_gzip_file (filename_rotated,
+                                                  &n_lines, &lines);
+        }
+        else
+        {
+            snprintf (filename_rotated, length, "%s.%d", filename, index);
+            if (stat (filename_rotated, &st) != 0)
+                break;
+            rc = logger_tail_add_lines_file (filename_rotated,
+                                             &n_lines, &lines);
+        }
+        if (!rc)
+            break;
+        index++;
+    }
+    free (filename_rotated);
 
-    return ptr_line;
+    return lines;
 }
 
 /*
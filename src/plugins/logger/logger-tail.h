@@ -26,6 +26,8 @@ struct t_logger_line
     struct t_logger_line *next_line;   /* link to next line                 */
 };
 
+extern int logger_tail_read (int fd, char *buffer, size_t size,
+                             off_t offset);
 extern struct t_logger_line *logger_tail_file (const char *filename,
                                                int n_lines);
 extern void logger_tail_free (struct t_logger_line *lines);
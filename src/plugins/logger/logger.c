@@ -34,6 +34,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/time.h>
+#include <zlib.h>
 #include <fcntl.h>
 #include <time.h>
 
@@ -41,6 +42,7 @@
 #include "logger.h"
 #include "logger-buffer.h"
 #include "logger-config.h"
+#include "logger-index.h"
 #include "logger-info.h"
 #include "logger-tail.h"
 
@@ -56,6 +58,15 @@ struct t_weechat_plugin *weechat_logger_plugin = NULL;
 
 struct t_hook *logger_timer = NULL;    /* timer to flush log files          */
 
+const char *logger_charset = NULL;     /* charset for log files (terminal)  */
+int logger_charset_utf8 = 0;           /* 1 if charset is UTF-8             */
+
+struct t_hashtable *logger_rotate_compressing = NULL; /* log files whose  */
+                                       /* rotated file is being compressed  */
+
+time_t logger_time_string_date = 0;    /* date of last time string built    */
+char logger_time_string[256] = { '\0' }; /* last time string built         */
+
 
 /*
  * Gets logger file path option.
@@ -510,104 +521,519 @@ logger_set_log_filename (struct t_logger_buffer *logger_buffer)
 }
 
 /*
- * Writes a line to log file.
+ * Gets date/time string for log files (with option logger.file.time_format).
+ *
+ * The last string built is kept, so that it is built only once for all lines
+ * printed in the same second.
  */
 
-void
-logger_write_line (struct t_logger_buffer *logger_buffer,
-                   const char *format, ...)
+const char *
+logger_get_time_string (time_t date)
 {
-    char *message, buf_time[256], buf_beginning[1024];
-    const char *charset;
-    time_t seconds;
     struct tm *date_tmp;
-    int log_level;
 
-    charset = weechat_info_get ("charset_terminal", "");
+    if ((date == logger_time_string_date) && (date != 0))
+        return logger_time_string;
 
-    if (!logger_buffer->log_file)
+    logger_time_string[0] = '\0';
+    date_tmp = localtime (&date);
+    if (date_tmp)
     {
-        log_level = logger_get_level_for_buffer (logger_buffer->buffer);
-        if (log_level == 0)
-        {
-            logger_buffer_free (logger_buffer);
-            return;
-        }
-        if (!logger_create_directory ())
-        {
-            weechat_printf_date_tags (
-                NULL, 0, "no_log",
-                _("%s%s: unable to create directory for logs "
-                  "(\"%s\")"),
-                weechat_prefix ("error"), LOGGER_PLUGIN_NAME,
-                weechat_config_string (logger_config_file_path));
-            logger_buffer_free (logger_buffer);
-            return;
-        }
-        if (!logger_buffer->log_filename)
-            logger_set_log_filename (logger_buffer);
-        if (!logger_buffer->log_filename)
+        strftime (logger_time_string, sizeof (logger_time_string) - 1,
+                  weechat_config_string (logger_config_file_time_format),
+                  date_tmp);
+    }
+    logger_time_string_date = date;
+
+    return logger_time_string;
+}
+
+/*
+ * Resets the last time string built (called when the time format is changed).
+ */
+
+void
+logger_time_string_reset ()
+{
+    logger_time_string_date = 0;
+    logger_time_string[0] = '\0';
+}
+
+/*
+ * Writes a string (followed by a new line) in log file, converted to
+ * terminal charset.
+ *
+ * Note: the string may be modified (invalid UTF-8 chars are replaced by "?").
+ */
+
+void
+logger_write_string (struct t_logger_buffer *logger_buffer, char *string)
+{
+    char *message;
+    const char *ptr_string;
+    long long offset;
+
+    message = NULL;
+    if (logger_charset_utf8)
+    {
+        /* same charset: no conversion, only replace invalid UTF-8 chars */
+        weechat_utf8_normalize (string, '?');
+    }
+    else if (logger_charset)
+    {
+        message = weechat_iconv_from_internal (logger_charset, string);
+    }
+
+    ptr_string = (message) ? message : string;
+
+    fputs (ptr_string, logger_buffer->log_file);
+    fputc ('\n', logger_buffer->log_file);
+
+    offset = logger_buffer->log_file_size;
+    logger_buffer->log_file_size += strlen (ptr_string) + 1;
+
+    if (weechat_config_boolean (logger_config_file_index))
+        logger_index_add_line (logger_buffer, ptr_string, offset);
+
+    if (message)
+        free (message);
+
+    logger_buffer->flush_needed = 1;
+}
+
+/*
+ * Flushes log file of a logger buffer (with a call to fsync if option
+ * logger.file.fsync is enabled).
+ */
+
+void
+logger_flush_file (struct t_logger_buffer *logger_buffer)
+{
+    fflush (logger_buffer->log_file);
+    if (weechat_config_boolean (logger_config_file_fsync))
+        fsync (fileno (logger_buffer->log_file));
+    logger_buffer->flush_needed = 0;
+}
+
+/*
+ * Compresses a file with gzip: the compressed data is written in a temporary
+ * file, renamed to "filename_gz" when the compression is done, and then
+ * "filename" is deleted.
+ *
+ * This function is called in a child process.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+logger_rotate_compress_file (const char *filename, const char *filename_gz,
+                             int level)
+{
+    FILE *file;
+    gzFile file_gz;
+    char *filename_tmp, buffer[65536], mode[8];
+    size_t length, num_read;
+    int rc;
+
+    length = strlen (filename_gz) + 16;
+    filename_tmp = malloc (length);
+    if (!filename_tmp)
+        return 0;
+    snprintf (filename_tmp, length, "%s.part", filename_gz);
+
+    file = fopen (filename, "rb");
+    if (!file)
+    {
+        free (filename_tmp);
+        return 0;
+    }
+
+    snprintf (mode, sizeof (mode), "wb%d", level);
+    file_gz = gzopen (filename_tmp, mode);
+    if (!file_gz)
+    {
+        fclose (file);
+        free (filename_tmp);
+        return 0;
+    }
+
+    rc = 1;
+    while ((num_read = fread (buffer, 1, sizeof (buffer), file)) > 0)
+    {
+        if (gzwrite (file_gz, buffer, num_read) != (int)num_read)
         {
-            logger_buffer_free (logger_buffer);
-            return;
+            rc = 0;
+            break;
         }
+    }
+    if (ferror (file))
+        rc = 0;
+    if (gzclose (file_gz) != Z_OK)
+        rc = 0;
+    fclose (file);
 
-        logger_buffer->log_file =
-            fopen (logger_buffer->log_filename, "a");
-        if (!logger_buffer->log_file)
+    if (rc && (rename (filename_tmp, filename_gz) == 0))
+        unlink (filename);
+    else
+    {
+        unlink (filename_tmp);
+        rc = 0;
+    }
+
+    free (filename_tmp);
+
+    return rc;
+}
+
+/*
+ * Callback for compression of a rotated log file.
+ *
+ * Argument "data" is the log filename (freed by WeeChat when the process
+ * hook is removed).
+ */
+
+int
+logger_rotate_compress_cb (const void *pointer, void *data,
+                           const char *command, int return_code,
+                           const char *out, const char *err)
+{
+    char *filename, *filename_gz;
+    const char *log_filename;
+    int length, level, rc;
+
+    /* make C compiler happy */
+    (void) pointer;
+    (void) command;
+    (void) out;
+    (void) err;
+
+    log_filename = (const char *)data;
+
+    if (return_code == WEECHAT_HOOK_PROCESS_RUNNING)
+        return WEECHAT_RC_OK;
+
+    if (return_code == WEECHAT_HOOK_PROCESS_CHILD)
+    {
+        /* in child process: compress the file and exit */
+        length = strlen (log_filename) + 16;
+        filename = malloc (length);
+        filename_gz = malloc (length);
+        rc = 1;
+        if (filename && filename_gz)
         {
-            weechat_printf_date_tags (
-                NULL, 0, "no_log",
-                _("%s%s: unable to write log file \"%s\": %s"),
-                weechat_prefix ("error"), LOGGER_PLUGIN_NAME,
-                logger_buffer->log_filename, strerror (errno));
-            logger_buffer_free (logger_buffer);
-            return;
+            snprintf (filename, length, "%s.1", log_filename);
+            snprintf (filename_gz, length, "%s.1.gz", log_filename);
+            /* compression level: 1-100 (percent) converted to 1-9 */
+            level = (weechat_config_integer (
+                         logger_config_file_rotation_compression_level) * 9) / 100;
+            if (level < 1)
+                level = 1;
+            if (logger_rotate_compress_file (filename, filename_gz, level))
+            {
+                /* compressed files are not indexed */
+                logger_index_remove (filename);
+                rc = 0;
+            }
         }
+        if (filename)
+            free (filename);
+        if (filename_gz)
+            free (filename_gz);
+        return rc;
+    }
+
+    if (return_code != 0)
+    {
+        weechat_printf_date_tags (
+            NULL, 0, "no_log",
+            _("%s%s: unable to compress rotated log file \"%s.1\""),
+            weechat_prefix ("error"), LOGGER_PLUGIN_NAME, log_filename);
+    }
+
+    weechat_hashtable_remove (logger_rotate_compressing, log_filename);
 
-        if (weechat_config_boolean (logger_config_file_info_lines)
-            && logger_buffer->write_start_info_line)
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Renames rotated log files ("file.1" becomes "file.2", etc., with or
+ * without extension ".gz", and their index), then renames log file and its
+ * index to "file.1" and "file.1.idx".
+ *
+ * If option logger.file.rotation_files_max is set, the oldest rotated log
+ * files are deleted, so that at most this number of rotated files are kept.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error
+ */
+
+int
+logger_rotate_rename_files (const char *log_filename)
+{
+    char *filename1, *filename2;
+    const char *extensions[] = { "", ".gz", LOGGER_INDEX_EXTENSION, NULL };
+    int length, i, j, max_index, files_max, rc;
+    struct stat st;
+
+    length = strlen (log_filename) + 32;
+    filename1 = malloc (length);
+    filename2 = malloc (length);
+    if (!filename1 || !filename2)
+    {
+        if (filename1)
+            free (filename1);
+        if (filename2)
+            free (filename2);
+        return 0;
+    }
+
+    /* search the highest index of rotated log files */
+    max_index = 0;
+    while (1)
+    {
+        snprintf (filename1, length, "%s.%d", log_filename, max_index + 1);
+        snprintf (filename2, length, "%s.%d.gz", log_filename, max_index + 1);
+        if ((stat (filename1, &st) != 0) && (stat (filename2, &st) != 0))
+            break;
+        max_index++;
+    }
+
+    /* delete oldest rotated log files (the log file will be a new one) */
+    files_max = weechat_config_integer (logger_config_file_rotation_files_max);
+    if (files_max > 0)
+    {
+        for (i = max_index; i >= files_max; i--)
         {
-            buf_time[0] = '\0';
-            seconds = time (NULL);
-            date_tmp = localtime (&seconds);
-            if (date_tmp)
+            for (j = 0; extensions[j]; j++)
             {
-                strftime (buf_time, sizeof (buf_time) - 1,
-                          weechat_config_string (logger_config_file_time_format),
-                          date_tmp);
+                snprintf (filename1, length, "%s.%d%s",
+                          log_filename, i, extensions[j]);
+                unlink (filename1);
             }
-            snprintf (buf_beginning, sizeof (buf_beginning),
-                      _("%s\t****  Beginning of log  ****"),
-                      buf_time);
-            message = (charset) ?
-                weechat_iconv_from_internal (charset, buf_beginning) : NULL;
-            fprintf (logger_buffer->log_file,
-                     "%s\n", (message) ? message : buf_beginning);
-            if (message)
-                free (message);
-            logger_buffer->flush_needed = 1;
         }
-        logger_buffer->write_start_info_line = 0;
+        if (max_index >= files_max)
+            max_index = files_max - 1;
+    }
+
+    /* rename rotated log files, starting with the oldest one */
+    for (i = max_index; i >= 1; i--)
+    {
+        for (j = 0; extensions[j]; j++)
+        {
+            snprintf (filename1, length, "%s.%d%s",
+                      log_filename, i, extensions[j]);
+            snprintf (filename2, length, "%s.%d%s",
+                      log_filename, i + 1, extensions[j]);
+            if (stat (filename1, &st) == 0)
+                rename (filename1, filename2);
+        }
+    }
+
+    /* rename log file and its index */
+    snprintf (filename1, length, "%s.1", log_filename);
+    rc = (rename (log_filename, filename1) == 0) ? 1 : 0;
+    if (rc)
+    {
+        snprintf (filename1, length, "%s%s", log_filename,
+                  LOGGER_INDEX_EXTENSION);
+        snprintf (filename2, length, "%s.1%s", log_filename,
+                  LOGGER_INDEX_EXTENSION);
+        if (stat (filename1, &st) == 0)
+            rename (filename1, filename2);
+    }
+
+    free (filename1);
+    free (filename2);
+
+    return rc;
+}
+
+/*
+ * Rotates log file of a logger buffer: the file is closed and renamed (see
+ * function logger_rotate_rename_files), and then compressed in a child
+ * process if option logger.file.rotation_compression_type is set.
+ *
+ * The log file is opened again on next line written.
+ *
+ * The rotation is delayed if the previous rotated file is still being
+ * compressed.
+ */
+
+void
+logger_rotate (struct t_logger_buffer *logger_buffer)
+{
+    char *log_filename;
+    struct t_hook *hook_compress;
+
+    if (!logger_buffer->log_filename)
+        return;
+
+    if (logger_rotate_compressing
+        && weechat_hashtable_has_key (logger_rotate_compressing,
+                                      logger_buffer->log_filename))
+    {
+        return;
+    }
+
+    if (weechat_logger_plugin->debug)
+    {
+        weechat_printf_date_tags (NULL, 0, "no_log",
+                                  "%s: rotating log file \"%s\"",
+                                  LOGGER_PLUGIN_NAME,
+                                  logger_buffer->log_filename);
+    }
+
+    if (logger_buffer->log_file && logger_buffer->flush_needed)
+        logger_flush_file (logger_buffer);
+    logger_buffer_close_file (logger_buffer);
+
+    if (!logger_rotate_rename_files (logger_buffer->log_filename))
+    {
+        weechat_printf_date_tags (
+            NULL, 0, "no_log",
+            _("%s%s: unable to rotate log file \"%s\": %s"),
+            weechat_prefix ("error"), LOGGER_PLUGIN_NAME,
+            logger_buffer->log_filename, strerror (errno));
+        return;
+    }
+
+    if (weechat_config_integer (logger_config_file_rotation_compression_type)
+        == LOGGER_CONFIG_COMPRESSION_TYPE_NONE)
+    {
+        return;
     }
 
+    if (!logger_rotate_compressing)
+    {
+        logger_rotate_compressing = weechat_hashtable_new (
+            32,
+            WEECHAT_HASHTABLE_STRING,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL, NULL);
+        if (!logger_rotate_compressing)
+            return;
+    }
+
+    log_filename = strdup (logger_buffer->log_filename);
+    if (!log_filename)
+        return;
+    hook_compress = weechat_hook_process ("func:logger_rotate_compress", 0,
+                                          &logger_rotate_compress_cb,
+                                          NULL, log_filename);
+    if (hook_compress)
+    {
+        weechat_hashtable_set (logger_rotate_compressing,
+                               log_filename, hook_compress);
+    }
+    else
+    {
+        free (log_filename);
+    }
+}
+
+/*
+ * Opens log file of a logger buffer (and writes the start info line if
+ * needed).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (the logger buffer has been freed)
+ */
+
+int
+logger_open_file (struct t_logger_buffer *logger_buffer)
+{
+    char buf_beginning[1024];
+    int log_level;
+    struct stat st;
+
+    log_level = logger_get_level_for_buffer (logger_buffer->buffer);
+    if (log_level == 0)
+    {
+        logger_buffer_free (logger_buffer);
+        return 0;
+    }
+    if (!logger_create_directory ())
+    {
+        weechat_printf_date_tags (
+            NULL, 0, "no_log",
+            _("%s%s: unable to create directory for logs "
+              "(\"%s\")"),
+            weechat_prefix ("error"), LOGGER_PLUGIN_NAME,
+            weechat_config_string (logger_config_file_path));
+        logger_buffer_free (logger_buffer);
+        return 0;
+    }
+    if (!logger_buffer->log_filename)
+        logger_set_log_filename (logger_buffer);
+    if (!logger_buffer->log_filename)
+    {
+        logger_buffer_free (logger_buffer);
+        return 0;
+    }
+
+    logger_buffer->log_file =
+        fopen (logger_buffer->log_filename, "a");
+    if (!logger_buffer->log_file)
+    {
+        weechat_printf_date_tags (
+            NULL, 0, "no_log",
+            _("%s%s: unable to write log file \"%s\": %s"),
+            weechat_prefix ("error"), LOGGER_PLUGIN_NAME,
+            logger_buffer->log_filename, strerror (errno));
+        logger_buffer_free (logger_buffer);
+        return 0;
+    }
+    logger_buffer_set_file_buffer (logger_buffer);
+    logger_buffer->log_file_size =
+        (fstat (fileno (logger_buffer->log_file), &st) == 0) ? st.st_size : 0;
+    logger_index_check (logger_buffer->log_filename);
+
+    if (weechat_config_boolean (logger_config_file_info_lines)
+        && logger_buffer->write_start_info_line)
+    {
+        snprintf (buf_beginning, sizeof (buf_beginning),
+                  _("%s\t****  Beginning of log  ****"),
+                  logger_get_time_string (time (NULL)));
+        logger_write_string (logger_buffer, buf_beginning);
+    }
+    logger_buffer->write_start_info_line = 0;
+
+    return 1;
+}
+
+/*
+ * Writes a line to log file.
+ */
+
+void
+logger_write_line (struct t_logger_buffer *logger_buffer,
+                   const char *format, ...)
+{
+    /*
+     * format the line first: arguments may point to the time string, which
+     * is changed if the start info line is written
+     */
     weechat_va_format (format);
-    if (vbuffer)
+    if (!vbuffer)
+        return;
+
+    if (logger_buffer->log_file || logger_open_file (logger_buffer))
     {
-        message = (charset) ?
-            weechat_iconv_from_internal (charset, vbuffer) : NULL;
-        fprintf (logger_buffer->log_file,
-                 "%s\n", (message) ? message : vbuffer);
-        if (message)
-            free (message);
-        logger_buffer->flush_needed = 1;
+        logger_write_string (logger_buffer, vbuffer);
         if (!logger_timer)
+            logger_flush_file (logger_buffer);
+        if ((logger_config_rotation_size_max > 0)
+            && (logger_buffer->log_file_size >= logger_config_rotation_size_max))
         {
-            fflush (logger_buffer->log_file);
-            logger_buffer->flush_needed = 0;
+            logger_rotate (logger_buffer);
         }
-        free (vbuffer);
     }
+
+    free (vbuffer);
 }
 
 /*
@@ -617,10 +1043,6 @@ logger_write_line (struct t_logger_buffer *logger_buffer,
 void
 logger_stop (struct t_logger_buffer *logger_buffer, int write_info_line)
 {
-    time_t seconds;
-    struct tm *date_tmp;
-    char buf_time[256];
-
     if (!logger_buffer)
         return;
 
@@ -628,21 +1050,11 @@ logger_stop (struct t_logger_buffer *logger_buffer, int write_info_line)
     {
         if (write_info_line && weechat_config_boolean (logger_config_file_info_lines))
         {
-            buf_time[0] = '\0';
-            seconds = time (NULL);
-            date_tmp = localtime (&seconds);
-            if (date_tmp)
-            {
-                strftime (buf_time, sizeof (buf_time) - 1,
-                          weechat_config_string (logger_config_file_time_format),
-                          date_tmp);
-            }
             logger_write_line (logger_buffer,
                                _("%s\t****  End of log  ****"),
-                               buf_time);
+                               logger_get_time_string (time (NULL)));
         }
-        fclose (logger_buffer->log_file);
-        logger_buffer->log_file = NULL;
+        logger_buffer_close_file (logger_buffer);
     }
     logger_buffer_free (logger_buffer);
 }
@@ -700,10 +1112,7 @@ logger_start_buffer (struct t_gui_buffer *buffer, int write_info_line)
                 if (ptr_logger_buffer->log_filename)
                 {
                     if (ptr_logger_buffer->log_file)
-                    {
-                        fclose (ptr_logger_buffer->log_file);
-                        ptr_logger_buffer->log_file = NULL;
-                    }
+                        logger_buffer_close_file (ptr_logger_buffer);
                 }
             }
         }
@@ -840,12 +1249,148 @@ logger_flush ()
                                           LOGGER_PLUGIN_NAME,
                                           ptr_logger_buffer->log_filename);
             }
-            fflush (ptr_logger_buffer->log_file);
-            ptr_logger_buffer->flush_needed = 0;
+            logger_flush_file (ptr_logger_buffer);
         }
     }
 }
 
+/*
+ * Searches lines with all words of a string in log files of all buffers
+ * and their rotated log files which are not compressed (using index of log
+ * files, see option logger.file.index).
+ *
+ * Lines not yet written in log files are flushed before the search.
+ *
+ * Returns a hashtable with keys:
+ *   "count": number of lines found
+ *   "buffer1" ... "bufferN": full name of buffer
+ *   "line1" ... "lineN": line found in log file of buffer
+ * (at most "max_lines" lines per buffer, the last lines found),
+ * NULL if error.
+ *
+ * Note: result must be freed after use.
+ */
+
+struct t_hashtable *
+logger_search (const char *words, int max_lines)
+{
+    struct t_hashtable *hashtable;
+    struct t_logger_buffer *ptr_logger_buffer;
+    struct t_logger_line *lines, *ptr_line;
+    char *words_charset, *line, str_key[64], str_count[32];
+    int count;
+
+    if (!words)
+        return NULL;
+
+    hashtable = weechat_hashtable_new (32,
+                                       WEECHAT_HASHTABLE_STRING,
+                                       WEECHAT_HASHTABLE_STRING,
+                                       NULL, NULL);
+    if (!hashtable)
+        return NULL;
+
+    logger_flush ();
+
+    /* words are searched in log files, which use the terminal charset */
+    words_charset = (!logger_charset_utf8 && logger_charset) ?
+        weechat_iconv_from_internal (logger_charset, words) : NULL;
+
+    count = 0;
+    for (ptr_logger_buffer = logger_buffers; ptr_logger_buffer;
+         ptr_logger_buffer = ptr_logger_buffer->next_buffer)
+    {
+        if (!ptr_logger_buffer->log_filename)
+            continue;
+        lines = logger_index_search (
+            ptr_logger_buffer->log_filename,
+            (words_charset) ? words_charset : words,
+            max_lines);
+        for (ptr_line = lines; ptr_line; ptr_line = ptr_line->next_line)
+        {
+            line = (logger_charset && !(logger_charset_utf8
+                                        && weechat_utf8_is_valid (ptr_line->data,
+                                                                  -1, NULL))) ?
+                weechat_iconv_to_internal (logger_charset, ptr_line->data) :
+                NULL;
+            count++;
+            snprintf (str_key, sizeof (str_key), "buffer%d", count);
+            weechat_hashtable_set (
+                hashtable, str_key,
+                weechat_buffer_get_string (ptr_logger_buffer->buffer,
+                                           "full_name"));
+            snprintf (str_key, sizeof (str_key), "line%d", count);
+            weechat_hashtable_set (hashtable, str_key,
+                                   (line) ? line : ptr_line->data);
+            if (line)
+                free (line);
+        }
+        if (lines)
+            logger_tail_free (lines);
+    }
+
+    snprintf (str_count, sizeof (str_count), "%d", count);
+    weechat_hashtable_set (hashtable, "count", str_count);
+
+    if (words_charset)
+        free (words_charset);
+
+    return hashtable;
+}
+
+/*
+ * Searches words in log files and displays lines found on core buffer.
+ */
+
+void
+logger_search_display (const char *words)
+{
+    struct t_hashtable *hashtable;
+    const char *ptr_count, *ptr_buffer, *ptr_line;
+    char *error, str_key[64], *line;
+    long count, i;
+
+    hashtable = logger_search (words, LOGGER_INDEX_SEARCH_MAX_DEFAULT);
+    if (!hashtable)
+        return;
+
+    count = 0;
+    ptr_count = weechat_hashtable_get (hashtable, "count");
+    if (ptr_count)
+    {
+        error = NULL;
+        count = strtol (ptr_count, &error, 10);
+        if (!error || error[0])
+            count = 0;
+    }
+
+    weechat_printf (NULL, "");
+    weechat_printf (NULL, _("Lines found in logs for \"%s\": %ld"),
+                    words, count);
+
+    for (i = 1; i <= count; i++)
+    {
+        snprintf (str_key, sizeof (str_key), "buffer%ld", i);
+        ptr_buffer = weechat_hashtable_get (hashtable, str_key);
+        snprintf (str_key, sizeof (str_key), "line%ld", i);
+        ptr_line = weechat_hashtable_get (hashtable, str_key);
+        if (!ptr_buffer || !ptr_line)
+            continue;
+        /* tabs are replaced, so that the whole line is in message */
+        line = weechat_string_replace (ptr_line, "\t", " ");
+        weechat_printf (NULL,
+                        "  %s%s%s: %s",
+                        weechat_color ("chat_buffer"),
+                        ptr_buffer,
+                        weechat_color ("chat"),
+                        (line) ? line : ptr_line);
+        if (line)
+            free (line);
+    }
+
+    weechat_hashtable_free (hashtable);
+}
+
 /*
  * Callback for command "/logger".
  */
@@ -858,7 +1403,6 @@ logger_command_cb (const void *pointer, void *data,
     /* make C compiler happy */
     (void) pointer;
     (void) data;
-    (void) argv_eol;
 
     if ((argc == 1)
         || ((argc == 2) && (weechat_strcasecmp (argv[1], "list") == 0)))
@@ -886,6 +1430,13 @@ logger_command_cb (const void *pointer, void *data,
         return WEECHAT_RC_OK;
     }
 
+    if (weechat_strcasecmp (argv[1], "search") == 0)
+    {
+        WEECHAT_COMMAND_MIN_ARGS(3, "search");
+        logger_search_display (argv_eol[2]);
+        return WEECHAT_RC_OK;
+    }
+
     WEECHAT_COMMAND_ERROR;
 }
 
@@ -957,14 +1508,24 @@ logger_buffer_renamed_signal_cb (const void *pointer, void *data,
 void
 logger_backlog (struct t_gui_buffer *buffer, const char *filename, int lines)
 {
-    const char *charset;
     struct t_logger_line *last_lines, *ptr_lines;
-    char *pos_message, *pos_tab, *error, *message;
-    time_t datetime, time_now;
-    struct tm tm_line;
-    int num_lines;
+    char *pos_message, *pos_tab, *error, *message, *last_time_string;
+    const char *time_format;
+    time_t datetime, time_now, last_datetime;
+    struct tm tm_now, tm_line;
+    int num_lines, last_time_length;
 
-    charset = weechat_info_get ("charset_terminal", "");
+    /*
+     * we get current time to initialize daylight saving time in
+     * structure tm_line, otherwise printed time will be shifted
+     * and will not use DST used on machine
+     */
+    time_now = time (NULL);
+    localtime_r (&time_now, &tm_now);
+    time_format = weechat_config_string (logger_config_file_time_format);
+    last_time_string = NULL;
+    last_time_length = 0;
+    last_datetime = 0;
 
     weechat_buffer_set (buffer, "print_hooks_enabled", "0");
 
@@ -977,27 +1538,41 @@ logger_backlog (struct t_gui_buffer *buffer, const char *filename, int lines)
         pos_message = strchr (ptr_lines->data, '\t');
         if (pos_message)
         {
-            /* initialize structure, because strptime does not do it */
-            memset (&tm_line, 0, sizeof (struct tm));
-            /*
-             * we get current time to initialize daylight saving time in
-             * structure tm_line, otherwise printed time will be shifted
-             * and will not use DST used on machine
-             */
-            time_now = time (NULL);
-            localtime_r (&time_now, &tm_line);
             pos_message[0] = '\0';
-            error = strptime (ptr_lines->data,
-                              weechat_config_string (logger_config_file_time_format),
-                              &tm_line);
-            if (error && !error[0] && (tm_line.tm_year > 0))
-                datetime = mktime (&tm_line);
+            if (last_time_string
+                && (pos_message - ptr_lines->data == last_time_length)
+                && (strncmp (ptr_lines->data, last_time_string,
+                             last_time_length) == 0))
+            {
+                /* same date as previous line: no need to parse it again */
+                datetime = last_datetime;
+            }
+            else
+            {
+                memcpy (&tm_line, &tm_now, sizeof (tm_line));
+                error = strptime (ptr_lines->data, time_format, &tm_line);
+                if (error && !error[0] && (tm_line.tm_year > 0))
+                    datetime = mktime (&tm_line);
+                last_time_string = ptr_lines->data;
+                last_time_length = pos_message - ptr_lines->data;
+                last_datetime = datetime;
+            }
             pos_message[0] = '\t';
         }
         pos_message = (pos_message && (datetime != 0)) ?
             pos_message + 1 : ptr_lines->data;
-        message = (charset) ?
-            weechat_iconv_to_internal (charset, pos_message) : strdup (pos_message);
+        if (logger_charset_utf8
+            && weechat_utf8_is_valid (pos_message, -1, NULL))
+        {
+            /* valid UTF-8 in a UTF-8 log file: no conversion needed */
+            message = strdup (pos_message);
+        }
+        else
+        {
+            message = (logger_charset) ?
+                weechat_iconv_to_internal (logger_charset, pos_message) :
+                strdup (pos_message);
+        }
         if (message)
         {
             pos_tab = strchr (message, '\t');
@@ -1244,8 +1819,6 @@ logger_print_cb (const void *pointer, void *data,
                  const char *prefix, const char *message)
 {
     struct t_logger_buffer *ptr_logger_buffer;
-    struct tm *date_tmp;
-    char buf_time[256];
     int line_log_level, prefix_is_nick;
 
     /* make C compiler happy */
@@ -1264,18 +1837,9 @@ logger_print_cb (const void *pointer, void *data,
             && (date > 0)
             && (line_log_level <= ptr_logger_buffer->log_level))
         {
-            buf_time[0] = '\0';
-            date_tmp = localtime (&date);
-            if (date_tmp)
-            {
-                strftime (buf_time, sizeof (buf_time) - 1,
-                          weechat_config_string (logger_config_file_time_format),
-                          date_tmp);
-            }
-
             logger_write_line (ptr_logger_buffer,
                                "%s\t%s%s%s\t%s",
-                               buf_time,
+                               logger_get_time_string (date),
                                (prefix && prefix_is_nick) ? weechat_config_string (logger_config_file_nick_prefix) : "",
                                (prefix) ? prefix : "",
                                (prefix && prefix_is_nick) ? weechat_config_string (logger_config_file_nick_suffix) : "",
@@ -1319,6 +1883,12 @@ weechat_plugin_init (struct t_weechat_plugin *plugin, int argc, char *argv[])
     if (!logger_config_init ())
         return WEECHAT_RC_ERROR;
 
+    /* charset of log files (no conversion needed if it is UTF-8) */
+    logger_charset = weechat_info_get ("charset_terminal", "");
+    logger_charset_utf8 = (logger_charset
+                           && (weechat_strcasecmp (logger_charset,
+                                                   "UTF-8") == 0));
+
     logger_config_read ();
 
     /* command /logger */
@@ -1328,13 +1898,18 @@ weechat_plugin_init (struct t_weechat_plugin *plugin, int argc, char *argv[])
         N_("list"
            " || set <level>"
            " || flush"
-           " || disable"),
+           " || disable"
+           " || search <words>"),
         N_("   list: show logging status for opened buffers\n"
            "    set: set logging level on current buffer\n"
            "  level: level for messages to be logged (0 = logging disabled, "
            "1 = a few messages (most important) .. 9 = all messages)\n"
            "  flush: write all log files now\n"
            "disable: disable logging on current buffer (set level to 0)\n"
+           " search: search lines with all words in log files of all buffers, "
+           "including rotated log files which are not compressed (words are "
+           "compared without case, the last lines found for each buffer are "
+           "displayed; see option logger.file.index to speed up the search)\n"
            "\n"
            "Options \"logger.level.*\" and \"logger.mask.*\" can be used to set "
            "level or mask for a buffer, or buffers beginning with name.\n"
@@ -1356,11 +1931,14 @@ weechat_plugin_init (struct t_weechat_plugin *plugin, int argc, char *argv[])
            "  disable logging for main WeeChat buffer:\n"
            "    /set logger.level.core.weechat 0\n"
            "  use a directory per IRC server and a file per channel inside:\n"
-           "    /set logger.mask.irc \"$server/$channel.weechatlog\""),
+           "    /set logger.mask.irc \"$server/$channel.weechatlog\"\n"
+           "  search lines with words \"weechat\" and \"release\" in logs:\n"
+           "    /logger search weechat release"),
         "list"
         " || set 1|2|3|4|5|6|7|8|9"
         " || flush"
-        " || disable",
+        " || disable"
+        " || search",
         &logger_command_cb, NULL, NULL);
 
     logger_start_buffer_all (1);
@@ -1407,6 +1985,12 @@ weechat_plugin_end (struct t_weechat_plugin *plugin)
 
     logger_stop_all (1);
 
+    if (logger_rotate_compressing)
+    {
+        weechat_hashtable_free (logger_rotate_compressing);
+        logger_rotate_compressing = NULL;
+    }
+
     logger_config_free ();
 
     return WEECHAT_RC_OK;
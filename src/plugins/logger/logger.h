@@ -27,11 +27,15 @@
 
 extern struct t_weechat_plugin *weechat_logger_plugin;
 
+struct t_hashtable;
+
 extern struct t_hook *logger_timer;
 
+extern void logger_time_string_reset ();
 extern void logger_start_buffer_all (int write_info_line);
 extern void logger_stop_all (int write_info_line);
 extern void logger_adjust_log_filenames ();
+extern struct t_hashtable *logger_search (const char *words, int max_lines);
 extern int logger_timer_cb (const void *pointer, void *data,
                             int remaining_calls);
 
@@ -28,6 +28,7 @@
 #include <errno.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 
 #ifdef HAVE_GNUTLS
 #include <gnutls/gnutls.h>
@@ -688,12 +689,76 @@ relay_client_recv_cb (const void *pointer, void *data, int fd)
     return WEECHAT_RC_OK;
 }
 
+/*
+ * Creates a new shared data (data sent to one or many clients).
+ *
+ * The data is used by the shared data (it is not copied) and must have been
+ * allocated with malloc; it is freed when the last reference to shared data
+ * is removed.
+ *
+ * Returns pointer to shared data (with one reference), NULL if error (in this
+ * case, data is not freed).
+ */
+
+struct t_relay_client_shared_data *
+relay_client_shared_data_new (char *data, int data_size)
+{
+    struct t_relay_client_shared_data *new_shared_data;
+
+    if (!data || (data_size <= 0))
+        return NULL;
+
+    new_shared_data = malloc (sizeof (*new_shared_data));
+    if (!new_shared_data)
+        return NULL;
+
+    new_shared_data->data = data;
+    new_shared_data->data_size = data_size;
+    new_shared_data->refcount = 1;
+
+    return new_shared_data;
+}
+
+/*
+ * Adds a reference to a shared data.
+ */
+
+void
+relay_client_shared_data_ref (struct t_relay_client_shared_data *shared_data)
+{
+    if (shared_data)
+        shared_data->refcount++;
+}
+
+/*
+ * Removes a reference to a shared data (the shared data is freed when there
+ * is no more reference to it).
+ */
+
+void
+relay_client_shared_data_unref (struct t_relay_client_shared_data *shared_data)
+{
+    if (!shared_data)
+        return;
+
+    shared_data->refcount--;
+    if (shared_data->refcount <= 0)
+    {
+        free (shared_data->data);
+        free (shared_data);
+    }
+}
+
 /*
  * Adds a message in out queue.
+ *
+ * If "shared_data" is not NULL, the message is a part of this shared data
+ * (a reference is added, data is not copied), otherwise the data is copied.
  */
 
 void
 relay_client_outqueue_add (struct t_relay_client *client,
+                           struct t_relay_client_shared_data *shared_data,
                            const char *data, int data_size,
                            enum t_relay_client_msg_type raw_msg_type[2],
                            int raw_flags[2],
@@ -701,6 +766,7 @@ relay_client_outqueue_add (struct t_relay_client *client,
                            int raw_size[2])
 {
     struct t_relay_client_outqueue *new_outqueue;
+    char *data_copy;
     int i;
 
     if (!client || !data || (data_size <= 0))
@@ -709,13 +775,28 @@ relay_client_outqueue_add (struct t_relay_client *client,
     new_outqueue = malloc (sizeof (*new_outqueue));
     if (new_outqueue)
     {
-        new_outqueue->data = malloc (data_size);
-        if (!new_outqueue->data)
+        if (shared_data)
         {
-            free (new_outqueue);
-            return;
+            relay_client_shared_data_ref (shared_data);
+            new_outqueue->shared_data = shared_data;
+            new_outqueue->data = data;
+        }
+        else
+        {
+            data_copy = malloc (data_size);
+            if (data_copy)
+                memcpy (data_copy, data, data_size);
+            new_outqueue->shared_data = relay_client_shared_data_new (
+                data_copy, data_size);
+            if (!new_outqueue->shared_data)
+            {
+                if (data_copy)
+                    free (data_copy);
+                free (new_outqueue);
+                return;
+            }
+            new_outqueue->data = data_copy;
         }
-        memcpy (new_outqueue->data, data, data_size);
         new_outqueue->data_size = data_size;
         for (i = 0; i < 2; i++)
         {
@@ -772,8 +853,7 @@ relay_client_outqueue_free (struct t_relay_client *client,
         (outqueue->next_outqueue)->prev_outqueue = outqueue->prev_outqueue;
 
     /* free data */
-    if (outqueue->data)
-        free (outqueue->data);
+    relay_client_shared_data_unref (outqueue->shared_data);
     if (outqueue->raw_message[0])
         free (outqueue->raw_message[0]);
     if (outqueue->raw_message[1])
@@ -797,9 +877,182 @@ relay_client_outqueue_free_all (struct t_relay_client *client)
     }
 }
 
+/*
+ * Sends buffers to client: with a single call to writev for a plain socket,
+ * and with one call to gnutls_record_send by buffer for SSL (stops at first
+ * buffer partially sent): with SSL, each buffer is sent in its own record, so
+ * a message must not be split in many buffers.
+ *
+ * Returns number of bytes sent to client, a negative value if error (value
+ * returned by writev or gnutls_record_send).
+ */
+
+int
+relay_client_send_iovec (struct t_relay_client *client,
+                         const struct iovec *iov, int iovcnt)
+{
+#ifdef HAVE_GNUTLS
+    int i, num_sent, total_sent;
+
+    if (client->ssl)
+    {
+        total_sent = 0;
+        for (i = 0; i < iovcnt; i++)
+        {
+            num_sent = gnutls_record_send (client->gnutls_sess,
+                                           iov[i].iov_base, iov[i].iov_len);
+            if (num_sent < 0)
+                return (total_sent > 0) ? total_sent : num_sent;
+            total_sent += num_sent;
+            if (num_sent < (int)iov[i].iov_len)
+                break;
+        }
+        return total_sent;
+    }
+#endif /* HAVE_GNUTLS */
+
+    return writev (client->sock, iov, iovcnt);
+}
+
+/*
+ * Checks error returned by function relay_client_send_iovec: if data can not
+ * be sent now, it will be sent later, otherwise the error is displayed and
+ * the client is disconnected.
+ *
+ * Returns:
+ *   1: data must be sent later
+ *   0: error, client disconnected
+ */
+
+int
+relay_client_send_error (struct t_relay_client *client, int num_sent)
+{
+#ifdef HAVE_GNUTLS
+    if (client->ssl)
+    {
+        if ((num_sent == GNUTLS_E_AGAIN) || (num_sent == GNUTLS_E_INTERRUPTED))
+            return 1;
+        weechat_printf_date_tags (
+            NULL, 0, "relay_client",
+            _("%s%s: sending data to client %s%s%s: error %d %s"),
+            weechat_prefix ("error"),
+            RELAY_PLUGIN_NAME,
+            RELAY_COLOR_CHAT_CLIENT,
+            client->desc,
+            RELAY_COLOR_CHAT,
+            num_sent,
+            gnutls_strerror (num_sent));
+        relay_client_set_status (client, RELAY_STATUS_DISCONNECTED);
+        return 0;
+    }
+#else
+    /* make C compiler happy */
+    (void) num_sent;
+#endif /* HAVE_GNUTLS */
+
+    if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+        return 1;
+    weechat_printf_date_tags (
+        NULL, 0, "relay_client",
+        _("%s%s: sending data to client %s%s%s: error %d %s"),
+        weechat_prefix ("error"),
+        RELAY_PLUGIN_NAME,
+        RELAY_COLOR_CHAT_CLIENT,
+        client->desc,
+        RELAY_COLOR_CHAT,
+        errno,
+        strerror (errno));
+    relay_client_set_status (client, RELAY_STATUS_DISCONNECTED);
+    return 0;
+}
+
+/*
+ * Sends messages from out queue (many messages at once), until all messages
+ * are sent or the client can not receive more data now.
+ */
+
+void
+relay_client_outqueue_send (struct t_relay_client *client)
+{
+    struct t_relay_client_outqueue *ptr_outqueue;
+    struct iovec iov[RELAY_CLIENT_OUTQUEUE_IOV_MAX];
+    int iovcnt, num_sent, i;
+
+    while (client->outqueue)
+    {
+        iovcnt = 0;
+        for (ptr_outqueue = client->outqueue;
+             ptr_outqueue && (iovcnt < RELAY_CLIENT_OUTQUEUE_IOV_MAX);
+             ptr_outqueue = ptr_outqueue->next_outqueue)
+        {
+            iov[iovcnt].iov_base = (void *)ptr_outqueue->data;
+            iov[iovcnt].iov_len = ptr_outqueue->data_size;
+            iovcnt++;
+        }
+
+        num_sent = relay_client_send_iovec (client, iov, iovcnt);
+        if (num_sent < 0)
+        {
+            /* error or client can not receive data now: retry later */
+            relay_client_send_error (client, num_sent);
+            return;
+        }
+
+        if (num_sent > 0)
+        {
+            client->bytes_sent += num_sent;
+            relay_buffer_refresh (NULL);
+        }
+
+        for (; iovcnt > 0; iovcnt--)
+        {
+            /* nothing sent from this message: retry later */
+            if (num_sent <= 0)
+                return;
+            ptr_outqueue = client->outqueue;
+            for (i = 0; i < 2; i++)
+            {
+                if (ptr_outqueue->raw_message[i])
+                {
+                    /*
+                     * print raw message and remove it from outqueue
+                     * (so that it is displayed only one time, even if
+                     * message is sent in many chunks)
+                     */
+                    relay_raw_print (client,
+                                     ptr_outqueue->raw_msg_type[i],
+                                     ptr_outqueue->raw_flags[i],
+                                     ptr_outqueue->raw_message[i],
+                                     ptr_outqueue->raw_size[i]);
+                    ptr_outqueue->raw_flags[i] = 0;
+                    free (ptr_outqueue->raw_message[i]);
+                    ptr_outqueue->raw_message[i] = NULL;
+                    ptr_outqueue->raw_size[i] = 0;
+                }
+            }
+            if (num_sent < ptr_outqueue->data_size)
+            {
+                /*
+                 * some data was not sent, update outqueue (without copy)
+                 * and stop sending data from outqueue
+                 */
+                ptr_outqueue->data += num_sent;
+                ptr_outqueue->data_size -= num_sent;
+                return;
+            }
+            /* whole data sent, remove outqueue */
+            num_sent -= ptr_outqueue->data_size;
+            relay_client_outqueue_free (client, ptr_outqueue);
+        }
+    }
+}
+
 /*
  * Sends data to client (adds in out queue if it's impossible to send now).
  *
+ * If "shared_data" is not NULL, the data is in this shared data, which is
+ * used in out queue (without copy) if the data can not be sent now.
+ *
  * If "message_raw_buffer" is not NULL, it is used for display in raw buffer
  * and replaces display of data, which is default.
  *
@@ -807,23 +1060,26 @@ relay_client_outqueue_free_all (struct t_relay_client *client)
  */
 
 int
-relay_client_send (struct t_relay_client *client,
-                   enum t_relay_client_msg_type msg_type,
-                   const char *data,
-                   int data_size, const char *message_raw_buffer)
+relay_client_send_data (struct t_relay_client *client,
+                        enum t_relay_client_msg_type msg_type,
+                        struct t_relay_client_shared_data *shared_data,
+                        const char *data,
+                        int data_size, const char *message_raw_buffer)
 {
-    int num_sent, raw_size[2], raw_flags[2], opcode, i;
+    int num_sent, raw_size[2], raw_flags[2], opcode, i, iovcnt;
+    int length_header, total_size, raw_sent;
     enum t_relay_client_msg_type raw_msg_type[2];
-    char *websocket_frame;
+    unsigned char frame_header[WEBSOCKET_FRAME_HEADER_MAX_SIZE];
+    const char *raw_msg[2];
+    char *frame;
+    struct iovec iov[2];
+#ifdef HAVE_GNUTLS
     unsigned long long length_frame;
-    const char *ptr_data, *raw_msg[2];
+#endif /* HAVE_GNUTLS */
 
     if (client->sock < 0)
         return -1;
 
-    ptr_data = data;
-    websocket_frame = NULL;
-
     /* set raw messages */
     for (i = 0; i < 2; i++)
     {
@@ -876,7 +1132,13 @@ relay_client_send (struct t_relay_client *client,
         }
     }
 
-    /* if websocket is initialized, encode data in a websocket frame */
+    /*
+     * if websocket is initialized, send a websocket frame header before
+     * data (data is not copied in a frame, except with SSL)
+     */
+    iovcnt = 0;
+    length_header = 0;
+    frame = NULL;
     if (client->websocket == 2)
     {
         switch (msg_type)
@@ -892,123 +1154,146 @@ relay_client_send (struct t_relay_client *client,
                     WEBSOCKET_FRAME_OPCODE_TEXT : WEBSOCKET_FRAME_OPCODE_BINARY;
                 break;
         }
-        websocket_frame = relay_websocket_encode_frame (opcode, data,
-                                                        data_size,
-                                                        &length_frame);
-        if (websocket_frame)
+#ifdef HAVE_GNUTLS
+        if (client->ssl)
         {
-            ptr_data = websocket_frame;
+            /*
+             * with SSL, header and data are sent in a single record (a
+             * separate header would be sent in its own small record)
+             */
+            frame = relay_websocket_encode_frame (opcode, data, data_size,
+                                                  &length_frame);
+            if (!frame)
+                return -1;
+            shared_data = NULL;
+            data = frame;
             data_size = length_frame;
         }
+        else
+#endif /* HAVE_GNUTLS */
+        {
+            length_header = relay_websocket_encode_frame_header (
+                opcode, data_size, frame_header);
+            iov[iovcnt].iov_base = frame_header;
+            iov[iovcnt].iov_len = length_header;
+            iovcnt++;
+        }
     }
+    iov[iovcnt].iov_base = (void *)data;
+    iov[iovcnt].iov_len = data_size;
+    iovcnt++;
+    total_size = length_header + data_size;
 
     num_sent = -1;
 
     /*
-     * if outqueue is not empty, add to outqueue
+     * if outqueue is empty, send data now, otherwise add to outqueue
      * (because message must be sent *after* messages already in outqueue)
      */
-    if (client->outqueue)
+    if (!client->outqueue)
     {
-        relay_client_outqueue_add (client, ptr_data, data_size,
-                                   raw_msg_type, raw_flags, raw_msg, raw_size);
+        num_sent = relay_client_send_iovec (client, iov, iovcnt);
+        if ((num_sent < 0) && !relay_client_send_error (client, num_sent))
+        {
+            if (frame)
+                free (frame);
+            return -1;
+        }
     }
-    else
-    {
-#ifdef HAVE_GNUTLS
-        if (client->ssl)
-            num_sent = gnutls_record_send (client->gnutls_sess, ptr_data, data_size);
-        else
-#endif /* HAVE_GNUTLS */
-            num_sent = send (client->sock, ptr_data, data_size, 0);
 
-        if (num_sent >= 0)
+    raw_sent = 0;
+    if (num_sent >= 0)
+    {
+        for (i = 0; i < 2; i++)
         {
-            for (i = 0; i < 2; i++)
-            {
-                if (raw_msg[i])
-                {
-                    relay_raw_print (client, raw_msg_type[i], raw_flags[i],
-                                     raw_msg[i], raw_size[i]);
-                }
-            }
-            if (num_sent > 0)
-            {
-                client->bytes_sent += num_sent;
-                relay_buffer_refresh (NULL);
-            }
-            if (num_sent < data_size)
+            if (raw_msg[i])
             {
-                /* some data was not sent, add it to outqueue */
-                relay_client_outqueue_add (client,
-                                           ptr_data + num_sent,
-                                           data_size - num_sent,
-                                           NULL, NULL, NULL, NULL);
+                relay_raw_print (client, raw_msg_type[i], raw_flags[i],
+                                 raw_msg[i], raw_size[i]);
             }
         }
-        else if (num_sent < 0)
+        raw_sent = 1;
+        if (num_sent > 0)
         {
-#ifdef HAVE_GNUTLS
-            if (client->ssl)
-            {
-                if ((num_sent == GNUTLS_E_AGAIN)
-                    || (num_sent == GNUTLS_E_INTERRUPTED))
-                {
-                    /* add message to queue (will be sent later) */
-                    relay_client_outqueue_add (client,
-                                               ptr_data, data_size,
-                                               raw_msg_type, raw_flags,
-                                               raw_msg, raw_size);
-                }
-                else
-                {
-                    weechat_printf_date_tags (
-                        NULL, 0, "relay_client",
-                        _("%s%s: sending data to client %s%s%s: error %d %s"),
-                        weechat_prefix ("error"),
-                        RELAY_PLUGIN_NAME,
-                        RELAY_COLOR_CHAT_CLIENT,
-                        client->desc,
-                        RELAY_COLOR_CHAT,
-                        num_sent,
-                        gnutls_strerror (num_sent));
-                    relay_client_set_status (client, RELAY_STATUS_DISCONNECTED);
-                }
-            }
-            else
-#endif /* HAVE_GNUTLS */
-            {
-                if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
-                {
-                    /* add message to queue (will be sent later) */
-                    relay_client_outqueue_add (client, ptr_data, data_size,
-                                               raw_msg_type, raw_flags,
-                                               raw_msg, raw_size);
-                }
-                else
-                {
-                    weechat_printf_date_tags (
-                        NULL, 0, "relay_client",
-                        _("%s%s: sending data to client %s%s%s: error %d %s"),
-                        weechat_prefix ("error"),
-                        RELAY_PLUGIN_NAME,
-                        RELAY_COLOR_CHAT_CLIENT,
-                        client->desc,
-                        RELAY_COLOR_CHAT,
-                        errno,
-                        strerror (errno));
-                    relay_client_set_status (client, RELAY_STATUS_DISCONNECTED);
-                }
-            }
+            client->bytes_sent += num_sent;
+            relay_buffer_refresh (NULL);
+        }
+    }
+
+    if (num_sent < total_size)
+    {
+        /*
+         * add data not sent to outqueue (with the raw messages if they were
+         * not displayed yet)
+         */
+        i = (num_sent > 0) ? num_sent : 0;
+        if (i < length_header)
+        {
+            relay_client_outqueue_add (client, NULL,
+                                       (const char *)frame_header + i,
+                                       length_header - i,
+                                       raw_msg_type, raw_flags,
+                                       (raw_sent) ? NULL : raw_msg, raw_size);
+            raw_sent = 1;
+            i = length_header;
         }
+        relay_client_outqueue_add (client, shared_data,
+                                   data + (i - length_header),
+                                   total_size - i,
+                                   raw_msg_type, raw_flags,
+                                   (raw_sent) ? NULL : raw_msg, raw_size);
     }
 
-    if (websocket_frame)
-        free (websocket_frame);
+    if (frame)
+        free (frame);
 
     return num_sent;
 }
 
+/*
+ * Sends data to client (adds in out queue if it's impossible to send now).
+ *
+ * If "message_raw_buffer" is not NULL, it is used for display in raw buffer
+ * and replaces display of data, which is default.
+ *
+ * Returns number of bytes sent to client, -1 if error.
+ */
+
+int
+relay_client_send (struct t_relay_client *client,
+                   enum t_relay_client_msg_type msg_type,
+                   const char *data,
+                   int data_size, const char *message_raw_buffer)
+{
+    return relay_client_send_data (client, msg_type, NULL, data, data_size,
+                                   message_raw_buffer);
+}
+
+/*
+ * Sends shared data to client (adds in out queue if it's impossible to send
+ * now): the same data can be sent to many clients, and it is never copied
+ * in out queues.
+ *
+ * If "message_raw_buffer" is not NULL, it is used for display in raw buffer
+ * and replaces display of data, which is default.
+ *
+ * Returns number of bytes sent to client, -1 if error.
+ */
+
+int
+relay_client_send_shared (struct t_relay_client *client,
+                          enum t_relay_client_msg_type msg_type,
+                          struct t_relay_client_shared_data *shared_data,
+                          const char *message_raw_buffer)
+{
+    if (!shared_data)
+        return -1;
+
+    return relay_client_send_data (client, msg_type, shared_data,
+                                   shared_data->data, shared_data->data_size,
+                                   message_raw_buffer);
+}
+
 /*
  * Timer callback, called each second.
  */
@@ -1017,8 +1302,7 @@ int
 relay_client_timer_cb (const void *pointer, void *data, int remaining_calls)
 {
     struct t_relay_client *ptr_client, *ptr_next_client;
-    int num_sent, i, purge_delay;
-    char *buf;
+    int purge_delay;
     time_t current_time;
 
     /* make C compiler happy */
@@ -1046,133 +1330,7 @@ relay_client_timer_cb (const void *pointer, void *data, int remaining_calls)
         }
         else if (ptr_client->sock >= 0)
         {
-            while (ptr_client->outqueue)
-            {
-#ifdef HAVE_GNUTLS
-                if (ptr_client->ssl)
-                {
-                    num_sent = gnutls_record_send (ptr_client->gnutls_sess,
-                                                   ptr_client->outqueue->data,
-                                                   ptr_client->outqueue->data_size);
-                }
-                else
-#endif /* HAVE_GNUTLS */
-                {
-                    num_sent = send (ptr_client->sock,
-                                     ptr_client->outqueue->data,
-                                     ptr_client->outqueue->data_size, 0);
-                }
-                if (num_sent >= 0)
-                {
-                    for (i = 0; i < 2; i++)
-                    {
-                        if (ptr_client->outqueue->raw_message[i])
-                        {
-                            /*
-                             * print raw message and remove it from outqueue
-                             * (so that it is displayed only one time, even if
-                             * message is sent in many chunks)
-                             */
-                            relay_raw_print (
-                                ptr_client,
-                                ptr_client->outqueue->raw_msg_type[i],
-                                ptr_client->outqueue->raw_flags[i],
-                                ptr_client->outqueue->raw_message[i],
-                                ptr_client->outqueue->raw_size[i]);
-                            ptr_client->outqueue->raw_flags[i] = 0;
-                            free (ptr_client->outqueue->raw_message[i]);
-                            ptr_client->outqueue->raw_message[i] = NULL;
-                            ptr_client->outqueue->raw_size[i] = 0;
-                        }
-                    }
-                    if (num_sent > 0)
-                    {
-                        ptr_client->bytes_sent += num_sent;
-                        relay_buffer_refresh (NULL);
-                    }
-                    if (num_sent == ptr_client->outqueue->data_size)
-                    {
-                        /* whole data sent, remove outqueue */
-                        relay_client_outqueue_free (ptr_client,
-                                                    ptr_client->outqueue);
-                    }
-                    else
-                    {
-                        /*
-                         * some data was not sent, update outqueue and stop
-                         * sending data from outqueue
-                         */
-                        if (num_sent > 0)
-                        {
-                            buf = malloc (ptr_client->outqueue->data_size - num_sent);
-                            if (buf)
-                            {
-                                memcpy (buf,
-                                        ptr_client->outqueue->data + num_sent,
-                                        ptr_client->outqueue->data_size - num_sent);
-                                free (ptr_client->outqueue->data);
-                                ptr_client->outqueue->data = buf;
-                                ptr_client->outqueue->data_size = ptr_client->outqueue->data_size - num_sent;
-                            }
-                        }
-                        break;
-                    }
-                }
-                else if (num_sent < 0)
-                {
-#ifdef HAVE_GNUTLS
-                    if (ptr_client->ssl)
-                    {
-                        if ((num_sent == GNUTLS_E_AGAIN)
-                            || (num_sent == GNUTLS_E_INTERRUPTED))
-                        {
-                            /* we will retry later this client's queue */
-                            break;
-                        }
-                        else
-                        {
-                            weechat_printf_date_tags (
-                                NULL, 0, "relay_client",
-                                _("%s%s: sending data to client %s%s%s: "
-                                  "error %d %s"),
-                                weechat_prefix ("error"),
-                                RELAY_PLUGIN_NAME,
-                                RELAY_COLOR_CHAT_CLIENT,
-                                ptr_client->desc,
-                                RELAY_COLOR_CHAT,
-                                num_sent,
-                                gnutls_strerror (num_sent));
-                            relay_client_set_status (ptr_client,
-                                                     RELAY_STATUS_DISCONNECTED);
-                        }
-                    }
-                    else
-#endif /* HAVE_GNUTLS */
-                    {
-                        if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
-                        {
-                            /* we will retry later this client's queue */
-                            break;
-                        }
-                        else
-                        {
-                            weechat_printf_date_tags (
-                                NULL, 0, "relay_client",
-                                _("%s%s: sending data to client %s%s%s: "
-                                  "error %d %s"),
-                                weechat_prefix ("error"),
-                                RELAY_PLUGIN_NAME,
-                                RELAY_COLOR_CHAT_CLIENT,
-                                ptr_client->desc,
-                                RELAY_COLOR_CHAT,
-                                errno,
-                                strerror (errno));
-                            relay_client_set_status (ptr_client,
-                                                     RELAY_STATUS_DISCONNECTED);
-                        }
-                    }
-                }
-            }
+            relay_client_outqueue_send (ptr_client);
         }
 
         ptr_client = ptr_next_client;
@@ -66,12 +66,26 @@ enum t_relay_client_msg_type
     ((client->status == RELAY_STATUS_AUTH_FAILED) ||                    \
      (client->status == RELAY_STATUS_DISCONNECTED))
 
-/* output queue of messages to client */
+/* max number of messages of out queue sent with a single call to writev */
 
-struct t_relay_client_outqueue
+#define RELAY_CLIENT_OUTQUEUE_IOV_MAX 64
+
+/* data sent to clients (read-only, can be shared by many out queues) */
+
+struct t_relay_client_shared_data
 {
     char *data;                         /* data to send                     */
     int data_size;                      /* number of bytes                  */
+    int refcount;                       /* number of references to data    */
+};
+
+/* output queue of messages to client */
+
+struct t_relay_client_outqueue
+{
+    struct t_relay_client_shared_data *shared_data; /* data to send         */
+    const char *data;                   /* data not yet sent (in shared)    */
+    int data_size;                      /* number of bytes not yet sent     */
     int raw_msg_type[2];                /* msgs types                       */
     int raw_flags[2];                   /* flags for raw messages           */
     char *raw_message[2];               /* msgs for raw buffer (can be NULL)*/
@@ -132,10 +146,18 @@ extern int relay_client_status_search (const char *name);
 extern int relay_client_count_active_by_port (int server_port);
 extern void relay_client_set_desc (struct t_relay_client *client);
 extern int relay_client_recv_cb (const void *pointer, void *data, int fd);
+extern struct t_relay_client_shared_data *relay_client_shared_data_new (char *data,
+                                                                        int data_size);
+extern void relay_client_shared_data_ref (struct t_relay_client_shared_data *shared_data);
+extern void relay_client_shared_data_unref (struct t_relay_client_shared_data *shared_data);
 extern int relay_client_send (struct t_relay_client *client,
                               enum t_relay_client_msg_type msg_type,
                               const char *data,
                               int data_size, const char *message_raw_buffer);
+extern int relay_client_send_shared (struct t_relay_client *client,
+                                     enum t_relay_client_msg_type msg_type,
+                                     struct t_relay_client_shared_data *shared_data,
+                                     const char *message_raw_buffer);
 extern int relay_client_timer_cb (const void *pointer, void *data,
                                   int remaining_calls);
 extern struct t_relay_client *relay_client_new (int sock, const char *address,
@@ -334,6 +334,53 @@ relay_websocket_decode_frame (const unsigned char *buffer,
     return 1;
 }
 
+/*
+ * Encodes the header of a websocket frame (opcode and length of data), which
+ * is sent before the data (not masked).
+ *
+ * Argument "header" must have a size of at least
+ * WEBSOCKET_FRAME_HEADER_MAX_SIZE bytes.
+ *
+ * Returns the length of header.
+ */
+
+int
+relay_websocket_encode_frame_header (int opcode,
+                                     unsigned long long length,
+                                     unsigned char *header)
+{
+    header[0] = 0x80;
+    header[0] |= opcode;
+
+    if (length <= 125)
+    {
+        /* length on one byte */
+        header[1] = length;
+        return 2;
+    }
+
+    if ((length >= 126) && (length <= 65535))
+    {
+        /* length on 2 bytes */
+        header[1] = 126;
+        header[2] = (length >> 8) & 0xFF;
+        header[3] = length & 0xFF;
+        return 4;
+    }
+
+    /* length on 8 bytes */
+    header[1] = 127;
+    header[2] = (length >> 56) & 0xFF;
+    header[3] = (length >> 48) & 0xFF;
+    header[4] = (length >> 40) & 0xFF;
+    header[5] = (length >> 32) & 0xFF;
+    header[6] = (length >> 24) & 0xFF;
+    header[7] = (length >> 16) & 0xFF;
+    header[8] = (length >> 8) & 0xFF;
+    header[9] = length & 0xFF;
+    return 10;
+}
+
 /*
  * Encodes data in a websocket frame.
  *
@@ -354,41 +401,11 @@ relay_websocket_encode_frame (int opcode,
 
     *length_frame = 0;
 
-    frame = malloc (length + 10);
+    frame = malloc (length + WEBSOCKET_FRAME_HEADER_MAX_SIZE);
     if (!frame)
         return NULL;
 
-    frame[0] = 0x80;
-    frame[0] |= opcode;
-
-    if (length <= 125)
-    {
-        /* length on one byte */
-        frame[1] = length;
-        index = 2;
-    }
-    else if ((length >= 126) && (length <= 65535))
-    {
-        /* length on 2 bytes */
-        frame[1] = 126;
-        frame[2] = (length >> 8) & 0xFF;
-        frame[3] = length & 0xFF;
-        index = 4;
-    }
-    else
-    {
-        /* length on 8 bytes */
-        frame[1] = 127;
-        frame[2] = (length >> 56) & 0xFF;
-        frame[3] = (length >> 48) & 0xFF;
-        frame[4] = (length >> 40) & 0xFF;
-        frame[5] = (length >> 32) & 0xFF;
-        frame[6] = (length >> 24) & 0xFF;
-        frame[7] = (length >> 16) & 0xFF;
-        frame[8] = (length >> 8) & 0xFF;
-        frame[9] = length & 0xFF;
-        index = 10;
-    }
+    index = relay_websocket_encode_frame_header (opcode, length, frame);
 
     /* copy buffer after length */
     memcpy (frame + index, buffer, length);
@@ -27,6 +27,9 @@
 #define WEBSOCKET_FRAME_OPCODE_PING         0x09
 #define WEBSOCKET_FRAME_OPCODE_PONG         0x0A
 
+/* max size of frame header: opcode (1 byte) + length (up to 9 bytes) */
+#define WEBSOCKET_FRAME_HEADER_MAX_SIZE     10
+
 extern int relay_websocket_is_http_get_weechat (const char *message);
 extern void relay_websocket_save_header (struct t_relay_client *client,
                                          const char *message);
@@ -38,6 +41,9 @@ extern int relay_websocket_decode_frame (const unsigned char *buffer,
                                          unsigned long long length,
                                          unsigned char *decoded,
                                          unsigned long long *decoded_length);
+extern int relay_websocket_encode_frame_header (int opcode,
+                                               unsigned long long length,
+                                               unsigned char *header);
 extern char *relay_websocket_encode_frame (int opcode,
                                            const char *buffer,
                                            unsigned long long length,
@@ -34,6 +34,7 @@
 #include "relay-raw.h"
 #include "relay-server.h"
 #include "relay-upgrade.h"
+#include "weechat/relay-weechat-msg.h"
 
 
 WEECHAT_PLUGIN_NAME(RELAY_PLUGIN_NAME);
@@ -262,6 +263,8 @@ weechat_plugin_end (struct t_weechat_plugin *plugin)
         relay_client_free_all ();
     }
 
+    relay_weechat_msg_free_last_compressed ();
+
     relay_network_end ();
 
     relay_config_free ();
@@ -29,6 +29,7 @@
 #include <errno.h>
 #include <arpa/inet.h>
 #include <zlib.h>
+#include <gcrypt.h>
 
 #include "../../weechat-plugin.h"
 #include "../relay.h"
@@ -41,6 +42,20 @@
 #include "../relay-raw.h"
 
 
+/*
+ * last message compressed: it is sent to all clients synchronized (without
+ * compressing it again for each client); it is kept only when many clients
+ * use compression, and freed at the end of the main loop iteration
+ */
+unsigned char relay_weechat_msg_last_hash[RELAY_WEECHAT_MSG_HASH_SIZE];
+                                           /* hash of message               */
+int relay_weechat_msg_last_data_size = 0;  /* size of message               */
+int relay_weechat_msg_last_level = 0;      /* compression level used        */
+struct t_relay_client_shared_data *relay_weechat_msg_last_compressed = NULL;
+                                           /* compressed message            */
+struct t_hook *relay_weechat_msg_hook_timer_last = NULL;
+                                           /* timer to free last message    */
+
 /*
  * Builds a new message (for sending to client).
  *
@@ -1011,61 +1026,225 @@ relay_weechat_msg_add_nicklist (struct t_relay_weechat_msg *msg,
 }
 
 /*
- * Sends a message.
+ * Returns the number of clients connected with weechat protocol and zlib
+ * compression.
+ */
+
+int
+relay_weechat_msg_count_clients_zlib ()
+{
+    struct t_relay_client *ptr_client;
+    int count;
+
+    count = 0;
+    for (ptr_client = relay_clients; ptr_client;
+         ptr_client = ptr_client->next_client)
+    {
+        if ((ptr_client->protocol == RELAY_PROTOCOL_WEECHAT)
+            && ptr_client->protocol_data
+            && !RELAY_CLIENT_HAS_ENDED(ptr_client)
+            && (RELAY_WEECHAT_DATA(ptr_client, compression) ==
+                RELAY_WEECHAT_COMPRESSION_ZLIB))
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/*
+ * Frees the last message compressed.
  */
 
 void
-relay_weechat_msg_send (struct t_relay_client *client,
-                        struct t_relay_weechat_msg *msg)
+relay_weechat_msg_free_last_compressed ()
 {
+    if (relay_weechat_msg_hook_timer_last)
+    {
+        weechat_unhook (relay_weechat_msg_hook_timer_last);
+        relay_weechat_msg_hook_timer_last = NULL;
+    }
+    memset (relay_weechat_msg_last_hash, 0,
+            sizeof (relay_weechat_msg_last_hash));
+    relay_weechat_msg_last_data_size = 0;
+    relay_weechat_msg_last_level = 0;
+    if (relay_weechat_msg_last_compressed)
+    {
+        relay_client_shared_data_unref (relay_weechat_msg_last_compressed);
+        relay_weechat_msg_last_compressed = NULL;
+    }
+}
+
+/*
+ * Callback of timer used to free the last message compressed (called when
+ * WeeChat goes back in its main loop, after the message has been sent to all
+ * clients).
+ */
+
+int
+relay_weechat_msg_timer_last_cb (const void *pointer, void *data,
+                                 int remaining_calls)
+{
+    /* make C compiler happy */
+    (void) pointer;
+    (void) data;
+    (void) remaining_calls;
+
+    /* timer is removed after this call (last call) */
+    relay_weechat_msg_hook_timer_last = NULL;
+
+    relay_weechat_msg_free_last_compressed ();
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Compresses a message with zlib.
+ *
+ * If many clients use compression and the message is the same as the last
+ * message compressed (for example the same signal sent to many clients), the
+ * compressed data is reused (messages are compared with a hash of their
+ * content).
+ *
+ * Argument "raw_message" is set with the message to display in raw buffer.
+ *
+ * Returns compressed data (with header: size and compression flag), NULL if
+ * error or if the compressed data is not smaller than the message.
+ *
+ * Note: result must be released after use with function
+ * relay_client_shared_data_unref().
+ */
+
+struct t_relay_client_shared_data *
+relay_weechat_msg_compress_zlib (struct t_relay_weechat_msg *msg, int level,
+                                 char *raw_message, int raw_message_size)
+{
+    struct t_relay_client_shared_data *compressed;
+    unsigned char hash[RELAY_WEECHAT_MSG_HASH_SIZE];
     uint32_t size32;
-    char compression, raw_message[1024];
     int rc;
     Bytef *dest;
     uLongf dest_size;
     struct timeval tv1, tv2;
     long long time_diff;
+    int cache;
+
+    /* compressed data can be reused only if many clients use compression */
+    cache = (relay_weechat_msg_count_clients_zlib () > 1);
+
+    /* hash of message (without size and compression flag) */
+    if (cache)
+    {
+        gcry_md_hash_buffer (RELAY_WEECHAT_MSG_HASH_ALGO, hash,
+                             msg->data + 5, msg->data_size - 5);
+    }
+
+    /* same message as the last one compressed? then reuse compressed data */
+    if (cache
+        && relay_weechat_msg_last_compressed
+        && (level == relay_weechat_msg_last_level)
+        && (msg->data_size == relay_weechat_msg_last_data_size)
+        && (memcmp (hash, relay_weechat_msg_last_hash, sizeof (hash)) == 0))
+    {
+        compressed = relay_weechat_msg_last_compressed;
+        snprintf (raw_message, raw_message_size,
+                  "obj: %d/%d bytes (%d%%, cached), id: %s",
+                  compressed->data_size,
+                  msg->data_size,
+                  100 - ((compressed->data_size * 100) / msg->data_size),
+                  msg->id);
+        relay_client_shared_data_ref (compressed);
+        return compressed;
+    }
+
+    dest_size = compressBound (msg->data_size - 5);
+    dest = malloc (dest_size + 5);
+    if (!dest)
+        return NULL;
 
-    if (weechat_config_integer (relay_config_network_compression_level) > 0)
+    gettimeofday (&tv1, NULL);
+    rc = compress2 (dest + 5, &dest_size,
+                    (Bytef *)(msg->data + 5), msg->data_size - 5,
+                    level);
+    gettimeofday (&tv2, NULL);
+    time_diff = weechat_util_timeval_diff (&tv1, &tv2);
+    if ((rc != Z_OK) || ((int)dest_size + 5 >= msg->data_size))
+    {
+        free (dest);
+        return NULL;
+    }
+
+    /* set size and compression flag */
+    size32 = htonl ((uint32_t)(dest_size + 5));
+    memcpy (dest, &size32, 4);
+    dest[4] = RELAY_WEECHAT_COMPRESSION_ZLIB;
+
+    compressed = relay_client_shared_data_new ((char *)dest, dest_size + 5);
+    if (!compressed)
+    {
+        free (dest);
+        return NULL;
+    }
+
+    /* display message in raw buffer */
+    snprintf (raw_message, raw_message_size,
+              "obj: %d/%d bytes (%d%%, %.2fms), id: %s",
+              (int)dest_size + 5,
+              msg->data_size,
+              100 - ((((int)dest_size + 5) * 100) / msg->data_size),
+              ((float)time_diff) / 1000,
+              msg->id);
+
+    /*
+     * keep compressed data, to reuse it if the same message is sent again
+     * to other clients (it is freed when WeeChat goes back in its main loop)
+     */
+    if (cache)
+    {
+        relay_weechat_msg_free_last_compressed ();
+        memcpy (relay_weechat_msg_last_hash, hash, sizeof (hash));
+        relay_weechat_msg_last_data_size = msg->data_size;
+        relay_weechat_msg_last_level = level;
+        relay_client_shared_data_ref (compressed);
+        relay_weechat_msg_last_compressed = compressed;
+        relay_weechat_msg_hook_timer_last = weechat_hook_timer (
+            1, 0, 1,
+            &relay_weechat_msg_timer_last_cb, NULL, NULL);
+    }
+
+    return compressed;
+}
+
+/*
+ * Sends a message.
+ */
+
+void
+relay_weechat_msg_send (struct t_relay_client *client,
+                        struct t_relay_weechat_msg *msg)
+{
+    struct t_relay_client_shared_data *compressed;
+    uint32_t size32;
+    char compression, raw_message[1024];
+    int level;
+
+    level = weechat_config_integer (relay_config_network_compression_level);
+    if (level > 0)
     {
         switch (RELAY_WEECHAT_DATA(client, compression))
         {
             case RELAY_WEECHAT_COMPRESSION_ZLIB:
-                dest_size = compressBound (msg->data_size - 5);
-                dest = malloc (dest_size + 5);
-                if (dest)
+                compressed = relay_weechat_msg_compress_zlib (
+                    msg, level, raw_message, sizeof (raw_message));
+                if (compressed)
                 {
-                    gettimeofday (&tv1, NULL);
-                    rc = compress2 (dest + 5, &dest_size,
-                                    (Bytef *)(msg->data + 5), msg->data_size - 5,
-                                    weechat_config_integer (relay_config_network_compression_level));
-                    gettimeofday (&tv2, NULL);
-                    time_diff = weechat_util_timeval_diff (&tv1, &tv2);
-                    if ((rc == Z_OK) && ((int)dest_size + 5 < msg->data_size))
-                    {
-                        /* set size and compression flag */
-                        size32 = htonl ((uint32_t)(dest_size + 5));
-                        memcpy (dest, &size32, 4);
-                        dest[4] = RELAY_WEECHAT_COMPRESSION_ZLIB;
-
-                        /* display message in raw buffer */
-                        snprintf (raw_message, sizeof (raw_message),
-                                  "obj: %d/%d bytes (%d%%, %.2fms), id: %s",
-                                  (int)dest_size + 5,
-                                  msg->data_size,
-                                  100 - ((((int)dest_size + 5) * 100) / msg->data_size),
-                                  ((float)time_diff) / 1000,
-                                  msg->id);
-
-                        /* send compressed data */
-                        relay_client_send (client, RELAY_CLIENT_MSG_STANDARD,
-                                           (const char *)dest, dest_size + 5,
-                                           raw_message);
-
-                        free (dest);
-                        return;
-                    }
-                    free (dest);
+                    /* send compressed data (shared with other clients) */
+                    relay_client_send_shared (client,
+                                              RELAY_CLIENT_MSG_STANDARD,
+                                              compressed, raw_message);
+                    relay_client_shared_data_unref (compressed);
+                    return;
                 }
                 break;
             default:
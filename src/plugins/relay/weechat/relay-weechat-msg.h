@@ -24,6 +24,10 @@ struct t_relay_weechat_nicklist;
 
 #define RELAY_WEECHAT_MSG_INITIAL_ALLOC 4096
 
+/* hash of message (to reuse compressed data of the same message) */
+#define RELAY_WEECHAT_MSG_HASH_ALGO GCRY_MD_SHA256
+#define RELAY_WEECHAT_MSG_HASH_SIZE 32
+
 /* object ids in binary messages */
 #define RELAY_WEECHAT_MSG_OBJ_CHAR      "chr"
 #define RELAY_WEECHAT_MSG_OBJ_INT       "int"
@@ -77,6 +81,7 @@ extern void relay_weechat_msg_add_infolist (struct t_relay_weechat_msg *msg,
 extern void relay_weechat_msg_add_nicklist (struct t_relay_weechat_msg *msg,
                                             struct t_gui_buffer *buffer,
                                             struct t_relay_weechat_nicklist *nicklist);
+extern void relay_weechat_msg_free_last_compressed ();
 extern void relay_weechat_msg_send (struct t_relay_client *client,
                                     struct t_relay_weechat_msg *msg);
 extern void relay_weechat_msg_free (struct t_relay_weechat_msg *msg);
@@ -883,6 +883,27 @@ relay_weechat_protocol_hsignal_nicklist_cb (const void *pointer, void *data,
                                          RELAY_WEECHAT_PROTOCOL_SYNC_NICKLIST))
         return WEECHAT_RC_OK;
 
+    /*
+     * nicklist changed in bulk mode (for example many nicks added): forget
+     * diffs and send whole nicklist
+     */
+    if (strcmp (signal, "nicklist_changed") == 0)
+    {
+        ptr_nicklist = relay_weechat_nicklist_new ();
+        if (!ptr_nicklist)
+            return WEECHAT_RC_OK;
+        weechat_hashtable_set (RELAY_WEECHAT_DATA(ptr_client, buffers_nicklist),
+                               ptr_buffer,
+                               ptr_nicklist);
+        if (RELAY_WEECHAT_DATA(ptr_client, hook_timer_nicklist))
+        {
+            weechat_unhook (RELAY_WEECHAT_DATA(ptr_client, hook_timer_nicklist));
+            RELAY_WEECHAT_DATA(ptr_client, hook_timer_nicklist) = NULL;
+        }
+        relay_weechat_hook_timer_nicklist (ptr_client);
+        return WEECHAT_RC_OK;
+    }
+
     parent_group = weechat_hashtable_get (hashtable, "parent_group");
     group = weechat_hashtable_get (hashtable, "group");
     nick = weechat_hashtable_get (hashtable, "nick");
@@ -54,6 +54,7 @@ IMPORT_TEST_GROUP(Hashtable);
 IMPORT_TEST_GROUP(Hdata);
 IMPORT_TEST_GROUP(Infolist);
 IMPORT_TEST_GROUP(List);
+IMPORT_TEST_GROUP(Slab);
 IMPORT_TEST_GROUP(String);
 IMPORT_TEST_GROUP(Url);
 IMPORT_TEST_GROUP(Utf8);
@@ -116,6 +116,8 @@ TEST(Hashtable, New)
     LONGS_EQUAL(32, hashtable->size);
     CHECK(hashtable->htable);
     LONGS_EQUAL(0, hashtable->items_count);
+    POINTERS_EQUAL(NULL, hashtable->oldest_item);
+    POINTERS_EQUAL(NULL, hashtable->newest_item);
     LONGS_EQUAL(HASHTABLE_STRING, hashtable->type_keys);
     LONGS_EQUAL(HASHTABLE_INTEGER, hashtable->type_values);
     POINTERS_EQUAL(&test_hashtable_hash_key_cb, hashtable->callback_hash_key);
@@ -332,6 +334,40 @@ TEST(Hashtable, SetGetRemove)
     hashtable_free (hashtable);
 }
 
+/*
+ * Test callback for hashtable_map: concatenates keys in a string.
+ */
+
+void
+test_hashtable_map_cb (void *data, struct t_hashtable *hashtable,
+                       const void *key, const void *value)
+{
+    /* make C++ compiler happy */
+    (void) hashtable;
+    (void) value;
+
+    if (((char *)data)[0])
+        strcat ((char *)data, ",");
+    strcat ((char *)data, (const char *)key);
+}
+
+/*
+ * Test callback for hashtable_map_string: concatenates values in a string.
+ */
+
+void
+test_hashtable_map_string_cb (void *data, struct t_hashtable *hashtable,
+                              const char *key, const char *value)
+{
+    /* make C++ compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    if (((char *)data)[0])
+        strcat ((char *)data, ",");
+    strcat ((char *)data, value);
+}
+
 /*
  * Tests functions:
  *   hashtable_map
@@ -340,7 +376,107 @@ TEST(Hashtable, SetGetRemove)
 
 TEST(Hashtable, Map)
 {
-    /* TODO: write tests */
+    struct t_hashtable *hashtable;
+    int value;
+    char str[256];
+
+    hashtable = hashtable_new (8,
+                               WEECHAT_HASHTABLE_STRING,
+                               WEECHAT_HASHTABLE_INTEGER,
+                               NULL,
+                               NULL);
+    CHECK(hashtable);
+
+    /* items are returned in insertion order */
+    value = 1;
+    hashtable_set (hashtable, "weechat", &value);
+    value = 2;
+    hashtable_set (hashtable, "fast", &value);
+    value = 3;
+    hashtable_set (hashtable, "light", &value);
+    value = 4;
+    hashtable_set (hashtable, "extensible", &value);
+
+    str[0] = '\0';
+    hashtable_map (hashtable, &test_hashtable_map_cb, str);
+    STRCMP_EQUAL("weechat,fast,light,extensible", str);
+
+    str[0] = '\0';
+    hashtable_map_string (hashtable, &test_hashtable_map_string_cb, str);
+    STRCMP_EQUAL("1,2,3,4", str);
+
+    /* updating an item does not change order */
+    value = 5;
+    hashtable_set (hashtable, "fast", &value);
+    str[0] = '\0';
+    hashtable_map (hashtable, &test_hashtable_map_cb, str);
+    STRCMP_EQUAL("weechat,fast,light,extensible", str);
+
+    /* remove items (first, middle, last) */
+    hashtable_remove (hashtable, "weechat");
+    hashtable_remove (hashtable, "light");
+    hashtable_remove (hashtable, "extensible");
+    str[0] = '\0';
+    hashtable_map (hashtable, &test_hashtable_map_cb, str);
+    STRCMP_EQUAL("fast", str);
+    POINTERS_EQUAL(hashtable->oldest_item, hashtable->newest_item);
+
+    hashtable_free (hashtable);
+}
+
+/*
+ * Tests functions:
+ *   hashtable_set (with automatic resize)
+ */
+
+TEST(Hashtable, Resize)
+{
+    struct t_hashtable *hashtable;
+    struct t_hashtable_item *ptr_item, *item_first;
+    int i, value;
+    char key[32];
+
+    hashtable = hashtable_new (4,
+                               WEECHAT_HASHTABLE_STRING,
+                               WEECHAT_HASHTABLE_INTEGER,
+                               NULL,
+                               NULL);
+    CHECK(hashtable);
+
+    item_first = NULL;
+    for (i = 0; i < 1000; i++)
+    {
+        snprintf (key, sizeof (key), "key%d", i);
+        value = i;
+        ptr_item = hashtable_set (hashtable, key, &value);
+        CHECK(ptr_item);
+        if (i == 0)
+            item_first = ptr_item;
+    }
+    LONGS_EQUAL(1000, hashtable->items_count);
+    CHECK(hashtable->size >= 1000 / HASHTABLE_LOAD_FACTOR_MAX);
+
+    /* items are not moved in memory by resize */
+    POINTERS_EQUAL(item_first, hashtable_get_item (hashtable, "key0", NULL));
+
+    /* all items are still found, and are still sorted by creation */
+    i = 0;
+    for (ptr_item = hashtable->oldest_item; ptr_item;
+         ptr_item = ptr_item->next_created_item)
+    {
+        snprintf (key, sizeof (key), "key%d", i);
+        STRCMP_EQUAL(key, (const char *)ptr_item->key);
+        LONGS_EQUAL(i, *((int *)hashtable_get (hashtable, key)));
+        i++;
+    }
+    LONGS_EQUAL(1000, i);
+
+    hashtable_remove_all (hashtable);
+    LONGS_EQUAL(0, hashtable->items_count);
+    POINTERS_EQUAL(NULL, hashtable->oldest_item);
+    POINTERS_EQUAL(NULL, hashtable->newest_item);
+
+    hashtable_free (hashtable);
 }
 
 /*
@@ -0,0 +1,137 @@
+/*
+ * test-slab.cpp - test slab allocator functions
+ *
+ * Copyright (C) 2016 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include <string.h>
+#include "src/core/wee-slab.h"
+}
+
+TEST_GROUP(Slab)
+{
+};
+
+/*
+ * Tests functions:
+ *   slab_new
+ *   slab_free
+ */
+
+TEST(Slab, New)
+{
+    struct t_slab *slab;
+
+    POINTERS_EQUAL(NULL, slab_new (0, 4, 16));
+    POINTERS_EQUAL(NULL, slab_new (-1, 4, 16));
+    POINTERS_EQUAL(NULL, slab_new (16, 0, 16));
+    POINTERS_EQUAL(NULL, slab_new (16, 8, 4));
+
+    slab = slab_new (1, 4, 16);
+    CHECK(slab);
+    LONGS_EQUAL(8, slab->item_size);
+    LONGS_EQUAL(4, slab->chunk_size_min);
+    LONGS_EQUAL(16, slab->chunk_size_max);
+    POINTERS_EQUAL(NULL, slab->chunks);
+    LONGS_EQUAL(0, slab->chunks_count);
+    LONGS_EQUAL(0, slab->items_count);
+    LONGS_EQUAL(0, slab->items_alloc);
+    slab_free (slab);
+
+    slab = slab_new (13, 4, 16);
+    CHECK(slab);
+    LONGS_EQUAL(16, slab->item_size);
+    slab_free (slab);
+
+    /* test free of NULL slab */
+    slab_free (NULL);
+}
+
+/*
+ * Tests functions:
+ *   slab_alloc
+ *   slab_release
+ *   slab_clear
+ */
+
+TEST(Slab, AllocRelease)
+{
+    struct t_slab *slab;
+    void *items[32], *item;
+    int i;
+
+    POINTERS_EQUAL(NULL, slab_alloc (NULL));
+
+    slab = slab_new (24, 4, 16);
+    CHECK(slab);
+
+    /* chunks of 4, 8, 16, 16 items */
+    for (i = 0; i < 32; i++)
+    {
+        items[i] = slab_alloc (slab);
+        CHECK(items[i]);
+        memset (items[i], 'a', 24);
+    }
+    LONGS_EQUAL(32, slab->items_count);
+    LONGS_EQUAL(4, slab->chunks_count);
+    LONGS_EQUAL(44, slab->items_alloc);
+    LONGS_EQUAL(4, slab->chunk_used);
+
+    /* items in a chunk are contiguous */
+    POINTERS_EQUAL((char *)items[0] + 24, items[1]);
+
+    /* released item is reused */
+    slab_release (slab, items[10]);
+    LONGS_EQUAL(31, slab->items_count);
+    item = slab_alloc (slab);
+    POINTERS_EQUAL(items[10], item);
+    LONGS_EQUAL(32, slab->items_count);
+    LONGS_EQUAL(44, slab->items_alloc);
+
+    /* release of NULL item does nothing */
+    slab_release (slab, NULL);
+    LONGS_EQUAL(32, slab->items_count);
+
+    /* chunks are freed when the last item is released */
+    for (i = 0; i < 32; i++)
+    {
+        slab_release (slab, items[i]);
+    }
+    LONGS_EQUAL(0, slab->items_count);
+    LONGS_EQUAL(0, slab->chunks_count);
+    LONGS_EQUAL(0, slab->items_alloc);
+    POINTERS_EQUAL(NULL, slab->chunks);
+    POINTERS_EQUAL(NULL, slab->free_items);
+
+    /* clear slab with items */
+    for (i = 0; i < 5; i++)
+    {
+        CHECK(slab_alloc (slab));
+    }
+    LONGS_EQUAL(2, slab->chunks_count);
+    slab_clear (slab);
+    LONGS_EQUAL(0, slab->items_count);
+    LONGS_EQUAL(0, slab->chunks_count);
+    POINTERS_EQUAL(NULL, slab->chunks);
+
+    slab_free (slab);
+}
@@ -1327,3 +1327,49 @@ TEST(String, Shared)
     string_shared_free (str3);
     LONGS_EQUAL(count + 0, string_hashtable_shared->items_count);
 }
+
+/*
+ * Tests functions:
+ *    string_shared_get_lower
+ */
+
+TEST(String, SharedGetLower)
+{
+    const char *str1, *str2, *str3, *lower1, *lower2, *lower3;
+    int count;
+
+    POINTERS_EQUAL(NULL, string_shared_get_lower (NULL));
+
+    count = string_hashtable_shared->items_count;
+
+    str1 = string_shared_get ("irc_privmsg");
+    str2 = string_shared_get ("IRC_PrivMsg");
+    str3 = string_shared_get ("irc_notice");
+    LONGS_EQUAL(count + 3, string_hashtable_shared->items_count);
+
+    /* string already in lower case: same pointer */
+    lower1 = string_shared_get_lower (str1);
+    POINTERS_EQUAL(str1, lower1);
+    LONGS_EQUAL(count + 3, string_hashtable_shared->items_count);
+
+    /* string with upper case: same lower case pointer as str1 */
+    lower2 = string_shared_get_lower (str2);
+    POINTERS_EQUAL(str1, lower2);
+    POINTERS_EQUAL(lower2, string_shared_get_lower (str2));
+    LONGS_EQUAL(count + 3, string_hashtable_shared->items_count);
+
+    lower3 = string_shared_get_lower (str3);
+    POINTERS_EQUAL(str3, lower3);
+    CHECK(lower1 != lower3);
+
+    /* lower case string is kept while used by str2 */
+    string_shared_free (str1);
+    LONGS_EQUAL(count + 3, string_hashtable_shared->items_count);
+    STRCMP_EQUAL("irc_privmsg", string_shared_get_lower (str2));
+
+    string_shared_free (str2);
+    LONGS_EQUAL(count + 1, string_hashtable_shared->items_count);
+
+    string_shared_free (str3);
+    LONGS_EQUAL(count + 0, string_hashtable_shared->items_count);
+}
@@ -0,0 +1,144 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright (C) 2016 Sébastien Helleu <flashcode@flashtux.org>
+#
+# This file is part of WeeChat, the extensible chat client.
+#
+# WeeChat is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# WeeChat is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with WeeChat.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+"""
+Benchmark of IRC messages received by WeeChat: this script is a fake IRC
+server which replays a captured IRC stream to the client connected (WeeChat)
+and measures the time until all messages are processed by the client.
+
+The captured stream is a file with one raw IRC message by line, as received
+from the server (for example lines of the irc raw buffer, without the prefix).
+Words "{nick}" and "{channel}" in the file are replaced by the nick of client
+and the benchmark channel.
+Without file, a synthetic stream is used (messages, joins, parts, nick
+changes, modes and numeric replies).
+
+Syntax:
+    bench-irc.py [-p port] [-c count] [-n nicks] [file]
+
+Then in WeeChat:
+    /server add bench 127.0.0.1/6667
+    /connect bench
+
+The client joins the channel, receives the stream "count" times, then a PING
+is sent: the elapsed time is displayed when the PONG is received.
+"""
+
+from __future__ import print_function
+
+import argparse
+import socket
+import time
+
+CHANNEL = '#bench'
+
+
+def synthetic_stream(nicks):
+    """Return a list of IRC messages (format strings) for the benchmark."""
+    stream = []
+    for i in range(nicks):
+        nick = 'user%d' % i
+        stream.append(':%s!u@host%d.example.com PRIVMSG {channel} '
+                      ':hello, this is message number %d' % (nick, i, i))
+        if i % 10 == 0:
+            stream.append(':%s!u@host PART {channel} :bye' % nick)
+            stream.append(':%s!u@host JOIN {channel}' % nick)
+        if i % 25 == 0:
+            stream.append(':%s!u@host NICK :%s_' % (nick, nick))
+            stream.append(':%s_!u@host NICK :%s' % (nick, nick))
+            stream.append(':server MODE {channel} +v %s' % nick)
+            stream.append(':server 352 {nick} {channel} u host server '
+                          '%s H :0 real name' % nick)
+    stream.append(':server 315 {nick} {channel} :End of /WHO list.')
+    return stream
+
+
+def main():
+    """Run the fake IRC server."""
+    parser = argparse.ArgumentParser(
+        description='Benchmark of IRC messages received by WeeChat')
+    parser.add_argument('-p', '--port', type=int, default=6667,
+                        help='port to listen on (default: 6667)')
+    parser.add_argument('-c', '--count', type=int, default=10,
+                        help='number of times the stream is sent '
+                        '(default: 10)')
+    parser.add_argument('-n', '--nicks', type=int, default=1000,
+                        help='number of nicks on channel (default: 1000)')
+    parser.add_argument('file', nargs='?',
+                        help='file with captured IRC stream')
+    args = parser.parse_args()
+
+    if args.file:
+        with open(args.file, 'rb') as _file:
+            stream = [line.decode('utf-8', 'replace').rstrip('\r\n')
+                      for line in _file]
+    else:
+        stream = synthetic_stream(args.nicks)
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    sock.bind(('127.0.0.1', args.port))
+    sock.listen(1)
+    print('Waiting for client on port %d...' % args.port)
+    client, _ = sock.accept()
+    reader = client.makefile('rb')
+
+    def send(message):
+        """Send a message to the client."""
+        client.sendall((message + '\r\n').encode('utf-8'))
+
+    nick = None
+    for line in reader:
+        items = line.decode('utf-8', 'replace').strip().split(' ')
+        if items[0] == 'NICK':
+            nick = items[1]
+        elif items[0] == 'USER':
+            send(':server 001 %s :Welcome' % nick)
+            send(':server 005 %s CHANTYPES=# PREFIX=(ov)@+ '
+                 'CASEMAPPING=rfc1459 :are supported' % nick)
+            send(':server 376 %s :End of MOTD' % nick)
+            send(':%s!u@host JOIN %s' % (nick, CHANNEL))
+            names = ['user%d' % i for i in range(args.nicks)]
+            for i in range(0, len(names), 40):
+                send(':server 353 %s = %s :%s' % (nick, CHANNEL,
+                                                  ' '.join(names[i:i + 40])))
+            send(':server 366 %s %s :End of /NAMES list.' % (nick, CHANNEL))
+            break
+
+    data = '\r\n'.join(stream).replace('{nick}', nick).replace(
+        '{channel}', CHANNEL).encode('utf-8') + b'\r\n'
+    start = time.time()
+    for _ in range(args.count):
+        client.sendall(data)
+    send('PING :bench')
+    for line in reader:
+        if line.decode('utf-8', 'replace').startswith('PONG'):
+            break
+    elapsed = time.time() - start
+    messages = len(stream) * args.count
+    print('%d messages received in %.3f seconds (%d messages/s)' % (
+        messages, elapsed, messages / elapsed if elapsed > 0 else 0))
+    send('ERROR :end of benchmark')
+    client.close()
+
+
+if __name__ == '__main__':
+    main()